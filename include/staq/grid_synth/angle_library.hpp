@@ -0,0 +1,321 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GRID_SYNTH_ANGLE_LIBRARY_HPP_
+#define GRID_SYNTH_ANGLE_LIBRARY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "staq/grid_synth/gmp_functions.hpp"
+#include "staq/grid_synth/types.hpp"
+
+namespace staq {
+namespace grid_synth {
+
+/*
+ * An angle library holds precomputed approximations of the dyadic rotations
+ * Rz(m pi / 2^k), so that the angles of QFT-like circuits are synthesized
+ * without a number-theoretic search. Libraries are written by
+ * staq_grid_synth_library and memory-mapped on first use. The file, in native
+ * byte order, is an AngleLibraryHeader, then its count AngleLibraryEntry
+ * records sorted by (prec, k, m), then the gate strings they point into.
+ */
+static const char ANGLE_LIBRARY_MAGIC[8] = {'S', 'T', 'A', 'Q',
+                                            'A', 'N', 'G', 'L'};
+static const std::uint32_t ANGLE_LIBRARY_VERSION = 1;
+// Largest k for which every m < 2^(k+2) fits in an entry
+static const std::uint32_t ANGLE_LIBRARY_MAX_K = 61;
+
+struct AngleLibraryHeader {
+    char magic[8];         // ANGLE_LIBRARY_MAGIC
+    std::uint32_t version; // ANGLE_LIBRARY_VERSION, also checks byte order
+    std::uint32_t max_k;   // Largest k of any entry
+    std::uint64_t count;   // Number of entries
+    std::uint64_t strings; // File offset of the gate strings
+};
+
+struct AngleLibraryEntry {
+    std::uint32_t prec;    // Precision p of the approximation, eps = 10^-p
+    std::uint32_t k;       // The angle is m pi / 2^k, with m odd
+    std::uint64_t m;       //   and 0 < m < 2^(k+2)
+    std::uint64_t offset;  // Position of the gates among the gate strings
+    std::uint32_t length;  // Length of the gate string
+    std::uint32_t t_count; // T-count of the simplified gate string
+    double error;          // Distance from the exact rotation
+};
+
+inline bool operator<(const AngleLibraryEntry& a, const AngleLibraryEntry& b) {
+    return std::tie(a.prec, a.k, a.m) < std::tie(b.prec, b.k, b.m);
+}
+
+/* An approximation to be written to an angle library. */
+struct AngleLibraryItem {
+    std::uint32_t prec;
+    std::uint32_t k;
+    std::uint64_t m;
+    str_t op_str;
+    long t_count;
+    double error;
+};
+
+/* Writes items to os in the angle library format. */
+inline void write_angle_library(std::ostream& os,
+                                std::vector<AngleLibraryItem> items) {
+    std::sort(items.begin(), items.end(),
+              [](const AngleLibraryItem& a, const AngleLibraryItem& b) {
+                  return std::tie(a.prec, a.k, a.m) <
+                         std::tie(b.prec, b.k, b.m);
+              });
+
+    AngleLibraryHeader header{};
+    std::memcpy(header.magic, ANGLE_LIBRARY_MAGIC, sizeof(header.magic));
+    header.version = ANGLE_LIBRARY_VERSION;
+    header.count = items.size();
+    header.strings =
+        sizeof(AngleLibraryHeader) + items.size() * sizeof(AngleLibraryEntry);
+
+    std::vector<AngleLibraryEntry> entries;
+    entries.reserve(items.size());
+    std::uint64_t offset = 0;
+    for (const AngleLibraryItem& item : items) {
+        header.max_k = std::max(header.max_k, item.k);
+        entries.push_back(AngleLibraryEntry{
+            item.prec, item.k, item.m, offset,
+            static_cast<std::uint32_t>(item.op_str.size()),
+            static_cast<std::uint32_t>(item.t_count), item.error});
+        offset += item.op_str.size();
+    }
+
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char*>(entries.data()),
+             entries.size() * sizeof(AngleLibraryEntry));
+    for (const AngleLibraryItem& item : items) {
+        os.write(item.op_str.data(), item.op_str.size());
+    }
+}
+
+/*
+ * Read-only view of an angle library file. The file is opened and mapped the
+ * first time it is searched, which is safe to do from several threads. A
+ * library that cannot be loaded is reported once on std::cerr and then
+ * behaves as if it were empty.
+ */
+class AngleLibrary {
+  public:
+    explicit AngleLibrary(str_t path) : path_(std::move(path)) {}
+    AngleLibrary(const AngleLibrary&) = delete;
+    AngleLibrary& operator=(const AngleLibrary&) = delete;
+
+    ~AngleLibrary() {
+#if !defined(_WIN32)
+        if (mapped_ != nullptr) {
+            munmap(mapped_, size_);
+        }
+#endif
+    }
+
+    const str_t& path() const { return path_; }
+
+    /* Number of entries, loading the library if need be. */
+    std::size_t size() const {
+        load();
+        return count_;
+    }
+
+    /*
+     * Finds the approximation of Rz(theta pi) at precision prec, if theta is
+     * within tol of a dyadic m / 2^k in the library. Returns nullptr if not.
+     */
+    const AngleLibraryEntry* find(real_t theta, long prec,
+                                  const real_t& tol) const {
+        load();
+        if (count_ == 0) {
+            return nullptr;
+        }
+
+        // Normalize theta to the range [0,4), as check_common_cases does
+        while (theta >= real_t("4")) {
+            theta = theta - real_t("4");
+        }
+        while (theta < 0) {
+            theta = theta + real_t("4");
+        }
+
+        real_t scaled, diff;
+        for (std::uint32_t k = 1; k <= max_k_; k++) {
+            mpf_mul_2exp(scaled.get_mpf_t(), theta.get_mpf_t(), k);
+            int_t m = gmpf::gmp_floor(real_t(scaled + real_t("0.5")));
+            diff = scaled - m;
+            mpf_div_2exp(diff.get_mpf_t(), diff.get_mpf_t(), k);
+            if (abs(diff) >= tol) {
+                continue;
+            }
+            // m is only even for multiples of 4, where Rz is the identity
+            if (m % 2 == 0) {
+                return nullptr;
+            }
+            return find(static_cast<std::uint32_t>(prec), k, m.get_ui());
+        }
+        return nullptr;
+    }
+
+    /* Finds the entry for Rz(m pi / 2^k) at precision prec, if any. */
+    const AngleLibraryEntry* find(std::uint32_t prec, std::uint32_t k,
+                                  std::uint64_t m) const {
+        load();
+        AngleLibraryEntry key{prec, k, m, 0, 0, 0, 0};
+        const AngleLibraryEntry* it =
+            std::lower_bound(entries_, entries_ + count_, key);
+        if (it == entries_ + count_ || key < *it ||
+            it->offset > strings_size_ ||
+            it->length > strings_size_ - it->offset) {
+            return nullptr;
+        }
+        return it;
+    }
+
+    /* The gate string of an entry. */
+    str_t gates(const AngleLibraryEntry& entry) const {
+        return str_t(strings_ + entry.offset, entry.length);
+    }
+
+  private:
+    str_t path_;
+
+    mutable std::once_flag loaded_;
+    mutable void* mapped_ = nullptr;
+    mutable std::vector<char> buffer_;
+    mutable std::size_t size_ = 0;
+    mutable const AngleLibraryEntry* entries_ = nullptr;
+    mutable std::size_t count_ = 0;
+    mutable std::uint32_t max_k_ = 0;
+    mutable const char* strings_ = nullptr;
+    mutable std::uint64_t strings_size_ = 0;
+
+    void load() const {
+        std::call_once(loaded_, [this]() {
+            const char* data = map_file();
+            if (data == nullptr) {
+                std::cerr << "Warning: could not read angle library " << path_
+                          << '\n';
+                return;
+            }
+            if (!index(data)) {
+                std::cerr << "Warning: " << path_
+                          << " is not a valid angle library" << '\n';
+            }
+        });
+    }
+
+    /* Maps the file into memory, returning its contents or nullptr. */
+    const char* map_file() const {
+#if defined(_WIN32)
+        std::ifstream in(path_, std::ios::binary);
+        if (!in) {
+            return nullptr;
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+        size_ = buffer_.size();
+        return buffer_.data();
+#else
+        int fd = open(path_.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+        void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                          PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            return nullptr;
+        }
+        mapped_ = data;
+        size_ = static_cast<std::size_t>(st.st_size);
+        return static_cast<const char*>(data);
+#endif
+    }
+
+    /*
+     * Checks the header of a mapped library and indexes it. Entries are only
+     * checked when they are found, so that opening a library stays cheap.
+     */
+    bool index(const char* data) const {
+        AngleLibraryHeader header;
+        if (size_ < sizeof(header) ||
+            reinterpret_cast<std::uintptr_t>(data) %
+                    alignof(AngleLibraryEntry) !=
+                0) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, ANGLE_LIBRARY_MAGIC,
+                        sizeof(header.magic)) != 0 ||
+            header.version != ANGLE_LIBRARY_VERSION ||
+            header.max_k > ANGLE_LIBRARY_MAX_K ||
+            header.count >
+                (size_ - sizeof(header)) / sizeof(AngleLibraryEntry) ||
+            header.strings !=
+                sizeof(header) + header.count * sizeof(AngleLibraryEntry)) {
+            return false;
+        }
+
+        entries_ =
+            reinterpret_cast<const AngleLibraryEntry*>(data + sizeof(header));
+        count_ = header.count;
+        max_k_ = header.max_k;
+        strings_ = data + header.strings;
+        strings_size_ = size_ - header.strings;
+        return true;
+    }
+};
+
+} // namespace grid_synth
+} // namespace staq
+
+#endif // GRID_SYNTH_ANGLE_LIBRARY_HPP_
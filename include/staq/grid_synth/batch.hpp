@@ -0,0 +1,183 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GRID_SYNTH_BATCH_HPP_
+#define GRID_SYNTH_BATCH_HPP_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "staq/grid_synth/grid_synth.hpp"
+#include "staq/grid_synth/random_numbers.hpp"
+
+namespace staq {
+namespace grid_synth {
+
+/* An angle read by synthesize_stream, with its result or error message. */
+struct BatchResult {
+    std::size_t index;      // Position of the angle in the input
+    str_t angle;            // The angle as read, in units of pi
+    str_t message;          // Why the angle failed, empty on success
+    GridSynthResult result; // Only meaningful if message is empty
+};
+
+/*
+ * Synthesizes whitespace-separated angles, in units of pi, read from in.
+ * Angles are handed to a pool of jobs worker threads (0 for all cores) and
+ * out is called on the calling thread for each result, in input order. At
+ * most a fixed window of angles is in flight at once, so arbitrarily long
+ * inputs are streamed. Angle i is synthesized with random numbers seeded from
+ * seed and i, so results do not depend on the number of jobs. Returns the
+ * number of angles read.
+ */
+inline std::size_t
+synthesize_stream(const GridSynthesizer& synthesizer, std::istream& in,
+                  int jobs, std::uint64_t seed,
+                  const std::function<void(const BatchResult&)>& out) {
+    if (jobs <= 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t window = 16 * static_cast<std::size_t>(jobs);
+
+    std::mutex mutex;
+    std::condition_variable work_ready, result_ready, window_open;
+    std::deque<BatchResult> work;
+    std::map<std::size_t, BatchResult> done;
+    std::size_t read = 0, written = 0;
+    bool eof = false, stop = false;
+
+    auto worker = [&]() {
+        for (;;) {
+            BatchResult item;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock,
+                                [&] { return stop || eof || !work.empty(); });
+                if (stop || work.empty()) {
+                    return;
+                }
+                item = std::move(work.front());
+                work.pop_front();
+            }
+
+            random_numbers.seed(seed + item.index);
+            try {
+                item.result = synthesizer.synthesize_angle(
+                    real_t(item.angle) * gmpf::gmp_pi());
+            } catch (const std::invalid_argument&) {
+                item.message = "Invalid angle provided: " + item.angle;
+            } catch (const std::exception& e) {
+                item.message = e.what();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::size_t index = item.index;
+                done.emplace(index, std::move(item));
+            }
+            result_ready.notify_one();
+        }
+    };
+
+    auto reader = [&]() {
+        str_t angle;
+        while (in >> angle) {
+            std::unique_lock<std::mutex> lock(mutex);
+            window_open.wait(lock,
+                             [&] { return stop || read - written < window; });
+            if (stop) {
+                break;
+            }
+            work.push_back(BatchResult{read++, std::move(angle), "", {}});
+            lock.unlock();
+            work_ready.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            eof = true;
+        }
+        work_ready.notify_all();
+        result_ready.notify_one();
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(reader);
+    for (int i = 0; i < jobs; i++) {
+        threads.emplace_back(worker);
+    }
+
+    auto join = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        work_ready.notify_all();
+        window_open.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    try {
+        for (;;) {
+            BatchResult item;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                result_ready.wait(lock, [&] {
+                    return done.count(written) || (eof && written == read);
+                });
+                auto it = done.find(written);
+                if (it == done.end()) {
+                    break;
+                }
+                item = std::move(it->second);
+                done.erase(it);
+                ++written;
+            }
+            window_open.notify_one();
+            out(item);
+        }
+    } catch (...) {
+        join();
+        throw;
+    }
+    join();
+
+    return read;
+}
+
+} // namespace grid_synth
+} // namespace staq
+
+#endif // GRID_SYNTH_BATCH_HPP_
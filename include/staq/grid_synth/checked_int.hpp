@@ -0,0 +1,222 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef GRID_SYNTH_CHECKED_INT_HPP_
+#define GRID_SYNTH_CHECKED_INT_HPP_
+
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include <gmpxx.h>
+
+#include "staq/grid_synth/types.hpp"
+
+// The fixed-width fast path needs __int128 and the overflow builtins
+#if defined(__SIZEOF_INT128__)
+#define GRID_SYNTH_CHECKED_INT
+#endif
+
+namespace staq {
+namespace grid_synth {
+
+/* Number of bits in the magnitude of x */
+inline std::size_t bit_size(const int_t& x) {
+    return mpz_sizeinbase(x.get_mpz_t(), 2);
+}
+
+inline const int_t& to_int_t(const int_t& x) { return x; }
+
+/*
+ * Converts an int_t to the integer type Int, throwing std::overflow_error if
+ * it does not fit
+ */
+template <typename Int>
+struct int_caster {};
+
+template <>
+struct int_caster<int_t> {
+    static const int_t& cast(const int_t& x) { return x; }
+};
+
+template <typename Int>
+decltype(auto) int_cast(const int_t& x) {
+    return int_caster<Int>::cast(x);
+}
+
+#ifdef GRID_SYNTH_CHECKED_INT
+
+/*
+ * A fixed-width signed integer whose arithmetic throws std::overflow_error
+ * rather than wrapping. Used in place of int_t in the ring types when the
+ * coefficients are known to be small, so that arithmetic can be retried with
+ * int_t on overflow. Division and remainder truncate towards zero, as they do
+ * for int_t.
+ */
+template <typename T>
+class checked_int {
+  private:
+    T v_;
+
+    static void check(bool overflow) {
+        if (overflow) {
+            throw std::overflow_error("checked_int overflow");
+        }
+    }
+
+  public:
+    static constexpr int DIGITS = 8 * sizeof(T) - 1;
+    static constexpr T MAX = ((T(1) << (DIGITS - 1)) - 1) * 2 + 1;
+    static constexpr T MIN = -MAX - 1;
+
+    checked_int() : v_(0) {}
+    checked_int(int v) : v_(v) {}
+
+    static checked_int from_value(T v) {
+        checked_int ret;
+        ret.v_ = v;
+        return ret;
+    }
+
+    T value() const { return v_; }
+
+    // Arithmetic operators
+    // ====================
+    friend checked_int operator+(const checked_int& x, const checked_int& y) {
+        T r;
+        check(__builtin_add_overflow(x.v_, y.v_, &r));
+        return from_value(r);
+    }
+
+    friend checked_int operator-(const checked_int& x, const checked_int& y) {
+        T r;
+        check(__builtin_sub_overflow(x.v_, y.v_, &r));
+        return from_value(r);
+    }
+
+    friend checked_int operator*(const checked_int& x, const checked_int& y) {
+        T r;
+        check(__builtin_mul_overflow(x.v_, y.v_, &r));
+        return from_value(r);
+    }
+
+    friend checked_int operator/(const checked_int& x, const checked_int& y) {
+        check(x.v_ == MIN && y.v_ == -1);
+        return from_value(x.v_ / y.v_);
+    }
+
+    friend checked_int operator%(const checked_int& x, const checked_int& y) {
+        check(x.v_ == MIN && y.v_ == -1);
+        return from_value(x.v_ % y.v_);
+    }
+
+    checked_int operator-() const {
+        check(v_ == MIN);
+        return from_value(-v_);
+    }
+
+    checked_int& operator+=(const checked_int& y) { return *this = *this + y; }
+    checked_int& operator-=(const checked_int& y) { return *this = *this - y; }
+    checked_int& operator*=(const checked_int& y) { return *this = *this * y; }
+
+    // Comparison operators
+    // ====================
+    friend bool operator==(const checked_int& x, const checked_int& y) {
+        return x.v_ == y.v_;
+    }
+    friend bool operator!=(const checked_int& x, const checked_int& y) {
+        return x.v_ != y.v_;
+    }
+    friend bool operator<(const checked_int& x, const checked_int& y) {
+        return x.v_ < y.v_;
+    }
+    friend bool operator>(const checked_int& x, const checked_int& y) {
+        return x.v_ > y.v_;
+    }
+    friend bool operator<=(const checked_int& x, const checked_int& y) {
+        return x.v_ <= y.v_;
+    }
+    friend bool operator>=(const checked_int& x, const checked_int& y) {
+        return x.v_ >= y.v_;
+    }
+};
+
+using int64_c = checked_int<std::int64_t>;
+using int128_c = checked_int<__int128>;
+
+template <typename T>
+int_t to_int_t(const checked_int<T>& x) {
+    unsigned __int128 mag = x.value() < 0
+                                ? -static_cast<unsigned __int128>(x.value())
+                                : static_cast<unsigned __int128>(x.value());
+    int_t ret = 0;
+    for (int shift = 96; shift >= 0; shift -= 32) {
+        ret <<= 32;
+        ret += static_cast<unsigned long>((mag >> shift) & 0xffffffffU);
+    }
+    return x.value() < 0 ? int_t(-ret) : ret;
+}
+
+template <typename T>
+std::size_t bit_size(const checked_int<T>& x) {
+    unsigned __int128 mag = x.value() < 0
+                                ? -static_cast<unsigned __int128>(x.value())
+                                : static_cast<unsigned __int128>(x.value());
+    std::size_t bits = 0;
+    while (mag != 0) {
+        mag >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const checked_int<T>& x) {
+    return os << to_int_t(x);
+}
+
+template <typename T>
+struct int_caster<checked_int<T>> {
+    static checked_int<T> cast(const int_t& x) {
+        if (bit_size(x) > checked_int<T>::DIGITS - 1) {
+            throw std::overflow_error("int_t does not fit in checked_int");
+        }
+        int_t mag = abs(x);
+        T ret = 0;
+        for (int shift = 96; shift >= 0; shift -= 32) {
+            int_t chunk = (mag >> shift) & int_t(0xffffffffUL);
+            ret = (ret << 16 << 16) + static_cast<T>(chunk.get_ui());
+        }
+        return checked_int<T>::from_value(sgn(x) < 0 ? -ret : ret);
+    }
+};
+
+#endif // GRID_SYNTH_CHECKED_INT
+
+} // namespace grid_synth
+} // namespace staq
+
+#endif // GRID_SYNTH_CHECKED_INT_HPP_
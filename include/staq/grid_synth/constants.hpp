@@ -29,6 +29,7 @@
 
 #include <cmath>
 #include <iostream>
+#include <limits>
 
 #include "staq/grid_synth/complex.hpp"
 #include "staq/grid_synth/gmp_functions.hpp"
@@ -88,7 +89,67 @@ inline MultiPrecisionConstants MP_CONSTS = initialize_constants(10);
 #define SQRT_LAMBDA MP_CONSTS.sqrt_lambda
 #define SQRT_LAMBDA_INV MP_CONSTS.sqrt_lambda_inv
 
+/*
+ * Constants for code templated on the type Real of real numbers. For real_t
+ * these are the constants above, and for built-in floating point types they
+ * are computed once in that type.
+ */
+template <typename Real>
+struct RealConstants {
+    static const Real& tol() {
+        static const Real x = 64 * std::numeric_limits<Real>::epsilon();
+        return x;
+    }
+    static const Real& pi() {
+        static const Real x = std::acos(Real(-1));
+        return x;
+    }
+    static const Real& sqrt2() {
+        static const Real x = std::sqrt(Real(2));
+        return x;
+    }
+    static const Real& inv_sqrt2() {
+        static const Real x = 1 / std::sqrt(Real(2));
+        return x;
+    }
+    static const Real& half_inv_sqrt2() {
+        static const Real x = 1 / (2 * std::sqrt(Real(2)));
+        return x;
+    }
+    static const Real& log_lambda() {
+        static const Real x = std::log10(1 + std::sqrt(Real(2)));
+        return x;
+    }
+    static const Real& sqrt_lambda_inv() {
+        static const Real x = std::sqrt(std::sqrt(Real(2)) - 1);
+        return x;
+    }
+    static Real lambda() { return 1 + sqrt2(); }
+};
+
+template <>
+struct RealConstants<real_t> {
+    static const real_t& tol() { return TOL; }
+    static const real_t& pi() { return PI; }
+    static const real_t& sqrt2() { return SQRT2; }
+    static const real_t& inv_sqrt2() { return INV_SQRT2; }
+    static const real_t& half_inv_sqrt2() { return HALF_INV_SQRT2; }
+    static const real_t& log_lambda() { return LOG_LAMBDA; }
+    static const real_t& sqrt_lambda_inv() { return SQRT_LAMBDA_INV; }
+    static real_t lambda() { return 1 + SQRT2; }
+};
+
 inline int MAX_ATTEMPTS_POLLARD_RHO = 200;
+// Threads searching candidates for each scale exponent, 0 for all cores
+inline int RZ_SEARCH_THREADS = 1;
+// Curves of the elliptic curve method tried when Pollard's rho fails
+inline int ECM_CURVES = 0;
+// Skew reductions kept for reuse by nearby angles, 0 to disable
+inline int SKEW_CACHE_SIZE = 0;
+
+// Skew reduction starts in double precision while the off-diagonal entries of
+// the normalized ellipses are below this, keeping their squares finite
+const double FLOAT_SKEW_MAX_ENTRY = 1e150;
 
 const int KMIN = 0;
 const int KMAX = 10000000;
@@ -98,7 +159,10 @@ const int POLLARD_RHO_INITIAL_ADDEND = 1;
 const int POLLARD_RHO_START = 2;
 const int MOD_SQRT_MAX_DEPTH = 20;
 
-const int MAX_ITERATIONS_FERMAT_TEST = 5;
+const int MAX_ITERATIONS_MILLER_RABIN = 25;
+const unsigned long SMALL_PRIME_BOUND = 1000;
+const int POLLARD_BRENT_BATCH = 64;
+const unsigned long ECM_B1 = 1000; // at most SMALL_PRIME_BOUND
 const str_t DEFAULT_TABLE_FILE = "./.s3_table_file.csv";
 
 // on average, we only need 2 attempts so 5 is playing it safe
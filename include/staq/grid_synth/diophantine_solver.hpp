@@ -31,6 +31,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <random>
+#include <vector>
 
 #include "staq/grid_synth/constants.hpp"
 #include "staq/grid_synth/random_numbers.hpp"
@@ -71,6 +72,8 @@ modular_sqrt_neg_one(int_t& answer, const int_t& p,
         if (test_answer == p - 1) {
             exponent = (p - 1) / 4;
             answer = mod_pow(b, exponent, p);
+            // Pick the smaller of the two roots, whatever b was drawn
+            answer = std::min<int_t>(answer, p - answer);
             return true;
         }
     }
@@ -140,7 +143,8 @@ inline bool modular_sqrt(int_t& answer, const int_t& a, const int_t& p) {
         return true;
     }
     if (t == 1) {
-        answer = r;
+        // Pick the smaller of the two roots, whatever z was drawn
+        answer = std::min<int_t>(r, p - r);
         return true;
     }
     return false;
@@ -159,28 +163,67 @@ inline T ring_gcd(const T& a, const T& b) {
 }
 
 /*
- * Implements the Fermat primality test
+ * Primes used for trial division before any probabilistic test
+ */
+inline const std::vector<unsigned long>& small_primes() {
+    static const std::vector<unsigned long> primes = [] {
+        std::vector<unsigned long> ret;
+        for (unsigned long n = 2; n < SMALL_PRIME_BOUND; n++) {
+            bool prime = true;
+            for (unsigned long p : ret) {
+                if (p * p > n) {
+                    break;
+                }
+                if (n % p == 0) {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime) {
+                ret.push_back(n);
+            }
+        }
+        return ret;
+    }();
+    return primes;
+}
+
+/*
+ * Implements the Miller-Rabin primality test, after trial division by the
+ * small primes
  */
 inline bool is_prime(const int_t& n,
-                     const int_t& max_iters = MAX_ITERATIONS_FERMAT_TEST) {
-    if (n == 2 || n == 3) {
-        return true;
+                     const int& reps = MAX_ITERATIONS_MILLER_RABIN) {
+    if (n < 2) {
+        return false;
     }
 
-    for (int_t i = 0; i < max_iters; i++) {
-        int_t a = 2 + (rand() % (n - 2));
-        if (mod_pow(a, n - 1, n) != 1) {
+    for (unsigned long p : small_primes()) {
+        if (n == p) {
+            return true;
+        }
+        if (mpz_divisible_ui_p(n.get_mpz_t(), p)) {
             return false;
         }
     }
 
-    return true;
+    if (n < SMALL_PRIME_BOUND * SMALL_PRIME_BOUND) {
+        return true;
+    }
+
+    return mpz_probab_prime_p(n.get_mpz_t(), reps) > 0;
 }
 
 inline int_t g(const int_t& x, const int_t& addend, const int_t& n) {
     return (x * x + addend) % n;
 }
 
+/*
+ * Brent's variant of Pollard's rho algorithm. Differences are multiplied
+ * together in batches of POLLARD_BRENT_BATCH before taking a gcd, and the
+ * search gives up after as many evaluations of g as MAX_ATTEMPTS_POLLARD_RHO
+ * rounds of Floyd's cycle detection would use.
+ */
 inline bool pollard_rho(int_t& factor, const int_t& n,
                         const int_t& addend = POLLARD_RHO_INITIAL_ADDEND,
                         const int_t& start = POLLARD_RHO_START) {
@@ -190,19 +233,47 @@ inline bool pollard_rho(int_t& factor, const int_t& n,
         return true;
     }
 
-    int_t x = start;
+    const long max_steps = 3 * static_cast<long>(MAX_ATTEMPTS_POLLARD_RHO);
+
+    int_t x;
     int_t y = start;
+    int_t ys;
+    int_t q = 1;
     int_t d = 1;
-    int_t i = 0;
+    long r = 1;
+    long steps = 0;
     while (d == 1) {
-        x = g(x, addend, n);
-        y = g(g(y, addend, n), addend, n);
-        d = gcd(abs(x - y), n);
-        i += 1;
-        if (i > MAX_ATTEMPTS_POLLARD_RHO) {
+        x = y;
+        for (long i = 0; i < r; i++) {
+            y = g(y, addend, n);
+        }
+        steps += r;
+
+        for (long k = 0; k < r && d == 1; k += POLLARD_BRENT_BATCH) {
+            ys = y;
+            long batch = std::min<long>(POLLARD_BRENT_BATCH, r - k);
+            for (long i = 0; i < batch; i++) {
+                y = g(y, addend, n);
+                q = (q * abs(x - y)) % n;
+            }
+            steps += batch;
+            d = gcd(q, n);
+        }
+
+        r *= 2;
+        if (d == 1 && steps > max_steps) {
             return false;
         }
     }
+
+    // The batch overshot, so step through it again one gcd at a time
+    if (d == n) {
+        do {
+            ys = g(ys, addend, n);
+            d = gcd(abs(x - ys), n);
+        } while (d == 1);
+    }
+
     if (d == n) {
         return false;
     } else {
@@ -211,10 +282,140 @@ inline bool pollard_rho(int_t& factor, const int_t& n,
     }
 }
 
+/*
+ * One curve of stage one of Lenstra's elliptic curve method, on a random curve
+ * through a random point in affine Weierstrass coordinates. A factor turns up
+ * as a non-invertible denominator while computing k P, where k is the product
+ * of all prime powers up to ECM_B1.
+ */
+inline bool ecm_curve(int_t& factor, const int_t& n) {
+    int_t a = random_numbers.get_z_range(n);
+    int_t x = random_numbers.get_z_range(n);
+    int_t y = random_numbers.get_z_range(n);
+
+    // Reduces v into [0, n)
+    auto reduce = [&](int_t v) {
+        mpz_mod(v.get_mpz_t(), v.get_mpz_t(), n.get_mpz_t());
+        return v;
+    };
+
+    // Returns false with factor set if the inverse does not exist
+    auto invert = [&](int_t& inv, const int_t& v) {
+        if (mpz_invert(inv.get_mpz_t(), v.get_mpz_t(), n.get_mpz_t()) != 0) {
+            return true;
+        }
+        factor = gcd(v, n);
+        return false;
+    };
+
+    // Adds (x2, y2) to (x1, y1), which is the point at infinity if inf1 is set
+    auto add = [&](int_t& x1, int_t& y1, bool& inf1, const int_t& x2,
+                   const int_t& y2) {
+        if (inf1) {
+            x1 = x2;
+            y1 = y2;
+            inf1 = false;
+            return true;
+        }
+        int_t num, den;
+        if (x1 == x2) {
+            if (reduce(y1 + y2) == 0) {
+                inf1 = true;
+                return true;
+            }
+            num = 3 * x1 * x1 + a;
+            den = 2 * y1;
+        } else {
+            num = y2 - y1;
+            den = x2 - x1;
+        }
+        int_t inv;
+        if (!invert(inv, reduce(den))) {
+            return false;
+        }
+        int_t lambda = reduce(num * inv);
+        int_t x3 = reduce(lambda * lambda - x1 - x2);
+        y1 = reduce(lambda * (x1 - x3) - y1);
+        x1 = x3;
+        return true;
+    };
+
+    // Multiplies (x, y) by m, by double-and-add
+    auto multiply = [&](unsigned long m) {
+        int_t rx, ry;
+        bool rinf = true;
+        int_t px = x, py = y;
+        while (m > 0) {
+            if (m & 1) {
+                if (!add(rx, ry, rinf, px, py)) {
+                    return false;
+                }
+            }
+            m >>= 1;
+            if (m > 0) {
+                bool pinf = false;
+                int_t qx = px, qy = py;
+                if (!add(px, py, pinf, qx, qy)) {
+                    return false;
+                }
+                if (pinf) {
+                    break;
+                }
+            }
+        }
+        x = rx;
+        y = ry;
+        return !rinf;
+    };
+
+    for (unsigned long p : small_primes()) {
+        if (p > ECM_B1) {
+            break;
+        }
+        unsigned long pk = p;
+        while (pk * p <= ECM_B1) {
+            pk *= p;
+        }
+        if (!multiply(pk)) {
+            return factor > 1 && factor < n;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Tries ECM_CURVES curves of the elliptic curve method
+ */
+inline bool ecm(int_t& factor, const int_t& n) {
+    for (int i = 0; i < ECM_CURVES; i++) {
+        if (ecm_curve(factor, n)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 inline bool prime_factorize_int(int_vec_t& prime_factors, const int_t& n) {
     using namespace std;
+    int_t m = n;
+    for (unsigned long p : small_primes()) {
+        if (mpz_divisible_ui_p(m.get_mpz_t(), p)) {
+            if (p % 8 == 7) { // can't factor xi in this case anyway
+                return false;
+            }
+            while (mpz_divisible_ui_p(m.get_mpz_t(), p)) {
+                prime_factors.push_back(p);
+                mpz_divexact_ui(m.get_mpz_t(), m.get_mpz_t(), p);
+            }
+        }
+    }
+    if (m == 1) {
+        return true;
+    }
+
     int_queue_t candidate_queue;
-    candidate_queue.push(n);
+    candidate_queue.push(m);
     while (candidate_queue.size() > 0) {
         int_t candidate = candidate_queue.front();
         candidate_queue.pop();
@@ -230,13 +431,12 @@ inline bool prime_factorize_int(int_vec_t& prime_factors, const int_t& n) {
             if (!factor_found) {
                 factor_found = pollard_rho(factor, candidate, -1);
             }
-
-            // N.B. This will cause the candidate n to be rejected. Might be
-            // worth adding attempts here later on.
             if (!factor_found) {
-                return false;
+                factor_found = ecm(factor, candidate);
             }
-            if (factor == 7) {
+
+            // N.B. This will cause the candidate n to be rejected
+            if (!factor_found) {
                 return false;
             }
 
@@ -27,7 +27,12 @@
 #ifndef GRID_SYNTH_EXACT_SYNTHESIS_HPP_
 #define GRID_SYNTH_EXACT_SYNTHESIS_HPP_
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <stdexcept>
+#include <vector>
 
 #include "staq/grid_synth/matrix.hpp"
 #include "staq/grid_synth/types.hpp"
@@ -79,45 +84,125 @@ inline str_t check_common_cases(real_t theta, const real_t& eps) {
     }
 }
 
-inline str_t synthesize(const DOmegaMatrix& D,
-                        const domega_matrix_table_t& s3_table) {
-    using namespace std;
+/* Largest number of bits in a coefficient of D */
+template <typename Int>
+inline std::size_t coefficient_bits(const DOmegaMatrixT<Int>& D) {
+    std::size_t bits = 0;
+    for (const ZOmegaT<Int>* z : {&D.u(), &D.t()}) {
+        for (const Int* x : {&z->a(), &z->b(), &z->c(), &z->d()}) {
+            bits = std::max(bits, bit_size(*x));
+        }
+    }
+    return bits;
+}
 
-    int_t s = D.sde_u_sq();
-    int_t sold = D.sde_u_sq();
-    DOmegaMatrix running_D = D;
-    str_t op_str = "";
-
-    while (s > 3) {
-        DOmegaMatrix op = H;
-        DOmegaMatrix temp_D = op * running_D;
-        str_t temp_str = "H";
-        if (temp_D.sde_u_sq() == s - 1) {
-            op_str += temp_str;
-            running_D = temp_D;
-            s = temp_D.sde_u_sq();
-            continue;
+/*
+ * Gates used to lower the sde, one entry per step. Entry k stands for the
+ * gates T^k H, i.e. the inverse of the step matrix H T^-k.
+ */
+using gate_codes_t = std::vector<std::uint8_t>;
+
+/* The step matrices H, HT^-1, HT^-2 and HT^-3, computed once per Int */
+template <typename Int>
+inline const std::array<DOmegaMatrixT<Int>, 4>& sde_step_matrices() {
+    static const std::array<DOmegaMatrixT<Int>, 4> steps = [] {
+        const DOmegaMatrixT<Int> T_dagger =
+            DOmegaMatrixT<Int>(ZOmegaT<Int>(1), ZOmegaT<Int>(0), 0, 1)
+                .dagger();
+        DOmegaMatrixT<Int> op(ZOmegaT<Int>(1), ZOmegaT<Int>(1), 1, 4);
+        std::array<DOmegaMatrixT<Int>, 4> ret{op, op, op, op};
+        for (std::size_t k = 1; k < ret.size(); k++) {
+            ret[k] = ret[k - 1] * T_dagger;
         }
+        return ret;
+    }();
+    return steps;
+}
 
-        for (int k = 1; k < 4; k++) {
-            op = op * (T.dagger());
-            temp_D = op * running_D;
-            temp_str = "T" + temp_str;
-            if (temp_D.sde_u_sq() == s - 1) {
-                op_str += temp_str;
-                running_D = temp_D;
-                s = temp_D.sde_u_sq();
-                break;
-            }
+/*
+ * Lowers the sde of D by one, by multiplying on the left by one of H, HT^-1,
+ * HT^-2 or HT^-3, and appends the step used to codes. Only the u entry of each
+ * candidate product is computed until one of them lowers the sde. Returns
+ * false if none of them do.
+ */
+template <typename Int>
+inline bool reduce_sde_step(DOmegaMatrixT<Int>& D, Int& s,
+                            gate_codes_t& codes) {
+    const auto& steps = sde_step_matrices<Int>();
+    for (std::size_t k = 0; k < steps.size(); k++) {
+        Int sde = DOmegaMatrixT<Int>::sde_sq(steps[k].product_u(D),
+                                             steps[k].k() + D.k());
+        if (sde == s - 1) {
+            codes.push_back(static_cast<std::uint8_t>(k));
+            D = steps[k] * D;
+            s = s - 1;
+            return true;
         }
-        if (sold == s) {
-            cout << "Value of s not changed" << endl;
-            exit(EXIT_FAILURE);
+    }
+    return false;
+}
+
+/*
+ * Lowers the sde of D until it reaches 3 or the coefficients of D fit in
+ * min_bits, computing with coefficients of type Int. Does nothing unless the
+ * coefficients fit in max_bits to begin with. Stops early if Int overflows,
+ * leaving D at the last step completed.
+ */
+template <typename Int>
+inline void reduce_sde(DOmegaMatrix& D, int_t& s, gate_codes_t& codes,
+                       std::size_t max_bits, std::size_t min_bits) {
+    if (s <= 3 || coefficient_bits(D) > max_bits) {
+        return;
+    }
+
+    DOmegaMatrixT<Int> D_int = D.template cast<Int>();
+    Int s_int = int_cast<Int>(s);
+    try {
+        while (s_int > 3 && coefficient_bits(D_int) > min_bits) {
+            if (!reduce_sde_step(D_int, s_int, codes)) {
+                std::cout << "Value of s not changed" << std::endl;
+                exit(EXIT_FAILURE);
+            }
         }
-        sold = sold - 1;
+    } catch (const std::overflow_error&) {
+        // The remaining steps are left to a wider type
     }
-    str_t rem = s3_table.at(running_D);
-    return op_str += rem;
+    D = D_int.template cast<int_t>();
+    s = to_int_t(s_int);
+}
+
+/* Converts gate codes to a string of H and T gates */
+inline str_t gate_codes_str(const gate_codes_t& codes) {
+    str_t ret;
+    ret.reserve(3 * codes.size());
+    for (std::uint8_t k : codes) {
+        ret.append(k, 'T');
+        ret += 'H';
+    }
+    return ret;
+}
+
+inline str_t synthesize(const DOmegaMatrix& D,
+                        const domega_matrix_table_t& s3_table) {
+    int_t s = D.sde_u_sq();
+    DOmegaMatrix running_D = D;
+    gate_codes_t codes;
+    if (s > 3) {
+        codes.reserve(s.get_ui());
+    }
+
+#ifdef GRID_SYNTH_CHECKED_INT
+    // Coefficients shrink as the sde is lowered, so the steps move on to
+    // fixed-width integers once the products computed in a step are sure to
+    // fit. Products of two coefficients need a little over twice their bits.
+    reduce_sde<int_t>(running_D, s, codes, SIZE_MAX, 60);
+    reduce_sde<int128_c>(running_D, s, codes, 60, 28);
+    reduce_sde<int64_c>(running_D, s, codes, 28, 0);
+#endif
+    reduce_sde<int_t>(running_D, s, codes, SIZE_MAX, 0);
+
+    str_t op_str = gate_codes_str(codes);
+    return op_str += s3_table.at(running_D);
 }
 
 } // namespace grid_synth
@@ -27,9 +27,12 @@
 #ifndef GRID_SYNTH_GMP_FUNCTIONS_HPP
 #define GRID_SYNTH_GMP_FUNCTIONS_HPP
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <type_traits>
 
 #include <gmpxx.h>
 
@@ -280,6 +283,121 @@ inline mpf_class sqrt(const mpf_class& x) {
     return output;
 }
 
+// ========================================================================= //
+// Overloads for built-in floating point types, so that code templated on the
+// type of real numbers can call the functions above with double or long double
+// ========================================================================= //
+
+template <typename Float, typename Ret = Float>
+using if_float_t = std::enable_if_t<std::is_floating_point<Float>::value, Ret>;
+
+template <typename Float>
+inline if_float_t<Float> gmp_abs(Float x) {
+    return std::abs(x);
+}
+
+template <typename Float>
+inline if_float_t<Float> gmp_min(Float x, Float y) {
+    return std::min(x, y);
+}
+
+template <typename Float>
+inline if_float_t<Float, mpz_class> gmp_floor(Float x) {
+    return mpz_class(static_cast<double>(std::floor(x)));
+}
+
+template <typename Float>
+inline if_float_t<Float, mpz_class> gmp_ceil(Float x) {
+    return mpz_class(static_cast<double>(std::ceil(x)));
+}
+
+template <typename Float>
+inline if_float_t<Float> pow(Float base, const mpz_class& exponent) {
+    return std::pow(base, static_cast<Float>(exponent.get_si()));
+}
+
+template <typename Float>
+inline if_float_t<Float> pow(Float base, signed long int exponent) {
+    return std::pow(base, static_cast<Float>(exponent));
+}
+
+template <typename Float>
+inline if_float_t<Float, bool> gmp_leq(Float lhs, Float rhs) {
+    return (lhs < rhs) || (std::abs(lhs - rhs) <
+                           std::numeric_limits<Float>::epsilon());
+}
+
+template <typename Float>
+inline if_float_t<Float, bool> gmp_geq(Float lhs, Float rhs) {
+    return (lhs > rhs) || (std::abs(lhs - rhs) <
+                           std::numeric_limits<Float>::epsilon());
+}
+
+template <typename Float>
+inline if_float_t<Float> decimal_part(Float x, mpz_class& intpart) {
+    Float i = std::trunc(x);
+    intpart = mpz_class(static_cast<double>(i));
+    return x - i;
+}
+
+template <typename Float>
+inline if_float_t<Float> log10(Float x) {
+    return std::log10(x);
+}
+
+template <typename Float>
+inline if_float_t<Float> sin(Float theta) {
+    return std::sin(theta);
+}
+
+template <typename Float>
+inline if_float_t<Float> cos(Float theta) {
+    return std::cos(theta);
+}
+
+template <typename Float>
+inline if_float_t<Float> sqrt(Float x) {
+    return std::sqrt(x);
+}
+
+/*
+ * Converts to a real number of type Real, e.g. an mpf_class to a double.
+ */
+template <typename Real>
+inline Real to_real(const mpf_class& x) {
+    if constexpr (std::is_same<Real, mpf_class>::value) {
+        return x;
+    } else {
+        long int exp;
+        double d = mpf_get_d_2exp(&exp, x.get_mpf_t());
+        if constexpr (sizeof(Real) > sizeof(double)) {
+            // Recover the bits beyond those of a double
+            mpf_class hi(d);
+            if (exp >= 0) {
+                mpf_mul_2exp(hi.get_mpf_t(), hi.get_mpf_t(), exp);
+            } else {
+                mpf_div_2exp(hi.get_mpf_t(), hi.get_mpf_t(), -exp);
+            }
+            mpf_class rest = x - hi;
+            long int rest_exp;
+            double r = mpf_get_d_2exp(&rest_exp, rest.get_mpf_t());
+            return std::ldexp(static_cast<Real>(d), exp) +
+                   std::ldexp(static_cast<Real>(r), rest_exp);
+        } else {
+            return std::ldexp(d, exp);
+        }
+    }
+}
+
+template <typename Real>
+inline Real to_real(const mpz_class& x) {
+    if constexpr (std::is_same<Real, mpf_class>::value) {
+        return mpf_class(x);
+    } else {
+        return to_real<Real>(mpf_class(x));
+    }
+}
+
 } // namespace gmpf
 } // namespace staq
 
@@ -33,6 +33,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 
 #include "staq/grid_synth/constants.hpp"
 #include "staq/grid_synth/rings.hpp"
@@ -99,9 +100,20 @@ class GridOperator {
     int_t d() const { return d_; }
     int_t dp() const { return dp_; }
 
-    mat_t mat_rep() const {
-        return mat_t{a_ + INV_SQRT2 * ap_, b_ + INV_SQRT2 * bp_,
-                     c_ + INV_SQRT2 * cp_, d_ + INV_SQRT2 * dp_};
+    template <typename Real = real_t>
+    mat2_t<Real> mat_rep() const {
+        if constexpr (std::is_same<Real, real_t>::value) {
+            return mat_t{a_ + INV_SQRT2 * ap_, b_ + INV_SQRT2 * bp_,
+                         c_ + INV_SQRT2 * cp_, d_ + INV_SQRT2 * dp_};
+        } else {
+            auto entry = [](const int_t& x, const int_t& xp) {
+                return gmpf::to_real<Real>(x) +
+                       RealConstants<Real>::inv_sqrt2() *
+                           gmpf::to_real<Real>(xp);
+            };
+            return mat2_t<Real>{entry(a_, ap_), entry(b_, bp_),
+                                entry(c_, cp_), entry(d_, dp_)};
+        }
     }
 
     // Returns sigma*G*sigma
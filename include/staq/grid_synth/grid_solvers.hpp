@@ -35,6 +35,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "staq/grid_synth/constants.hpp"
@@ -174,6 +175,51 @@ inline zsqrt2_vec_t oneD_grid_solver(const Interval<bound_t>& A,
     return solns;
 }
 
+/*
+ * Table of the powers LAMBDA^n, n >= 0, and LAMBDA_INV^-n, n < 0, with their
+ * decimal values, extended by one multiplication at a time as needed. The
+ * scale exponents of the 1D grid problems met in one rz search, and across
+ * searches, stay within a narrow range, so nearly every power is found in the
+ * table rather than recomputed. The table is cleared when the constants are
+ * initialized at another precision.
+ */
+class LambdaPowers {
+  public:
+    const ZSqrt2& power(long n) { return entry(n).first; }
+    const real_t& decimal(long n) { return entry(n).second; }
+
+  private:
+    std::vector<std::pair<ZSqrt2, real_t>> positive_;
+    std::vector<std::pair<ZSqrt2, real_t>> negative_;
+    long gmp_prec_ = 0;
+
+    const std::pair<ZSqrt2, real_t>& entry(long n) {
+        if (gmp_prec_ != DEFAULT_GMP_PREC) {
+            positive_.clear();
+            negative_.clear();
+            gmp_prec_ = DEFAULT_GMP_PREC;
+        }
+        auto& table = n >= 0 ? positive_ : negative_;
+        const ZSqrt2& base = n >= 0 ? LAMBDA : LAMBDA_INV;
+        std::size_t m = n >= 0 ? n : -n;
+        if (table.empty()) {
+            table.emplace_back(ZSqrt2(1, 0), ZSqrt2(1, 0).decimal());
+        }
+        while (table.size() <= m) {
+            ZSqrt2 next = table.back().first * base;
+            real_t next_decimal = next.decimal();
+            table.emplace_back(std::move(next), std::move(next_decimal));
+        }
+        return table[m];
+    }
+};
+
+/* The table of powers of LAMBDA used by this thread. */
+inline LambdaPowers& lambda_powers() {
+    thread_local LambdaPowers powers;
+    return powers;
+}
+
 /*
  * Solves the scaled 1D grid problem for the two intervals A and B. The variable
  * tol is used when determining the equality of floats in order to check
@@ -188,16 +234,11 @@ inline zsqrt2_vec_t oneD_scaled_grid_solver(const Interval<bound_t>& A,
                                             const Interval<bound_t>& B,
                                             const real_t tol = TOL) {
     zsqrt2_vec_t solns;
-    int_t k = find_scale_exponent(A);
-    Interval<bound_t> scaled_A = A;
-    Interval<bound_t> scaled_B = B;
-    if (k > 0) {
-        scaled_A = A * pow(LAMBDA_INV, k).decimal();
-        scaled_B = B * pow(-1 * LAMBDA, k).decimal();
-    } else {
-        scaled_A = A * pow(LAMBDA, -k).decimal();
-        scaled_B = B * pow(-1 * LAMBDA_INV, -k).decimal();
-    }
+    LambdaPowers& powers = lambda_powers();
+    long k = find_scale_exponent(A).get_si();
+    Interval<bound_t> scaled_A = A * powers.decimal(-k);
+    Interval<bound_t> scaled_B =
+        B * (k % 2 == 0 ? powers.decimal(k) : real_t(-powers.decimal(k)));
     int_t lowerb = lower_bound_b<bound_t>(scaled_A.lo(), scaled_B.hi(), tol);
     int_t upperb = upper_bound_b<bound_t>(scaled_A.hi(), scaled_B.lo(), tol);
     for (int_t b = lowerb; b <= upperb; b++) {
@@ -207,11 +248,7 @@ inline zsqrt2_vec_t oneD_scaled_grid_solver(const Interval<bound_t>& A,
             ZSqrt2 candidate(a, b);
             if (scaled_A.contains(candidate.decimal()) &&
                 scaled_B.contains(candidate.decimal_dot())) {
-                if (k > 0) {
-                    solns.push_back(candidate * pow(LAMBDA, k));
-                } else {
-                    solns.push_back(candidate * pow(LAMBDA_INV, -k));
-                }
+                solns.push_back(candidate * powers.power(k));
             }
         }
     }
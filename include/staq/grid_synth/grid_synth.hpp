@@ -27,6 +27,11 @@
 #ifndef GRID_SYNTH_GRID_SYNTH_HPP_
 #define GRID_SYNTH_GRID_SYNTH_HPP_
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "staq/grid_synth/angle_library.hpp"
 #include "staq/grid_synth/exact_synthesis.hpp"
 #include "staq/grid_synth/matrix.hpp"
 #include "staq/grid_synth/rz_approximation.hpp"
@@ -57,14 +62,27 @@ struct GridSynthOptions {
     bool details = false;
     bool verbose = false;
     bool timer = false;
+    int threads = 1; // Threads searching for each approximation, 0 for all
+    int ecm_curves = 0; // Elliptic curves tried on hard composites
+    str_t library = ""; // Angle library file, see angle_library.hpp
+    int skew_cache = 0; // Skew reductions kept for reuse by nearby angles
+};
+
+/* Result of synthesizing a single angle. */
+struct GridSynthResult {
+    str_t op_str;  // Gates, as returned by get_op_str
+    long t_count;  // T-count of the simplified gate string
+    real_t error;  // Distance from the exact rotation
 };
 
 class GridSynthesizer {
   private:
     std::unordered_map<str_t, str_t> angle_cache_;
     const domega_matrix_table_t S3_TABLE;
+    std::shared_ptr<const AngleLibrary> library_;
 
     real_t eps_;
+    long prec_;
     bool check_;
     bool details_;
     bool verbose_;
@@ -76,12 +94,23 @@ class GridSynthesizer {
     /* Construct GridSynthesizer objects using the make_synthesizer
      * factory function.
      */
-    GridSynthesizer(domega_matrix_table_t s3_table, real_t eps, bool check,
-                    bool details, bool verbose, bool timer)
-        : angle_cache_(), S3_TABLE(std::move(s3_table)), eps_(std::move(eps)),
+    GridSynthesizer(domega_matrix_table_t s3_table,
+                    std::shared_ptr<const AngleLibrary> library, real_t eps,
+                    long prec, bool check, bool details, bool verbose,
+                    bool timer)
+        : angle_cache_(), S3_TABLE(std::move(s3_table)),
+          library_(std::move(library)), eps_(std::move(eps)), prec_(prec),
           check_(check), details_(details), verbose_(verbose), timer_(timer),
           duration_(0), valid_(true) {}
 
+    /* Looks an angle up in the angle library, if there is one. */
+    const AngleLibraryEntry* find_in_library(const real_t& angle) const {
+        if (!library_) {
+            return nullptr;
+        }
+        return library_->find(angle / gmpf::gmp_pi(), prec_, TOL);
+    }
+
   public:
     ~GridSynthesizer() {}
 
@@ -109,6 +138,17 @@ class GridSynthesizer {
         if (verbose_) {
             std::cerr << "No common cases found" << '\n';
         }
+        if (const AngleLibraryEntry* entry = find_in_library(angle)) {
+            if (details_) {
+                std::cerr << "Angle is dyadic, answer is found in angle "
+                             "library "
+                          << library_->path() << '\n';
+            }
+            if (check_) {
+                std::cerr << "Check flag = " << 1 << '\n';
+            }
+            return library_->gates(*entry);
+        }
 
         RzApproximation rz_approx;
         str_t op_str;
@@ -196,6 +236,42 @@ class GridSynthesizer {
         return op_str;
     }
 
+    /*! \brief Synthesize an angle, reporting its T-count and error.
+     *
+     * Dyadic angles are looked up in the angle library, if there is one.
+     * Unlike get_op_str, this neither reads nor fills the angle cache and
+     * produces no output, so it may be called from several threads at once.
+     * Throws std::runtime_error if no approximation is found.
+     */
+    GridSynthResult synthesize_angle(const real_t& angle) const {
+        GridSynthResult ret;
+        ret.op_str = check_common_cases(angle / gmpf::gmp_pi(), eps_);
+        if (ret.op_str != "") {
+            // Distance of the angle from the multiple of pi/4 it was
+            // rounded to, as an error in Rz(angle)
+            real_t quarters = angle / gmpf::gmp_pi() * 4;
+            real_t delta = (quarters - floor(quarters + real_t("0.5"))) *
+                           gmpf::gmp_pi() / 16;
+            ret.error = abs(2 * gmpf::sin(delta));
+        } else if (const AngleLibraryEntry* entry = find_in_library(angle)) {
+            ret.op_str = library_->gates(*entry);
+            ret.error = entry->error;
+        } else {
+            RzApproximation rz_approx =
+                find_fast_rz_approximation(angle / real_t("-2.0"), eps_);
+            if (!rz_approx.solution_found()) {
+                throw std::runtime_error(
+                    "No approximation found for RzApproximation. "
+                    "Try changing factorization effort.");
+            }
+            ret.op_str = synthesize(rz_approx.matrix(), S3_TABLE);
+            ret.error = rz_approx.error();
+        }
+        str_t simplified = full_simplify_str(ret.op_str);
+        ret.t_count = std::count(simplified.begin(), simplified.end(), 'T');
+        return ret;
+    }
+
     friend GridSynthesizer make_synthesizer(const GridSynthOptions& opt);
 };
 
@@ -206,6 +282,15 @@ inline GridSynthesizer make_synthesizer(const GridSynthOptions& opt) {
     real_t eps = gmpf::pow(real_t(10), -opt.prec);
     MP_CONSTS = initialize_constants(opt.prec);
     MAX_ATTEMPTS_POLLARD_RHO = opt.factor_effort;
+    RZ_SEARCH_THREADS = opt.threads;
+    ECM_CURVES = opt.ecm_curves;
+    SKEW_CACHE_SIZE = opt.skew_cache;
+
+    // The library is only opened once an angle is looked up in it
+    std::shared_ptr<const AngleLibrary> library;
+    if (!opt.library.empty()) {
+        library = std::make_shared<const AngleLibrary>(opt.library);
+    }
 
     if (opt.verbose) {
         std::cerr << "Runtime Parameters" << '\n';
@@ -227,15 +312,28 @@ inline GridSynthesizer make_synthesizer(const GridSynthOptions& opt) {
                   << std::setw(1) << ": " << std::setw(3 * COLW) << std::left
                   << MAX_ATTEMPTS_POLLARD_RHO << '\n';
         std::cerr << std::setw(3 * COLW) << std::left
-                  << "MAX_ITERATIONS_FERMAT_TEST (How hard we try to check "
+                  << "MAX_ITERATIONS_MILLER_RABIN (How hard we try to check "
                      "primality) "
                   << std::setw(1) << ": " << std::setw(3 * COLW) << std::left
-                  << MAX_ITERATIONS_FERMAT_TEST << '\n';
+                  << MAX_ITERATIONS_MILLER_RABIN << '\n';
+        std::cerr << std::setw(3 * COLW) << std::left
+                  << "RZ_SEARCH_THREADS (Threads searching for solutions) "
+                  << std::setw(1) << ": " << std::setw(3 * COLW) << std::left
+                  << RZ_SEARCH_THREADS << '\n';
+        std::cerr << std::setw(3 * COLW) << std::left
+                  << "ECM_CURVES (Elliptic curves tried per composite) "
+                  << std::setw(1) << ": " << std::setw(3 * COLW) << std::left
+                  << ECM_CURVES << '\n';
+        std::cerr << std::setw(3 * COLW) << std::left
+                  << "SKEW_CACHE_SIZE (Skew reductions cached for reuse) "
+                  << std::setw(1) << ": " << std::setw(3 * COLW) << std::left
+                  << SKEW_CACHE_SIZE << '\n';
     }
     std::cerr << std::scientific;
 
-    return GridSynthesizer(std::move(s3_table), std::move(eps), opt.check,
-                           opt.details, opt.verbose, opt.timer);
+    return GridSynthesizer(std::move(s3_table), std::move(library),
+                           std::move(eps), opt.prec, opt.check, opt.details,
+                           opt.verbose, opt.timer);
 }
 
 } // namespace grid_synth
@@ -157,7 +157,7 @@ class mat2_t {
     mat2_t() = default;
 
     mat2_t(T m_00, T m_01, T m_10, T m_11)
-        : data_{row_vec2_t{m_00, m_01}, row_vec2_t{m_10, m_11}} {}
+        : data_{row_vec2_t<T>{m_00, m_01}, row_vec2_t<T>{m_10, m_11}} {}
 
     T determinant() const {
         return data_[0][0] * data_[1][1] - data_[0][1] * data_[1][0];
@@ -189,7 +189,7 @@ class mat2_t {
 
     mat2_t inverse() const {
         assert(determinant() != 0);
-        return (real_t(1.) / determinant()) *
+        return (T(1.) / determinant()) *
                mat2_t{data_[1][1], -data_[0][1], -data_[1][0], data_[0][0]};
     }
 
@@ -44,36 +44,45 @@ namespace grid_synth {
  * with smallest denominating exponent of base SQRT2 = k. Lemma 4 of
  * arXiv:1206.5236v4 implies that z_ and w_ have the same
  * denominating exponent, since |z_|^ + |w_|^2 = 1.
+ *
+ * Entries have coefficients of type Int, as for ZOmegaT.
  */
-class DOmegaMatrix {
+template <typename Int>
+class DOmegaMatrixT {
 
   private:
-    ZOmega u_;
-    ZOmega t_;
-    int_t k_; // power of SQRT2 in denominator
+    ZOmegaT<Int> u_;
+    ZOmegaT<Int> t_;
+    Int k_; // power of SQRT2 in denominator
     unsigned int l_;
 
   public:
-    DOmegaMatrix(const ZOmega& u, const ZOmega& t, const int_t& k,
-                 const unsigned int& l)
+    DOmegaMatrixT(const ZOmegaT<Int>& u, const ZOmegaT<Int>& t, const Int& k,
+                  const unsigned int& l)
         : u_(u), t_(t), k_(k), l_(l) {
         this->reduce();
         assert((l < 8) && (l >= 0));
     }
 
-    ZOmega u() const { return u_; }
-    ZOmega t() const { return t_; }
+    const ZOmegaT<Int>& u() const { return u_; }
+    const ZOmegaT<Int>& t() const { return t_; }
 
-    int_t k() const { return k_; }
+    const Int& k() const { return k_; }
     unsigned int l() const { return l_; }
 
-    int_t sde_u_sq() const {
-        if (u_ == ZOmega(0)) {
+    Int sde_u_sq() const { return sde_sq(u_, k_); }
+
+    /*
+     * Smallest denominator exponent of |u|^2, for u / SQRT2^k. Does not need
+     * u / SQRT2^k to be in lowest terms.
+     */
+    static Int sde_sq(const ZOmegaT<Int>& u, const Int& k) {
+        if (u == ZOmegaT<Int>(0)) {
             return 0;
         }
 
-        int_t s = 2 * k_;
-        ZOmega u_sq = u_ * u_.conj();
+        Int s = 2 * k;
+        ZOmegaT<Int> u_sq = u * u.conj();
 
         while (u_sq.is_reducible()) {
             u_sq = u_sq.reduce();
@@ -84,7 +93,7 @@ class DOmegaMatrix {
     }
 
     void reduce() {
-        if (u_ == ZOmega(0) && t_ == ZOmega(0)) {
+        if (u_ == ZOmegaT<Int>(0) && t_ == ZOmegaT<Int>(0)) {
             return;
         }
         while (u_.is_reducible() && t_.is_reducible()) {
@@ -94,29 +103,52 @@ class DOmegaMatrix {
         }
     }
 
-    DOmegaMatrix dagger() const {
-        return DOmegaMatrix(u_.conj(), -t_ * w_pow(-l_), k_, (8 - l_) % 8);
+    DOmegaMatrixT dagger() const {
+        return DOmegaMatrixT(u_.conj(), (-t_).mul_w_pow(-l_), k_,
+                             (8 - l_) % 8);
     }
 
-    DOmegaMatrix mul_by_w(const int n) const {
+    DOmegaMatrixT mul_by_w(const int n) const {
         assert(-1 < n && n < 8);
-        return (*this) * DOmegaMatrix(w_pow(n), ZOmega(0), 0, (2 * n) % 8);
+        return (*this) * DOmegaMatrixT(w_pow<Int>(n), ZOmegaT<Int>(0), 0,
+                                       (2 * n) % 8);
+    }
+
+    /*
+     * Converts the entries to another integer type, throwing
+     * std::overflow_error if they do not fit
+     */
+    template <typename To>
+    DOmegaMatrixT<To> cast() const {
+        return DOmegaMatrixT<To>(u_.template cast<To>(),
+                                 t_.template cast<To>(),
+                                 int_cast<To>(to_int_t(k_)), l_);
     }
 
-    DOmegaMatrix operator*(const DOmegaMatrix& B) const {
-        return DOmegaMatrix(u_ * B.u() - t_.conj() * B.t() * w_pow(l_),
-                            t_ * B.u() + u_.conj() * B.t() * w_pow(l_),
-                            k_ + B.k(), (l_ + B.l()) % 8);
+    /*
+     * The numerator of the u entry of (*this) * B, with denominator exponent
+     * k() + B.k(), without computing the rest of the product
+     */
+    ZOmegaT<Int> product_u(const DOmegaMatrixT& B) const {
+        return u_ * B.u() - (t_.conj() * B.t()).mul_w_pow(l_);
     }
 
-    bool operator==(const DOmegaMatrix& B) const {
+    DOmegaMatrixT operator*(const DOmegaMatrixT& B) const {
+        return DOmegaMatrixT(u_ * B.u() - (t_.conj() * B.t()).mul_w_pow(l_),
+                             t_ * B.u() + (u_.conj() * B.t()).mul_w_pow(l_),
+                             k_ + B.k(), (l_ + B.l()) % 8);
+    }
+
+    bool operator==(const DOmegaMatrixT& B) const {
         return ((u_ == B.u()) && (t_ == B.t()) && (k_ == B.k()) &&
                 (l_ == B.l()));
     }
 
-    bool operator!=(const DOmegaMatrix& B) const { return !((*this) == B); }
+    bool operator!=(const DOmegaMatrixT& B) const { return !((*this) == B); }
+
+}; // DOmegaMatrixT
 
-}; // DOmegaMatrix
+using DOmegaMatrix = DOmegaMatrixT<int_t>;
 
 // Custom hash for DOmegaMatrix
 struct DOmegaMatrixHash {
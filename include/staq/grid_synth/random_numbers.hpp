@@ -34,7 +34,11 @@
 namespace staq {
 namespace grid_synth {
 
-inline gmp_randclass random_numbers(gmp_randinit_mt);
+// Each thread has its own generator, since gmp_randclass is not thread-safe.
+// The generator is reseeded for every candidate solution, so it is a linear
+// congruential one, which is far cheaper to seed than the Mersenne twister.
+inline thread_local gmp_randclass random_numbers(gmp_randinit_lc_2exp_size,
+                                                 128);
 
 } // namespace grid_synth
 } // namespace staq
@@ -32,6 +32,7 @@
 #include <iomanip>
 #include <iostream>
 #include <stdexcept>
+#include <type_traits>
 
 #include <gmpxx.h>
 
@@ -72,7 +73,7 @@ class Interval {
     /*
      * fatten the interval by d on both the upper and lower bounds
      */
-    Interval fatten(const real_t& d) {
+    Interval fatten(const bound_t& d) {
         return Interval<bound_t>(lo_ - d, hi_ + d);
     }
 
@@ -101,7 +102,8 @@ class Interval {
         hi_ = hi_ + shift_factor;
     }
 
-    bool contains(const bound_t& x, const real_t tol = TOL) const {
+    bool contains(const bound_t& x,
+                  const bound_t tol = RealConstants<bound_t>::tol()) const {
         return ((hi_ - x) * (x - lo_) > 0) ||
                (gmpf::gmp_abs((hi_ - x) * (x - lo_)) < tol);
     }
@@ -200,7 +202,7 @@ class UprightRectangle {
 
     bound_t area() const { return area_; }
 
-    UprightRectangle fatten(const real_t& d) {
+    UprightRectangle fatten(const bound_t& d) {
         return UprightRectangle<bound_t>(x_interval_.fatten(d),
                                          y_interval_.fatten(d));
     }
@@ -241,58 +243,66 @@ inline std::ostream& operator<<(std::ostream& os,
     return os;
 }
 
-class Ellipse {
+/*
+ * Ellipses with coordinates of type Real, either real_t or a built-in floating
+ * point type.
+ */
+template <typename Real>
+class EllipseT {
   private:
-    using triple_t = std::array<real_t, 3>;
+    using triple_t = std::array<Real, 3>;
+    using vec_type = col_vec2_t<Real>;
+    using mat_type = mat2_t<Real>;
+    using consts = RealConstants<Real>;
 
-    vec_t center_;
-    mat_t D_;
+    vec_type center_;
+    mat_type D_;
 
-    real_t semi_major_axis_;
-    real_t semi_minor_axis_;
+    Real semi_major_axis_;
+    Real semi_minor_axis_;
 
-    real_t angle_;
+    Real angle_;
 
-    real_t z_;
-    real_t e_;
+    Real z_;
+    Real e_;
 
     void get_z_and_e_() {
-        z_ = real_t(
-            real_t(real_t("0.5") * gmpf::log10(real_t(D_(1, 1) / D_(0, 0)))) /
-            LOG_LAMBDA);
-        e_ = gmpf::sqrt(D_(1, 1) * D_(0, 0));
+        z_ = Real(Real(Real(0.5) * gmpf::log10(Real(D_(1, 1) / D_(0, 0)))) /
+                  consts::log_lambda());
+        e_ = gmpf::sqrt(Real(D_(1, 1) * D_(0, 0)));
     }
 
-    mat_t get_mat_from_axes_(const real_t& semi_major_axis,
-                             const real_t& semi_minor_axis,
-                             const real_t& angle) {
-        real_t ct = gmpf::cos(angle);
-        real_t st = gmpf::sin(angle);
-        real_t inva = real_t("1") / semi_minor_axis;
-        real_t invb = real_t("1") / semi_major_axis;
+    mat_type get_mat_from_axes_(const Real& semi_major_axis,
+                                const Real& semi_minor_axis,
+                                const Real& angle) {
+        Real ct = gmpf::cos(angle);
+        Real st = gmpf::sin(angle);
+        Real inva = Real(1) / semi_minor_axis;
+        Real invb = Real(1) / semi_major_axis;
 
-        mat_t M{ct * ct * inva * inva + st * st * invb * invb,
-                ct * st * (inva * inva - invb * invb),
-                ct * st * (inva * inva - invb * invb),
-                st * st * inva * inva + ct * ct * invb * invb};
+        mat_type M{ct * ct * inva * inva + st * st * invb * invb,
+                   ct * st * (inva * inva - invb * invb),
+                   ct * st * (inva * inva - invb * invb),
+                   st * st * inva * inva + ct * ct * invb * invb};
 
         return M;
     }
 
-    triple_t get_axes_from_mat_(const vec_t& center, const mat_t& D) {
+    triple_t get_axes_from_mat_(const vec_type& center, const mat_type& D) {
         using namespace std;
-        real_t m = real_t("1") / sqrt(D.determinant());
-        real_t msq = m * m;
-        real_t T = D.trace();
-        real_t angle = real_t("0");
-        real_t shift = PI * (real_t("0.25") * (sgn<real_t>(center(0)) -
-                                               sgn<real_t>(center(1))) +
-                             real_t("1"));
-        if ((sgn<real_t>(center(0)) == 0) && (sgn<real_t>(center(1)) == 0)) {
+        Real m = Real(1) / sqrt(D.determinant());
+        Real msq = m * m;
+        Real T = D.trace();
+        Real angle = Real(0);
+        Real shift =
+            consts::pi() *
+            (Real(0.25) * (sgn<Real>(center(0)) - sgn<Real>(center(1))) +
+             Real(1));
+        if ((sgn<Real>(center(0)) == 0) && (sgn<Real>(center(1)) == 0)) {
             shift = 0;
         }
 
-        if ((sgn<real_t>(center(0)) == 1) && (sgn<real_t>(center(1)) == 1)) {
+        if ((sgn<Real>(center(0)) == 1) && (sgn<Real>(center(1)) == 1)) {
             shift = 0;
         }
 
@@ -301,16 +311,17 @@ class Ellipse {
         // endl; cout << fixed << setprecision(100) << T*msq << endl; cout <<
         // fixed << setprecision(100) << "disc = "
         //           <<(T * msq - sqrt(T * T * msq * msq - 4 * msq))<< endl;
-        real_t a1 = 0;
-        real_t a2 = 0;
-        if (gmpf::gmp_abs(T * T * msq * msq - real_t("4") * msq) < TOL) {
-            a1 = sqrt(T * msq) / real_t("2");
-            a2 = sqrt(T * msq) / real_t("2");
+        Real a1 = 0;
+        Real a2 = 0;
+        if (gmpf::gmp_abs(Real(T * T * msq * msq - Real(4) * msq)) <
+            consts::tol()) {
+            a1 = sqrt(T * msq) / Real(2);
+            a2 = sqrt(T * msq) / Real(2);
         } else {
-            a1 = sqrt((T * msq - sqrt(T * T * msq * msq - real_t("4") * msq)) /
-                      real_t("2"));
-            a2 = sqrt((T * msq + sqrt(T * T * msq * msq - real_t("4") * msq)) /
-                      real_t("2"));
+            a1 = sqrt((T * msq - sqrt(T * T * msq * msq - Real(4) * msq)) /
+                      Real(2));
+            a2 = sqrt((T * msq + sqrt(T * T * msq * msq - Real(4) * msq)) /
+                      Real(2));
         }
         // real_t od = D(0,1);
         // cout << fixed << setprecision(100) << mpf_class((2 * od * a1 * a1 *
@@ -337,7 +348,8 @@ class Ellipse {
      * There is an issue in using this function in general since there is an
      * ambiguity between the ordering of the axes and the angle of the function.
      */
-    Ellipse(const vec_t& center, const mat_t& D) : center_(center), D_(D) {
+    EllipseT(const vec_type& center, const mat_type& D)
+        : center_(center), D_(D) {
         triple_t axes_angle = get_axes_from_mat_(center_, D_);
         semi_major_axis_ = axes_angle[0];
         semi_minor_axis_ = axes_angle[1];
@@ -351,9 +363,9 @@ class Ellipse {
      * semi_major_axis is the semi axis that would be aligned with x if angle
      * were rotated to be zero.
      */
-    Ellipse(const real_t& x0, const real_t& y0, const real_t& semi_major_axis,
-            const real_t& semi_minor_axis, const real_t& angle)
-        : center_(vec_t{x0, y0}), semi_major_axis_(semi_major_axis),
+    EllipseT(const Real& x0, const Real& y0, const Real& semi_major_axis,
+             const Real& semi_minor_axis, const Real& angle)
+        : center_(vec_type{x0, y0}), semi_major_axis_(semi_major_axis),
           semi_minor_axis_(semi_minor_axis), angle_(angle) {
         center_ = {x0, y0};
         D_ = get_mat_from_axes_(semi_major_axis_, semi_minor_axis_, angle_);
@@ -364,42 +376,63 @@ class Ellipse {
      * Constructs the optimal bounding ellipse for the epsilon region at angle
      * angle.
      */
-    Ellipse(const real_t& angle, const real_t& eps) : angle_(angle) {
-        real_t r0 = (real_t("3") - eps * eps) / real_t("3");
-        center_ = vec_t{r0 * gmpf::cos(angle), r0 * gmpf::sin(angle)};
+    EllipseT(const Real& angle, const Real& eps) : angle_(angle) {
+        using namespace std;
+        Real r0 = (Real(3) - eps * eps) / Real(3);
+        center_ = vec_type{r0 * gmpf::cos(angle), r0 * gmpf::sin(angle)};
 
-        semi_major_axis_ = (real_t("2") / sqrt(real_t("3")) * eps *
-                            sqrt(real_t("1") - (eps * eps / real_t("4"))));
-        semi_minor_axis_ = (eps * eps / real_t("3"));
+        semi_major_axis_ = (Real(2) / sqrt(Real(3)) * eps *
+                            sqrt(Real(1) - (eps * eps / Real(4))));
+        semi_minor_axis_ = (eps * eps / Real(3));
 
         D_ = get_mat_from_axes_(semi_major_axis_, semi_minor_axis_, angle_);
         get_z_and_e_();
     }
 
-    mat_t D() const { return D_; }
-    real_t D(int i, int j) const { return D_(i, j); }
+    /*
+     * Converts an ellipse with coordinates of another type
+     */
+    template <typename From>
+    static EllipseT from(const EllipseT<From>& A) {
+        auto conv = [](const From& x) {
+            if constexpr (std::is_same<From, real_t>::value) {
+                return gmpf::to_real<Real>(x);
+            } else {
+                return Real(x);
+            }
+        };
+        return EllipseT(vec_type{conv(A.center(0)), conv(A.center(1))},
+                        mat_type{conv(A.D(0, 0)), conv(A.D(0, 1)),
+                                 conv(A.D(1, 0)), conv(A.D(1, 1))});
+    }
+
+    mat_type D() const { return D_; }
+    Real D(int i, int j) const { return D_(i, j); }
 
-    vec_t center() const { return center_; }
-    real_t center(int i) const { return center_(i); }
+    vec_type center() const { return center_; }
+    Real center(int i) const { return center_(i); }
 
-    real_t semi_major_axis() const { return semi_major_axis_; }
-    real_t semi_minor_axis() const { return semi_minor_axis_; }
-    real_t angle() const { return angle_; }
+    Real semi_major_axis() const { return semi_major_axis_; }
+    Real semi_minor_axis() const { return semi_minor_axis_; }
+    Real angle() const { return angle_; }
 
-    real_t e() const { return e_; }
-    real_t z() const { return z_; }
+    Real e() const { return e_; }
+    Real z() const { return z_; }
 
-    real_t determinant() const { return D_.determinant(); }
-    real_t area() const { return PI * semi_major_axis_ * semi_minor_axis_; }
+    Real determinant() const { return D_.determinant(); }
+    Real area() const {
+        return consts::pi() * semi_major_axis_ * semi_minor_axis_;
+    }
 
     // uprightness of ellipse
-    real_t up() const {
-        return (real_t(PI) / real_t(4)) *
+    Real up() const {
+        using namespace std;
+        return (Real(consts::pi()) / Real(4)) *
                sqrt(D_.determinant() / (D_(0, 0) * D_(1, 1)));
     }
 
-    void rescale(const real_t scale) {
-        D_ = (real_t("1") / (scale * scale)) * D_;
+    void rescale(const Real scale) {
+        D_ = (Real(1) / (scale * scale)) * D_;
         semi_minor_axis_ = semi_minor_axis_ * gmpf::gmp_abs(scale);
         semi_major_axis_ = semi_major_axis_ * gmpf::gmp_abs(scale);
         center_ = scale * center_;
@@ -411,38 +444,43 @@ class Ellipse {
      *  Normalizes the ellipse so that it's area is Pi, returns the
      * normalization factor.
      */
-    real_t normalize() {
-        real_t scale = sqrt(sqrt(D_.determinant()));
+    Real normalize() {
+        using namespace std;
+        Real scale = sqrt(sqrt(D_.determinant()));
         rescale(scale);
         return scale;
     }
 
-    bool contains(const vec_t& point, const real_t& tol = TOL) const {
-        using namespace std;
-        real_t x = (point - center_).transpose() * D_ * (point - center_);
-        return (x < real_t("1")) || (gmpf::gmp_abs(x - real_t("1")) < tol);
+    bool contains(const vec_type& point,
+                  const Real& tol = consts::tol()) const {
+        Real x = (point - center_).transpose() * D_ * (point - center_);
+        return (x < Real(1)) || (gmpf::gmp_abs(Real(x - Real(1))) < tol);
     }
 
-    bool contains(const real_t& x, const real_t& y,
-                  const real_t& tol = TOL) const {
-        return contains(vec_t{x, y}, tol);
+    bool contains(const Real& x, const Real& y,
+                  const Real& tol = consts::tol()) const {
+        return contains(vec_type{x, y}, tol);
     }
 
-    bool contains(const cplx_t& z, const real_t& tol = TOL) const {
-        return contains(vec_t{z.real(), z.imag()}, tol);
+    bool contains(const cplx_t& z, const Real& tol = consts::tol()) const {
+        return contains(vec_type{z.real(), z.imag()}, tol);
     }
 
-    UprightRectangle<real_t> bounding_box() const {
-        real_t X_val = sqrt(D_(1, 1) / (D_.determinant()));
-        real_t Y_val = sqrt(D_(0, 0) / (D_.determinant()));
+    UprightRectangle<Real> bounding_box() const {
+        using namespace std;
+        Real X_val = sqrt(D_(1, 1) / (D_.determinant()));
+        Real Y_val = sqrt(D_(0, 0) / (D_.determinant()));
 
-        return UprightRectangle<real_t>(center_(0) - X_val, center_(0) + X_val,
-                                        center_(1) - Y_val, center_(1) + Y_val);
+        return UprightRectangle<Real>(center_(0) - X_val, center_(0) + X_val,
+                                      center_(1) - Y_val, center_(1) + Y_val);
     }
 
-}; // class Ellipse
+}; // class EllipseT
+
+using Ellipse = EllipseT<real_t>;
 
-inline std::ostream& operator<<(std::ostream& os, const Ellipse& A) {
+template <typename Real>
+inline std::ostream& operator<<(std::ostream& os, const EllipseT<Real>& A) {
     os << "---" << std::endl;
     os << A.D() << std::endl;
     os << "semi-major axis = " << A.semi_major_axis() << std::endl;
@@ -456,13 +494,19 @@ inline std::ostream& operator<<(std::ostream& os, const Ellipse& A) {
 /*
  * Applies the grid operator G to the ellipse A.
  */
-inline Ellipse operator*(const SpecialGridOperator& G, const Ellipse& A) {
-    return Ellipse(G.inverse().mat_rep() * A.center(),
-                   G.transpose().mat_rep() * A.D() * G.mat_rep());
+template <typename Real>
+inline EllipseT<Real> operator*(const SpecialGridOperator& G,
+                                const EllipseT<Real>& A) {
+    return EllipseT<Real>(G.inverse().mat_rep<Real>() * A.center(),
+                          G.transpose().mat_rep<Real>() * A.D() *
+                              G.mat_rep<Real>());
 }
 
-inline Ellipse operator*(const mat_t& M, const Ellipse& A) {
-    return Ellipse(M.inverse() * A.center(), M.transpose() * A.D() * M);
+template <typename Real>
+inline EllipseT<Real> operator*(const mat2_t<Real>& M,
+                                const EllipseT<Real>& A) {
+    return EllipseT<Real>(M.inverse() * A.center(),
+                          M.transpose() * A.D() * M);
 }
 
 } // namespace grid_synth
@@ -27,6 +27,7 @@
 #ifndef GRID_SYNTH_RINGS_HPP_
 #define GRID_SYNTH_RINGS_HPP_
 
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
@@ -34,6 +35,7 @@
 #include <string>
 #include <vector>
 
+#include "staq/grid_synth/checked_int.hpp"
 #include "staq/grid_synth/constants.hpp"
 #include "staq/grid_synth/gmp_functions.hpp"
 #include "staq/grid_synth/types.hpp"
@@ -48,36 +50,41 @@ namespace grid_synth {
  *    dot(a + b\sqrt{2}) = a - b\sqrt{2}
  *
  * This is to avoid confusion with complex conjugation.
+ *
+ * The coefficients have type Int, which is int_t except in the fixed-width
+ * fast paths (see checked_int.hpp). Members using real_t or the euclidean
+ * structure of the ring are only available for int_t.
  */
-class ZSqrt2 {
+template <typename Int>
+class ZSqrt2T {
 
   private:
-    int_t a_;
-    int_t b_;
+    Int a_;
+    Int b_;
 
   public:
-    explicit ZSqrt2(){};
+    explicit ZSqrt2T(){};
 
-    explicit ZSqrt2(const int_t& a) : a_(a), b_(0) {}
+    explicit ZSqrt2T(const Int& a) : a_(a), b_(0) {}
 
-    ZSqrt2(const int_t& a, const int_t& b) : a_(a), b_(b) {}
+    ZSqrt2T(const Int& a, const Int& b) : a_(a), b_(b) {}
 
-    int_t a() const { return a_; }
-    int_t b() const { return b_; }
+    const Int& a() const { return a_; }
+    const Int& b() const { return b_; }
 
     real_t decimal() const { return a_ + (b_ * SQRT2); }
     real_t decimal_dot() const { return (a_ - b_ * SQRT2); }
 
-    int_t norm() const { return a_ * a_ - (2 * b_ * b_); }
-    ZSqrt2 dot() const { return ZSqrt2(a_, -b_); }
+    Int norm() const { return a_ * a_ - (2 * b_ * b_); }
+    ZSqrt2T dot() const { return ZSqrt2T(a_, -b_); }
 
-    std::string get_string() {
+    std::string get_string() const {
         std::stringstream ss;
         ss << "(" << a_ << "," << b_ << ")";
         return ss.str();
     }
 
-    ZSqrt2 self_sqrt() const {
+    ZSqrt2T self_sqrt() const {
         using namespace gmpf;
         real_t a, b;
         int_t b_squared_plus = int_t((a_ + sqrt((*this).norm())) / real_t(4));
@@ -104,58 +111,58 @@ class ZSqrt2 {
             a = b_ / (2 * b);
         }
 
-        return ZSqrt2(gmpf::gmp_round(a), gmpf::gmp_round(b));
+        return ZSqrt2T(gmpf::gmp_round(a), gmpf::gmp_round(b));
     }
 
     // Arithmetic operators
     // ====================
-    ZSqrt2 operator+(const ZSqrt2& Z) const {
-        return ZSqrt2(a_ + Z.a(), b_ + Z.b());
+    ZSqrt2T operator+(const ZSqrt2T& Z) const {
+        return ZSqrt2T(a_ + Z.a(), b_ + Z.b());
     }
 
-    ZSqrt2 operator-(const ZSqrt2& Z) const {
-        return ZSqrt2(a_ - Z.a(), b_ - Z.b());
+    ZSqrt2T operator-(const ZSqrt2T& Z) const {
+        return ZSqrt2T(a_ - Z.a(), b_ - Z.b());
     }
 
-    ZSqrt2 operator*(const ZSqrt2& Z) const {
-        return ZSqrt2(a_ * Z.a() + 2 * b_ * Z.b(), (a_ * Z.b() + b_ * Z.a()));
+    ZSqrt2T operator*(const ZSqrt2T& Z) const {
+        return ZSqrt2T(a_ * Z.a() + 2 * b_ * Z.b(), (a_ * Z.b() + b_ * Z.a()));
     }
 
     /*
      * For a / b finds the largest q such that a > bq
      */
-    ZSqrt2 operator/(const ZSqrt2& Z) const {
+    ZSqrt2T operator/(const ZSqrt2T& Z) const {
         using namespace std;
         real_t mag = Z.norm();
         int_t a = gmpf::gmp_round(real_t(a_ * Z.a() - 2 * b_ * Z.b()) / mag);
         int_t b = gmpf::gmp_round(real_t(b_ * Z.a() - a_ * Z.b()) / mag);
-        return ZSqrt2(a, b);
+        return ZSqrt2T(a, b);
     }
 
     /*
      * For a % b finds q and r such that a = bq + r.
      */
-    ZSqrt2 operator%(const ZSqrt2& Z) const {
+    ZSqrt2T operator%(const ZSqrt2T& Z) const {
         return (*this) - (*this / Z) * Z;
     }
 
     // Assignment and compound assignment operators
     // ===========================================
-    ZSqrt2& operator+=(const ZSqrt2& Z) {
+    ZSqrt2T& operator+=(const ZSqrt2T& Z) {
         a_ += Z.a();
         b_ += Z.b();
         return *this;
     }
 
-    ZSqrt2& operator-=(const ZSqrt2& Z) {
+    ZSqrt2T& operator-=(const ZSqrt2T& Z) {
         a_ -= Z.a();
         b_ -= Z.b();
         return *this;
     }
 
-    ZSqrt2& operator*=(const ZSqrt2& Z) {
-        int_t olda = a_;
-        int_t oldb = b_;
+    ZSqrt2T& operator*=(const ZSqrt2T& Z) {
+        Int olda = a_;
+        Int oldb = b_;
         a_ = olda * Z.a() + 2 * oldb * Z.b();
         b_ = olda * Z.b() + oldb * Z.a();
         return *this;
@@ -169,80 +176,83 @@ class ZSqrt2 {
                   << this->decimal_dot() << std::endl;
     }
 
-}; // class ZSqrt2
+    // Non-member operator overrides
+    // =============================
+    friend std::ostream& operator<<(std::ostream& os, const ZSqrt2T& Z) {
+        os << "(" << Z.a() << "," << Z.b() << ")";
+        return os;
+    }
 
-inline ZSqrt2 pow(const ZSqrt2& Z, const int_t& k) {
-    try {
-        if (k < 0) {
-            throw std::invalid_argument("Operator ^ for ZSqrt2 expects k > 0");
-        }
-    } catch (std::invalid_argument const& ex) {
-        std::cout << ex.what() << std::endl;
-        exit(EXIT_FAILURE);
+    friend ZSqrt2T operator*(const ZSqrt2T& Z, const Int& c) {
+        return ZSqrt2T(Z.a() * c, Z.b() * c);
     }
 
-    ZSqrt2 result(1, 0);
+    friend ZSqrt2T operator*(const Int& c, const ZSqrt2T Z) {
+        return ZSqrt2T(Z.a() * c, Z.b() * c);
+    }
 
-    for (int_t i = 0; i < k; i++) {
-        result *= Z;
+    friend bool operator==(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return (Y.a() == Z.a()) && (Y.b() == Z.b());
     }
 
-    return result;
-}
+    friend bool operator!=(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return (Y.a() != Z.a()) || (Y.b() != Z.b());
+    }
 
-// Non-member operator overrides for ZSqrt2
-// ========================================
-inline std::ostream& operator<<(std::ostream& os, const ZSqrt2& Z) {
-    os << "(" << Z.a() << "," << Z.b() << ")";
-    return os;
-}
+    friend bool operator>=(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return (Y.decimal() > Z.decimal()) || (Y == Z);
+    }
 
-inline ZSqrt2 operator*(const ZSqrt2& Z, const int_t& c) {
-    return ZSqrt2(Z.a() * c, Z.b() * c);
-}
+    friend bool operator<=(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return (Y.decimal() < Z.decimal()) || (Y == Z);
+    }
 
-inline ZSqrt2 operator*(const int_t& c, const ZSqrt2 Z) {
-    return ZSqrt2(Z.a() * c, Z.b() * c);
-}
+    friend bool operator>(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return Y.decimal() > Z.decimal();
+    }
 
-inline bool operator==(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return (Y.a() == Z.a()) && (Y.b() == Z.b());
-}
+    friend bool operator<(const ZSqrt2T& Y, const ZSqrt2T& Z) {
+        return Y.decimal() < Z.decimal();
+    }
 
-inline bool operator!=(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return (Y.a() != Z.a()) || (Y.b() != Z.b());
-}
+    friend bool operator>(const ZSqrt2T Z, const real_t& x) {
+        return Z.decimal() > x;
+    }
 
-inline bool operator>=(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return (Y.decimal() > Z.decimal()) || (Y == Z);
-}
+    friend bool operator>(const real_t& x, const ZSqrt2T& Z) {
+        return x > Z.decimal();
+    }
 
-inline bool operator<=(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return (Y.decimal() < Z.decimal()) || (Y == Z);
-}
+    friend bool operator<(const ZSqrt2T& Z, const real_t& x) {
+        return Z.decimal() < x;
+    }
 
-inline bool operator>(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return Y.decimal() > Z.decimal();
-}
+    friend bool operator<(const real_t& x, const ZSqrt2T& Z) {
+        return x < Z.decimal();
+    }
 
-inline bool operator<(const ZSqrt2& Y, const ZSqrt2& Z) {
-    return Y.decimal() < Z.decimal();
-}
+}; // class ZSqrt2T
 
-inline bool operator>(const ZSqrt2 Z, const real_t& x) {
-    return Z.decimal() > x;
-}
+using ZSqrt2 = ZSqrt2T<int_t>;
 
-inline bool operator>(const real_t& x, const ZSqrt2& Z) {
-    return x > Z.decimal();
-}
+template <typename Int>
+inline ZSqrt2T<Int> pow(const ZSqrt2T<Int>& Z, const int_t& k) {
+    try {
+        if (k < 0) {
+            throw std::invalid_argument("Operator ^ for ZSqrt2 expects k > 0");
+        }
+    } catch (std::invalid_argument const& ex) {
+        std::cout << ex.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
-inline bool operator<(const ZSqrt2& Z, const real_t& x) {
-    return Z.decimal() < x;
-}
+    ZSqrt2T<Int> result(1, 0);
 
-inline bool operator<(const real_t& x, const ZSqrt2& Z) {
-    return x < Z.decimal();
+    for (int_t i = 0; i < k; i++) {
+        result *= Z;
+    }
+
+    return result;
 }
 
 /**
@@ -250,201 +260,176 @@ inline bool operator<(const real_t& x, const ZSqrt2& Z) {
  * element is represented in two forms. First by two quadratic integers
  * with radicand 2, alpha and beta, and a boolean. Thus we have,
  *
- *    u = alpha_ + beta_*i + w_*OMEGA
+ *    u = alpha + beta*i + w*OMEGA
  *
- *  where w_ is zero or one, and OMEGA is the constant (1+i)/SQRT2.
+ *  where w is zero or one, and OMEGA is the constant (1+i)/SQRT2.
  *  Second in the standard form,
  *
  *    u = a_*OMEGA^3 + b_*OMEGA^2 + c_*OMEGA + d
+ *
+ *  Only the standard form is stored, along with w_, as the two are related by
+ *
+ *    alpha = d + (c - a - w)/2 SQRT2,  beta = b + (c + a - w)/2 SQRT2
+ *
+ *  Coefficients have type Int, as for ZSqrt2T.
  */
-class ZOmega {
+template <typename Int>
+class ZOmegaT {
   private:
-    int_t a_;
-    int_t b_;
-    int_t c_;
-    int_t d_;
-
-    ZSqrt2 alpha_;
-    ZSqrt2 beta_;
-    cplx_t w_;
-
-  public:
-    explicit ZOmega(const int_t& d)
-        : a_(0), b_(0), c_(0), d_(d), w_(cplx_t(0, 0)) {
-        int_t alpha1, alpha2, beta1, beta2;
+    Int a_;
+    Int b_;
+    Int c_;
+    Int d_;
 
-        alpha1 = d_;
-        alpha2 = (c_ - a_ - w_.real()) / 2;
-        beta1 = (b_);
-        beta2 = (c_ + a_ - w_.real()) / 2;
+    int w_; // (c + a) % 2, unless given explicitly
 
-        alpha_ = ZSqrt2(alpha1, alpha2);
-        beta_ = ZSqrt2(beta1, beta2);
+    static int parity(const Int& x) {
+        if (x % 2 == 0) {
+            return 0;
+        }
+        return x < 0 ? -1 : 1;
     }
 
-    ZOmega(const int_t& a, const int_t& b, const int_t& c, const int_t& d)
-        : a_(a), b_(b), c_(c), d_(d) {
-        int_t alpha1, alpha2, beta1, beta2;
+  public:
+    explicit ZOmegaT(const Int& d) : a_(0), b_(0), c_(0), d_(d), w_(0) {}
 
-        w_ = cplx_t((c_ + a_) % 2, 0.0);
+    ZOmegaT(const Int& a, const Int& b, const Int& c, const Int& d)
+        : a_(a), b_(b), c_(c), d_(d), w_(parity(c_ + a_)) {}
 
-        alpha1 = d_;
-        alpha2 = (c_ - a_ - w_.real()) / 2;
-        beta1 = (b_);
-        beta2 = (c_ + a_ - w_.real()) / 2;
+    ZOmegaT(const ZSqrt2T<Int>& alpha, const ZSqrt2T<Int>& beta,
+            const bool& w)
+        : a_(beta.b() - alpha.b()), b_(beta.a()),
+          c_(beta.b() + alpha.b() + int(w)), d_(alpha.a()), w_(w) {}
 
-        alpha_ = ZSqrt2(alpha1, alpha2);
-        beta_ = ZSqrt2(beta1, beta2);
-    }
+    const Int& a() const { return a_; }
+    const Int& b() const { return b_; }
+    const Int& c() const { return c_; }
+    const Int& d() const { return d_; }
 
-    ZOmega(const ZSqrt2& alpha, const ZSqrt2& beta, const bool& w)
-        : alpha_(alpha), beta_(beta), w_(cplx_t(w, 0.0)) {
-        a_ = beta_.b() - alpha_.b();
-        b_ = beta.a();
-        c_ = beta_.b() + alpha_.b() + w;
-        d_ = alpha.a();
-    }
-
-    int_t a() const { return a_; }
-    int_t b() const { return b_; }
-    int_t c() const { return c_; }
-    int_t d() const { return d_; }
-
-    ZSqrt2 alpha() const { return alpha_; }
-    ZSqrt2 beta() const { return beta_; }
+    ZSqrt2T<Int> alpha() const { return ZSqrt2T<Int>(d_, (c_ - a_ - w_) / 2); }
+    ZSqrt2T<Int> beta() const { return ZSqrt2T<Int>(b_, (c_ + a_ - w_) / 2); }
 
     /*
      * For an element u, returns the ring norm u^dagger * u
      */
-    ZSqrt2 norm() const {
-        return ZSqrt2(a_ * a_ + b_ * b_ + c_ * c_ + d_ * d_,
-                      c_ * b_ + d_ * c_ + b_ * a_ - a_ * d_);
+    ZSqrt2T<Int> norm() const {
+        return ZSqrt2T<Int>(a_ * a_ + b_ * b_ + c_ * c_ + d_ * d_,
+                            c_ * b_ + d_ * c_ + b_ * a_ - a_ * d_);
     }
 
-    bool is_reducible() {
+    bool is_reducible() const {
         if (((a_ + c_) % 2 == 0) && ((b_ + d_) % 2 == 0)) {
             return true;
         }
         return false;
     }
 
-    ZOmega reduce() {
+    ZOmegaT reduce() const {
         assert(this->is_reducible());
 
-        return ZOmega((b_ - d_) / 2, (a_ + c_) / 2, (b_ + d_) / 2,
-                      (c_ - a_) / 2);
+        return ZOmegaT((b_ - d_) / 2, (a_ + c_) / 2, (b_ + d_) / 2,
+                       (c_ - a_) / 2);
     }
 
-    bool w() const { return gmpf::gmp_round(w_.real()) != 0; }
+    bool w() const { return w_ != 0; }
 
-    ZOmega dot() const { return ZOmega(-a_, b_, -c_, d_); }
-    ZOmega conj() const { return ZOmega(-c_, -b_, -a_, d_); }
+    ZOmegaT dot() const { return ZOmegaT(-a_, b_, -c_, d_); }
+    ZOmegaT conj() const { return ZOmegaT(-c_, -b_, -a_, d_); }
 
-    real_t real() const {
-        return (alpha_.decimal() + beta_.decimal() * Im + w_ * OMEGA).real();
-    }
-    real_t imag() const {
-        return (alpha_.decimal() + beta_.decimal() * Im + w_ * OMEGA).imag();
+    /*
+     * Returns u * OMEGA^l, which permutes the coefficients up to sign
+     */
+    ZOmegaT mul_w_pow(int l) const {
+        switch ((8 + l % 8) % 8) {
+            case 0:
+                return *this;
+            case 1:
+                return ZOmegaT(b_, c_, d_, -a_);
+            case 2:
+                return ZOmegaT(c_, d_, -a_, -b_);
+            case 3:
+                return ZOmegaT(d_, -a_, -b_, -c_);
+            case 4:
+                return ZOmegaT(-a_, -b_, -c_, -d_);
+            case 5:
+                return ZOmegaT(-b_, -c_, -d_, a_);
+            case 6:
+                return ZOmegaT(-c_, -d_, a_, b_);
+            default:
+                return ZOmegaT(-d_, a_, b_, c_);
+        }
     }
 
+    real_t real() const { return decimal().real(); }
+    real_t imag() const { return decimal().imag(); }
+
     cplx_t decimal() const {
-        return alpha_.decimal() + beta_.decimal() * Im + w_ * OMEGA;
+        return alpha().decimal() + beta().decimal() * Im +
+               cplx_t(real_t(w_), real_t(0)) * OMEGA;
     }
 
-    ZSqrt2 to_zsqrt2() {
+    ZSqrt2T<Int> to_zsqrt2() const {
         if (b_ != 0) {
             std::cout << "ZOmega method to_zsqrt2 expects b_ == 0" << std::endl;
             exit(EXIT_FAILURE);
         }
-        return ZSqrt2(d_, c_);
+        return ZSqrt2T<Int>(d_, c_);
     }
 
-    std::string get_standard_string() {
+    /*
+     * Converts the coefficients to another integer type, throwing
+     * std::overflow_error if they do not fit
+     */
+    template <typename To>
+    ZOmegaT<To> cast() const {
+        return ZOmegaT<To>(int_cast<To>(to_int_t(a_)),
+                           int_cast<To>(to_int_t(b_)),
+                           int_cast<To>(to_int_t(c_)),
+                           int_cast<To>(to_int_t(d_)));
+    }
+
+    std::string get_standard_string() const {
         std::stringstream ss;
         ss << "(" << a_ << "," << b_ << "," << c_ << "," << d_ << ")";
 
         return ss.str();
     }
 
-    std::string get_zsqrt2_string() {
+    std::string get_zsqrt2_string() const {
         std::stringstream ss;
 
-        ss << "(" << alpha_.a() << "," << alpha_.b() << "," << beta_.a() << ","
-           << beta_.b() << "," << int_t(w_.real()) << ")";
+        ss << "(" << alpha().a() << "," << alpha().b() << "," << beta().a()
+           << "," << beta().b() << "," << w_ << ")";
 
         return ss.str();
     }
 
     // Arithmetic operators
     // ====================
-    ZOmega operator+(const ZOmega& Z) const {
-        return ZOmega(a_ + Z.a(), b_ + Z.b(), c_ + Z.c(), d_ + Z.d());
+    ZOmegaT operator+(const ZOmegaT& Z) const {
+        return ZOmegaT(a_ + Z.a(), b_ + Z.b(), c_ + Z.c(), d_ + Z.d());
     }
 
-    ZOmega operator-(const ZOmega& Z) const {
-        return ZOmega(a_ - Z.a(), b_ - Z.b(), c_ - Z.c(), d_ - Z.d());
+    ZOmegaT operator-(const ZOmegaT& Z) const {
+        return ZOmegaT(a_ - Z.a(), b_ - Z.b(), c_ - Z.c(), d_ - Z.d());
     }
 
-    ZOmega operator-() const { return ZOmega(-a_, -b_, -c_, -d_); }
+    ZOmegaT operator-() const { return ZOmegaT(-a_, -b_, -c_, -d_); }
 
-    ZOmega operator*(const ZOmega& Z) const {
-        return ZOmega(a_ * Z.d() + b_ * Z.c() + c_ * Z.b() + d_ * Z.a(),
-                      -a_ * Z.a() + b_ * Z.d() + c_ * Z.c() + d_ * Z.b(),
-                      -a_ * Z.b() - b_ * Z.a() + c_ * Z.d() + d_ * Z.c(),
-                      -a_ * Z.c() - b_ * Z.b() - c_ * Z.a() + d_ * Z.d());
+    ZOmegaT operator*(const ZOmegaT& Z) const {
+        return ZOmegaT(a_ * Z.d() + b_ * Z.c() + c_ * Z.b() + d_ * Z.a(),
+                       -a_ * Z.a() + b_ * Z.d() + c_ * Z.c() + d_ * Z.b(),
+                       -a_ * Z.b() - b_ * Z.a() + c_ * Z.d() + d_ * Z.c(),
+                       -a_ * Z.c() - b_ * Z.b() - c_ * Z.a() + d_ * Z.d());
     }
 
     // Assignment and compound assignment operators
     // ===========================================
-    ZOmega& operator+=(const ZOmega& Z) {
-        a_ += Z.a();
-        b_ += Z.b();
-        c_ += Z.c();
-        d_ += Z.d();
+    ZOmegaT& operator+=(const ZOmegaT& Z) { return *this = *this + Z; }
 
-        ZSqrt2 shift(0, gmpf::gmp_round(w_.real()) != 0 && Z.w());
+    ZOmegaT& operator-=(const ZOmegaT& Z) { return *this = *this - Z; }
 
-        alpha_ += Z.alpha() + shift;
-        beta_ += Z.beta() + shift;
-
-        return *this;
-    }
-
-    ZOmega& operator-=(const ZOmega& Z) {
-        using namespace std;
-        a_ -= Z.a();
-        b_ -= Z.b();
-        c_ -= Z.c();
-        d_ -= Z.d();
-
-        ZSqrt2 shift(0, gmpf::gmp_round(w_.real()) != 0 && Z.w());
-
-        alpha_ -= Z.alpha() + shift;
-        beta_ -= Z.beta() + shift;
-
-        return *this;
-    }
-
-    /*
-     * TODO This isn't working correctly
-     */
-    // ZOmega& operator*=(const ZOmega& Z)
-    //{
-    //   using namespace std;
-    //   a_ = a_*Z.d() + b_*Z.c() + c_*Z.b() + d_*Z.a();
-    //   b_ = -a_*Z.a() + b_*Z.d() + c_*Z.c() + d_*Z.b();
-    //   c_ = -a_*Z.b() - b_*Z.a() + c_*Z.d() + d_*Z.c();
-    //   d_ = -a_*Z.c() - b_*Z.b() - c_*Z.a() + d_*Z.d();
-    //
-    //   ZSqrt2 shift(0, gmpf::gmp_round(w_.real()) != 0 && Z.w());
-
-    //  alpha_ *= Z.alpha() + shift;
-    //  beta_ *= Z.beta() + shift;
-
-    //  decimal_ = alpha_.decimal() + beta_.decimal()*Im + w_*OMEGA;
-    //
-    //  return *this;
-    //}
+    ZOmegaT& operator*=(const ZOmegaT& Z) { return *this = *this * Z; }
 
     /*
      * Prints the decimal value along with the standard representation,
@@ -481,60 +466,68 @@ class ZOmega {
                   << std::endl;
     }
 
-    str_t csv_str() {
+    str_t csv_str() const {
         using namespace std;
         stringstream ss;
         ss << a_ << "," << b_ << "," << c_ << "," << d_;
         return ss.str();
     }
 
-}; // class ZOmega
+    // Non-member operator overrides
+    // =============================
+    friend std::ostream& operator<<(std::ostream& os, const ZOmegaT& Z) {
+        os << "(" << Z.a() << "," << Z.b() << "," << Z.c() << "," << Z.d()
+           << ")";
+        return os;
+    }
 
-inline std::ostream& operator<<(std::ostream& os, const ZOmega& Z) {
-    os << "(" << Z.a() << "," << Z.b() << "," << Z.c() << "," << Z.d() << ")";
-    return os;
-}
+    friend ZOmegaT operator*(const ZOmegaT Z, const Int& x) {
+        return ZOmegaT(Z.a() * x, Z.b() * x, Z.c() * x, Z.d() * x);
+    }
 
-inline ZOmega operator*(const ZOmega Z, const int_t& x) {
-    return ZOmega(Z.a() * x, Z.b() * x, Z.c() * x, Z.d() * x);
-}
+    friend ZOmegaT operator*(const Int& x, const ZOmegaT& Z) {
+        return ZOmegaT(Z.a() * x, Z.b() * x, Z.c() * x, Z.d() * x);
+    }
 
-inline ZOmega operator*(const int_t& x, const ZOmega& Z) {
-    return ZOmega(Z.a() * x, Z.b() * x, Z.c() * x, Z.d() * x);
-}
+    friend bool operator==(const ZOmegaT& Y, const ZOmegaT& Z) {
+        return (Y.a() == Z.a()) && (Y.b() == Z.b()) && (Y.c() == Z.c()) &&
+               (Y.d() == Z.d());
+    }
 
-inline bool operator==(const ZOmega& Y, const ZOmega& Z) {
-    return (Y.a() == Z.a()) && (Y.b() == Z.b()) && (Y.c() == Z.c()) &&
-           (Y.d() == Z.d());
-}
+    friend bool operator!=(const ZOmegaT& Y, const ZOmegaT& Z) {
+        return !(Y == Z);
+    }
 
-inline bool operator!=(const ZOmega& Y, const ZOmega& Z) { return !(Y == Z); }
+    /*
+     * Implements euclidean division on ZOmega
+     */
+    friend ZOmegaT operator/(const ZOmegaT& Y, const ZOmegaT& Z) {
+        using namespace std;
+        ZOmegaT n = (Y * Z.conj()) * ((Z * Z.conj()).dot());
+        real_t mag = Z.norm().norm();
+        return ZOmegaT(int_t(floor(real_t(n.a()) / mag)),
+                       int_t(floor(real_t(n.b()) / mag)),
+                       int_t(floor(real_t(n.c()) / mag)),
+                       int_t(floor(real_t(n.d()) / mag)));
+    }
 
-/*
- * Implements euclidean division on ZOmega
- */
-inline ZOmega operator/(const ZOmega& Y, const ZOmega& Z) {
-    using namespace std;
-    ZOmega n = (Y * Z.conj()) * ((Z * Z.conj()).dot());
-    real_t mag = Z.norm().norm();
-    return ZOmega(
-        int_t(floor(real_t(n.a()) / mag)), int_t(floor(real_t(n.b()) / mag)),
-        int_t(floor(real_t(n.c()) / mag)), int_t(floor(real_t(n.d()) / mag)));
-}
+    friend ZOmegaT operator%(const ZOmegaT& Y, const ZOmegaT& Z) {
+        // return Y - (Y/Z)*Z;
+        ZOmegaT n = (Y * Z.conj()) * ((Z * Z.conj()).dot());
+        int_t k = Z.norm().norm();
+        real_t a1 = floor(real_t(n.a() + int_t(k / 2)) / k);
+        real_t a2 = floor(real_t(n.b() + int_t(k / 2)) / k);
+        real_t a3 = floor(real_t(n.c() + int_t(k / 2)) / k);
+        real_t a4 = floor(real_t(n.d() + int_t(k / 2)) / k);
 
-inline ZOmega operator%(const ZOmega& Y, const ZOmega& Z) {
-    // return Y - (Y/Z)*Z;
-    ZOmega n = (Y * Z.conj()) * ((Z * Z.conj()).dot());
-    int_t k = Z.norm().norm();
-    real_t a1 = floor(real_t(n.a() + int_t(k / 2)) / k);
-    real_t a2 = floor(real_t(n.b() + int_t(k / 2)) / k);
-    real_t a3 = floor(real_t(n.c() + int_t(k / 2)) / k);
-    real_t a4 = floor(real_t(n.d() + int_t(k / 2)) / k);
+        ZOmegaT q((int_t(a1)), (int_t(a2)), (int_t(a3)), (int_t(a4)));
 
-    ZOmega q((int_t(a1)), (int_t(a2)), (int_t(a3)), (int_t(a4)));
+        return q * Z - Y;
+    }
 
-    return q * Z - Y;
-}
+}; // class ZOmegaT
+
+using ZOmega = ZOmegaT<int_t>;
 
 // Containers for rings
 using zsqrt2_vec_t = std::vector<ZSqrt2>;
@@ -546,12 +539,10 @@ using zomega_pair_t = std::array<ZOmega, 2>;
 const ZSqrt2 LAMBDA(1, 1);
 const ZSqrt2 LAMBDA_INV(-1, 1);
 
-const std::array<ZOmega, 8> w_pow_arr{
-    {ZOmega(0, 0, 0, 1), ZOmega(0, 0, 1, 0), ZOmega(0, 1, 0, 0),
-     ZOmega(1, 0, 0, 0), ZOmega(0, 0, 0, -1), ZOmega(0, 0, -1, 0),
-     ZOmega(0, -1, 0, 0), ZOmega(-1, 0, 0, 0)}};
-
-inline ZOmega w_pow(const int l) { return w_pow_arr[(8 + l) % 8]; }
+template <typename Int = int_t>
+inline ZOmegaT<Int> w_pow(const int l) {
+    return ZOmegaT<Int>(1).mul_w_pow(l);
+}
 
 } // namespace grid_synth
 } // namespace staq
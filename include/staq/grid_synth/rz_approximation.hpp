@@ -27,9 +27,15 @@
 #ifndef GRID_SYNTH_RZ_APPROXIMATION_HPP_
 #define GRID_SYNTH_RZ_APPROXIMATION_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include <gmpxx.h>
 
@@ -151,28 +157,217 @@ inline RzApproximation find_rz_approximation(const real_t& theta,
     return RzApproximation();
 }
 
-inline RzApproximation find_fast_rz_approximation(const real_t& theta,
-                                                  const real_t& eps,
-                                                  const int_t& kmin = KMIN,
-                                                  const int_t& kmax = KMAX,
-                                                  const real_t tol = TOL) {
+/*
+ * Tries to complete the scaled candidate u / sqrt(2)^k to a unitary, provided
+ * u lies in the epsilon region around e^(i theta). Stores the approximation in
+ * answer and returns true on success.
+ */
+inline bool try_rz_candidate(RzApproximation& answer, ZOmega candidate,
+                             const int_t& k, const real_t& scale,
+                             const vec_t& z, const real_t& theta,
+                             const real_t& eps) {
+    cplx_t value = candidate.decimal();
+    if (((value.real() / scale) * z[0] + (value.imag() / scale) * z[1]) <=
+        real_t("1") - (eps * eps / real_t("2"))) {
+        return false;
+    }
+
+    int_t temp_k = k;
+    while (candidate.is_reducible()) {
+        temp_k -= 1;
+        candidate = candidate.reduce();
+    }
+
+    ZSqrt2 xi = ZSqrt2(int_t(gmpf::pow(2, temp_k)), 0) -
+                (candidate.conj() * candidate).to_zsqrt2();
+    ZOmega t(0);
+    if (!diophantine_solver(t, xi)) {
+        return false;
+    }
+
+    answer = RzApproximation(candidate, t, temp_k, theta, eps);
+    return true;
+}
+
+/*
+ * Seed for the Diophantine attempt on the i-th candidate of scale exponent k,
+ * so that the outcome of each attempt does not depend on which thread runs it
+ * or on what ran before it.
+ */
+inline unsigned long candidate_seed(unsigned long base, const int_t& k,
+                                    std::size_t i) {
+    unsigned long x = base ^ (k.get_ui() * 0x9e3779b97f4a7c15UL) ^
+                      (static_cast<unsigned long>(i) * 0xbf58476d1ce4e5b9UL);
+    x ^= x >> 31;
+    x *= 0x94d049bb133111ebUL;
+    return x ^ (x >> 29);
+}
+
+/*
+ * Searches the candidates for scale exponent k, being the products
+ * alpha_solns x beta_solns followed by shifted_alpha_solns x
+ * shifted_beta_solns, in that order. Candidates are split across threads, and
+ * once a solution is found no thread starts on a candidate past it. The
+ * solution with the lowest index is returned, whatever the number of threads.
+ */
+inline bool search_rz_candidates(
+    RzApproximation& answer, const zsqrt2_vec_t& alpha_solns,
+    const zsqrt2_vec_t& beta_solns, const zsqrt2_vec_t& shifted_alpha_solns,
+    const zsqrt2_vec_t& shifted_beta_solns, const SpecialGridOperator& G,
+    const int_t& k, const real_t& scale, const vec_t& z, const real_t& theta,
+    const real_t& eps, unsigned long seed, int threads) {
+    const std::size_t num_unshifted = alpha_solns.size() * beta_solns.size();
+    const std::size_t num_candidates =
+        num_unshifted + shifted_alpha_solns.size() * shifted_beta_solns.size();
+
+    auto candidate = [&](std::size_t i) {
+        if (i < num_unshifted) {
+            return G * ZOmega(alpha_solns[i / beta_solns.size()],
+                              beta_solns[i % beta_solns.size()], 0);
+        }
+        i -= num_unshifted;
+        return G * ZOmega(shifted_alpha_solns[i / shifted_beta_solns.size()],
+                          shifted_beta_solns[i % shifted_beta_solns.size()], 1);
+    };
+
+    if (threads <= 1 || num_candidates <= 1) {
+        for (std::size_t i = 0; i < num_candidates; i++) {
+            random_numbers.seed(candidate_seed(seed, k, i));
+            if (try_rz_candidate(answer, candidate(i), k, scale, z, theta,
+                                 eps)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Indices are claimed in increasing order, so every index below the best
+    // solution found so far is guaranteed to be tried
+    std::atomic<std::size_t> next(0);
+    std::atomic<std::size_t> best(num_candidates);
+    std::vector<RzApproximation> solutions(num_candidates);
+
+    auto work = [&]() {
+        for (std::size_t i = next++; i < best.load(); i = next++) {
+            random_numbers.seed(candidate_seed(seed, k, i));
+            if (try_rz_candidate(solutions[i], candidate(i), k, scale, z, theta,
+                                 eps)) {
+                std::size_t current = best.load();
+                while (i < current && !best.compare_exchange_weak(current, i)) {
+                }
+                return;
+            }
+        }
+    };
+
+    std::size_t num_threads =
+        std::min(static_cast<std::size_t>(threads), num_candidates);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < num_threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (best.load() == num_candidates) {
+        return false;
+    }
+    answer = solutions[best.load()];
+    return true;
+}
+
+/*
+ * Cache of skew reductions for the epsilon regions of nearby angles. The
+ * region around theta is reduced in two steps: first the region around the
+ * centre of theta's bucket, a multiple of 2^16 eps, and then whatever skew
+ * is left by the difference. Only the first step is cached, so the result
+ * does not depend on what was synthesized before, and angles sharing a bucket
+ * skip most of the reduction. Holds the SKEW_CACHE_SIZE most recently used
+ * buckets and may be used from several threads.
+ */
+class SkewCache {
+  public:
+    SpecialGridOperator optimize_skew(state_t& state, const real_t& theta,
+                                      const real_t& eps) {
+        real_t width = eps;
+        mpf_mul_2exp(width.get_mpf_t(), eps.get_mpf_t(), 16);
+        int_t bucket = gmpf::gmp_floor(real_t(theta / width + real_t("0.5")));
+
+        SpecialGridOperator G = find(bucket, eps, real_t(bucket * width));
+        state = G * state;
+        return G * grid_synth::optimize_skew(state);
+    }
+
+  private:
+    struct Entry {
+        int_t bucket;
+        real_t eps;
+        SpecialGridOperator G;
+    };
+
+    std::mutex mutex_;
+    std::list<Entry> entries_; // Most recently used first
+
+    SpecialGridOperator find(const int_t& bucket, const real_t& eps,
+                             const real_t& centre) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+                if (it->bucket == bucket && it->eps == eps) {
+                    entries_.splice(entries_.begin(), entries_, it);
+                    return it->G;
+                }
+            }
+        }
+
+        state_t state{Ellipse(centre, eps),
+                      Ellipse(real_t("0"), real_t("0"), real_t("1"),
+                              real_t("1"), real_t("0"))};
+        SpecialGridOperator G = grid_synth::optimize_skew(state);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_front(Entry{bucket, eps, G});
+        while (entries_.size() > static_cast<std::size_t>(SKEW_CACHE_SIZE)) {
+            entries_.pop_back();
+        }
+        return G;
+    }
+};
+
+inline SkewCache& skew_cache() {
+    static SkewCache cache;
+    return cache;
+}
+
+inline RzApproximation
+find_fast_rz_approximation(const real_t& theta, const real_t& eps,
+                           const int_t& kmin = KMIN, const int_t& kmax = KMAX,
+                           const real_t tol = TOL,
+                           int threads = RZ_SEARCH_THREADS) {
     // int_t k = 3 * int_t(log(real_t(1) / eps) / log(2)) / 2;
     int_t k = kmin;
     int_t max_k = kmax;
-    bool solution_found = false;
-    zomega_vec_t scaled_candidates;
     vec_t z{gmpf::cos(theta), gmpf::sin(theta)};
     Ellipse eps_region(theta, eps);
     Ellipse disk(real_t("0"), real_t("0"), real_t("1"), real_t("1"),
                  real_t("0"));
     state_t state{eps_region, disk};
-    SpecialGridOperator G = optimize_skew(state);
+    SpecialGridOperator G = SKEW_CACHE_SIZE > 0
+                                ? skew_cache().optimize_skew(state, theta, eps)
+                                : optimize_skew(state);
     real_t scaleA, scaleB;
 
     UprightRectangle<real_t> bboxA = state[0].bounding_box();
     UprightRectangle<real_t> bboxB = state[1].bounding_box();
 
-    while ((!solution_found) && (k < max_k)) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    unsigned long seed = int_t(random_numbers.get_z_bits(64)).get_ui();
+
+    while (k < max_k) {
         if (k % 2 == 0) {
             scaleA = gmpf::pow(2, k / 2);
             scaleB = gmpf::pow(2, k / 2);
@@ -190,62 +385,18 @@ inline RzApproximation find_fast_rz_approximation(const real_t& theta,
         Interval<real_t> A_y = bboxA.y_interval().fatten(eps);
         Interval<real_t> B_y = bboxB.y_interval().fatten(eps);
 
-        real_t min_width = (1 + SQRT2) * (1 + SQRT2);
-
         zsqrt2_vec_t alpha_solns = oneD_optimal_grid_solver(A_x, B_x, tol);
         zsqrt2_vec_t beta_solns = oneD_optimal_grid_solver(A_y, B_y, tol);
-
-        for (auto alpha_soln : alpha_solns) {
-            for (auto beta_soln : beta_solns) {
-                ZOmega candidate = G * ZOmega(alpha_soln, beta_soln, 0);
-                if (((candidate.real() / scaleA) * z[0] +
-                     (candidate.imag() / scaleA) * z[1]) >
-                    real_t("1") - (eps * eps / real_t("2"))) {
-                    int_t temp_k = k;
-                    while (candidate.is_reducible()) {
-                        temp_k -= 1;
-                        candidate = candidate.reduce();
-                    }
-
-                    ZSqrt2 xi = ZSqrt2(int_t(gmpf::pow(2, temp_k)), 0) -
-                                (candidate.conj() * candidate).to_zsqrt2();
-                    ZOmega answer(0);
-                    solution_found = diophantine_solver(answer, xi);
-                    if (solution_found) {
-                        return RzApproximation(candidate, answer, temp_k, theta,
-                                               eps);
-                    }
-                }
-            }
-        }
-
         zsqrt2_vec_t shifted_alpha_solns =
             oneD_optimal_grid_solver(A_x - INV_SQRT2, B_x + INV_SQRT2, tol);
         zsqrt2_vec_t shifted_beta_solns =
             oneD_optimal_grid_solver(A_y - INV_SQRT2, B_y + INV_SQRT2, tol);
 
-        for (auto alpha_soln : shifted_alpha_solns) {
-            for (auto beta_soln : shifted_beta_solns) {
-                ZOmega candidate = G * ZOmega(alpha_soln, beta_soln, 1);
-                if (((candidate.real() / scaleA) * z[0] +
-                     (candidate.imag() / scaleA) * z[1]) >
-                    real_t("1") - (eps * eps / real_t("2"))) {
-                    int_t temp_k = k;
-                    while (candidate.is_reducible()) {
-                        temp_k -= 1;
-                        candidate = candidate.reduce();
-                    }
-
-                    ZSqrt2 xi = ZSqrt2(int_t(gmpf::pow(2, temp_k)), 0) -
-                                (candidate.conj() * candidate).to_zsqrt2();
-                    ZOmega answer(0);
-                    solution_found = diophantine_solver(answer, xi);
-                    if (solution_found) {
-                        return RzApproximation(candidate, answer, temp_k, theta,
-                                               eps);
-                    }
-                }
-            }
+        RzApproximation answer;
+        if (search_rz_candidates(answer, alpha_solns, beta_solns,
+                                 shifted_alpha_solns, shifted_beta_solns, G, k,
+                                 scaleA, z, theta, eps, seed, threads)) {
+            return answer;
         }
 
         k++;
@@ -29,6 +29,8 @@
 
 #include <algorithm>
 #include <cmath>
+#include <optional>
+#include <type_traits>
 
 #include <gmpxx.h>
 
@@ -40,156 +42,201 @@
 namespace staq {
 namespace grid_synth {
 
-using state_t = std::array<Ellipse, 2>;
+template <typename Real>
+using state_type = std::array<EllipseT<Real>, 2>;
+using state_t = state_type<real_t>;
 
-inline state_t operator*(const GridOperator& G, const state_t& state) {
-    return state_t{G * state[0], G.dot() * state[1]};
+template <typename Real>
+inline state_type<Real> operator*(const GridOperator& G,
+                                  const state_type<Real>& state) {
+    return state_type<Real>{G * state[0], G.dot() * state[1]};
 }
 
-inline real_t skew(const state_t state) {
+template <typename Real>
+inline Real skew(const state_type<Real>& state) {
     return state[0].D(0, 1) * state[0].D(0, 1) +
            state[1].D(0, 1) * state[1].D(0, 1);
 }
 
-inline real_t bias(const state_t state) { return state[1].z() - state[0].z(); }
+template <typename Real>
+inline Real bias(const state_type<Real>& state) {
+    return state[1].z() - state[0].z();
+}
 
-inline int_t determine_shift(const state_t state) {
-    return int_t(floor((1 - bias(state)) / 2));
+template <typename Real>
+inline int_t determine_shift(const state_type<Real>& state) {
+    using namespace std;
+    return gmpf::gmp_floor(Real((1 - bias(state)) / 2));
 }
 
-inline mat_t sigma(int_t k) {
+template <typename Real = real_t>
+inline mat2_t<Real> sigma(int_t k) {
+    const Real lambda = RealConstants<Real>::lambda();
+    const Real& sqrt_lambda_inv = RealConstants<Real>::sqrt_lambda_inv();
     if (k < 0) {
-        return gmpf::pow(SQRT_LAMBDA_INV, -k) *
-               mat_t{1, 0, 0, gmpf::pow(LAMBDA.decimal(), -k)};
+        return gmpf::pow(sqrt_lambda_inv, -k) *
+               mat2_t<Real>{1, 0, 0, gmpf::pow(lambda, -k)};
     }
 
-    return gmpf::pow(SQRT_LAMBDA_INV, k) *
-           mat_t{gmpf::pow(LAMBDA.decimal(), k), 0, 0, 1};
+    return gmpf::pow(sqrt_lambda_inv, k) *
+           mat2_t<Real>{gmpf::pow(lambda, k), 0, 0, 1};
 }
 
-inline mat_t tau(int_t k) {
+template <typename Real = real_t>
+inline mat2_t<Real> tau(int_t k) {
+    const Real lambda = RealConstants<Real>::lambda();
+    const Real& sqrt_lambda_inv = RealConstants<Real>::sqrt_lambda_inv();
     if (k < 0) {
-        return gmpf::pow(SQRT_LAMBDA_INV, -k) *
-               mat_t{gmpf::pow(LAMBDA.decimal(), -k), 0, 0, gmpf::pow(-1, -k)};
+        return gmpf::pow(sqrt_lambda_inv, -k) *
+               mat2_t<Real>{gmpf::pow(lambda, -k), 0, 0,
+                            gmpf::pow(Real(-1), -k)};
     }
 
-    return gmpf::pow(SQRT_LAMBDA_INV, k) *
-           mat_t{1, 0, 0, gmpf::pow(-LAMBDA.decimal(), k)};
+    return gmpf::pow(sqrt_lambda_inv, k) *
+           mat2_t<Real>{1, 0, 0, gmpf::pow(Real(-lambda), k)};
 }
 
 /*
  *  Act on the state (A,B) with $k$ copies of the shift operators SIGMA and TAU
  *  and the return the shifted state.
  */
-inline state_t shift(const state_t& state, const int_t& k) {
-    return state_t{sigma(k) * state[0], tau(k) * state[1]};
+template <typename Real>
+inline state_type<Real> shift(const state_type<Real>& state, const int_t& k) {
+    return state_type<Real>{sigma<Real>(k) * state[0], tau<Real>(k) * state[1]};
 }
 
 /*
- * Reduces skew(state) by 10% and returns the operator that did it.
+ * Reduces skew(state) by 10% and returns the operator that did it. With
+ * real_t coordinates this exits if that fails. With floating point
+ * coordinates, rounding errors may make it fail, and it returns std::nullopt
+ * instead, leaving state unspecified.
  */
-inline SpecialGridOperator reduce_skew(state_t& state) {
-    real_t initial_skew = skew(state);
+template <typename Real>
+inline std::optional<SpecialGridOperator>
+try_reduce_skew(state_type<Real>& state) {
+    using namespace std;
+    constexpr bool exact = std::is_same<Real, real_t>::value;
+    const Real lambda = RealConstants<Real>::lambda();
+
+    Real initial_skew = skew(state);
     if (initial_skew < 15) {
         return ID;
     }
 
     int_t k = 0;
-    if (abs(bias(state)) > real_t("1")) {
+    if (gmpf::gmp_abs(bias(state)) > Real(1)) {
         k = determine_shift(state);
         state = shift(state, k);
     }
     SpecialGridOperator G = ID;
 
-    if ((state[1].z() + state[0].z()) < real_t("0")) {
+    if ((state[1].z() + state[0].z()) < Real(0)) {
         G = G * X;
         state = X * state;
         // std::cout << "X" << std::endl;
     }
 
-    if (state[1].D(0, 1) < real_t("0")) {
+    if (state[1].D(0, 1) < Real(0)) {
         G = G * Z;
         state = Z * state;
         // std::cout << "Y" << std::endl;
     }
 
-    real_t z = state[0].z();
-    real_t zeta = state[1].z();
+    Real z = state[0].z();
+    Real zeta = state[1].z();
 
-    if (static_cast<bool>(gmpf::gmp_geq(state[0].D(0, 1), real_t("0")))) {
-        if (gmpf::gmp_geq(z, real_t("-0.8")) &&
-            gmpf::gmp_leq(z, real_t("0.8")) &&
-            gmpf::gmp_geq(zeta, real_t("-0.8")) &&
-            gmpf::gmp_leq(zeta, real_t("0.8"))) {
+    // Number of times A or B is applied, at least one
+    auto power = [&lambda](const Real& c) {
+        unsigned long e;
+        if constexpr (exact) {
+            e = c.get_ui();
+        } else {
+            e = static_cast<unsigned long>(c);
+        }
+        return gmpf::gmp_max(
+            1, int_t(gmpf::gmp_floor(Real(gmpf::pow(lambda, e) / 2))));
+    };
+
+    if (static_cast<bool>(gmpf::gmp_geq(state[0].D(0, 1), Real(0)))) {
+        if (gmpf::gmp_geq(z, Real(-0.8)) && gmpf::gmp_leq(z, Real(0.8)) &&
+            gmpf::gmp_geq(zeta, Real(-0.8)) && gmpf::gmp_leq(zeta, Real(0.8))) {
             G = G * R;
             state = R * state;
             // std::cout << "R" << std::endl;
-        } else if (gmpf::gmp_leq(z, real_t("0.3")) &&
-                   gmpf::gmp_geq(zeta, real_t("0.8"))) {
+        } else if (gmpf::gmp_leq(z, Real(0.3)) &&
+                   gmpf::gmp_geq(zeta, Real(0.8))) {
             G = G * K;
             state = K * state;
             // std::cout << "K" << std::endl;
-        } else if (gmpf::gmp_geq(z, real_t("0.3")) &&
-                   gmpf::gmp_geq(zeta, real_t("0.3"))) {
-            real_t c = gmpf::gmp_min(z, zeta);
-            int_t n = gmpf::gmp_max(
-                1, int_t(gmpf::gmp_floor(
-                       gmpf::pow(LAMBDA.decimal(), c.get_ui()) / 2)));
+        } else if (gmpf::gmp_geq(z, Real(0.3)) &&
+                   gmpf::gmp_geq(zeta, Real(0.3))) {
+            int_t n = power(gmpf::gmp_min(z, zeta));
             G = G * A(n);
             state = A(n) * state;
             // std::cout << "A^" << n << std::endl;
-        } else if (gmpf::gmp_geq(z, real_t("0.8")) &&
-                   gmpf::gmp_leq(zeta, real_t("0.3"))) {
+        } else if (gmpf::gmp_geq(z, Real(0.8)) &&
+                   gmpf::gmp_leq(zeta, Real(0.3))) {
             G = G * K.dot();
             state = K.dot() * state;
             // std::cout << "K.dot()" << std::endl;
         } else {
-            std::cout << "reduce skew did not find any valid cases with the "
-                         "ellipses: "
-                      << std::endl
-                      << state[0] << std::endl
-                      << "======" << std::endl
-                      << state[1] << std::endl;
-            exit(EXIT_FAILURE);
+            if constexpr (exact) {
+                std::cout << "reduce skew did not find any valid cases with "
+                             "the ellipses: "
+                          << std::endl
+                          << state[0] << std::endl
+                          << "======" << std::endl
+                          << state[1] << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            return std::nullopt;
         }
     } else {
-        if (gmpf::gmp_geq(z, real_t("-0.8")) &&
-            gmpf::gmp_leq(z, real_t("0.8")) &&
-            gmpf::gmp_geq(zeta, real_t("-0.8")) &&
-            gmpf::gmp_leq(zeta, real_t("0.8"))) {
+        if (gmpf::gmp_geq(z, Real(-0.8)) && gmpf::gmp_leq(z, Real(0.8)) &&
+            gmpf::gmp_geq(zeta, Real(-0.8)) && gmpf::gmp_leq(zeta, Real(0.8))) {
             G = G * R;
             state = R * state;
             // std::cout << "R" << std::endl;
-        } else if (gmpf::gmp_geq(z, real_t("-0.2")) &&
-                   gmpf::gmp_geq(zeta, real_t("-0.2"))) {
-            real_t c = gmpf::gmp_min(z, zeta);
-            int_t n = gmpf::gmp_max(
-                1, int_t(gmpf::gmp_floor(
-                       gmpf::pow(LAMBDA.decimal(), c.get_ui()) / 2)));
+        } else if (gmpf::gmp_geq(z, Real(-0.2)) &&
+                   gmpf::gmp_geq(zeta, Real(-0.2))) {
+            int_t n = power(gmpf::gmp_min(z, zeta));
             G = G * B(n);
             state = B(n) * state;
             // std::cout << "B^" << n << std::endl;
         } else {
-            std::cout << "reduce skew did not find any valid cases with the "
-                         "ellipses: "
-                      << std::endl
-                      << state[0] << std::endl
-                      << "======" << std::endl
-                      << state[1] << std::endl;
-            exit(EXIT_FAILURE);
+            if constexpr (exact) {
+                std::cout << "reduce skew did not find any valid cases with "
+                             "the ellipses: "
+                          << std::endl
+                          << state[0] << std::endl
+                          << "======" << std::endl
+                          << state[1] << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            return std::nullopt;
         }
     }
     state = shift(state, k);
 
-    if (skew(state) > real_t("0.9") * initial_skew) {
-        std::cout << "reduce_skew failed to reduce the skew by at least 10%. "
-                     "Exiting.";
-        exit(EXIT_FAILURE);
+    if (skew(state) > Real(0.9) * initial_skew) {
+        if constexpr (exact) {
+            std::cout << "reduce_skew failed to reduce the skew by at least "
+                         "10%. Exiting.";
+            exit(EXIT_FAILURE);
+        }
+        return std::nullopt;
     }
 
     return shift(G, k);
 }
 
+/*
+ * Reduces skew(state) by 10% and returns the operator that did it.
+ */
+inline SpecialGridOperator reduce_skew(state_t& state) {
+    return *try_reduce_skew(state);
+}
+
 /*
  * Accepts a state with arbitrary normalization and returns a state with the
  * original normalization but with the skew reduced to its lowest possible value
@@ -199,6 +246,34 @@ inline SpecialGridOperator optimize_skew(state_t& state) {
     real_t scaleB = state[1].normalize();
     SpecialGridOperator G = ID;
 
+    // Most of the work is done in double precision. Each pass reduces the skew
+    // until rounding errors catch up, and its operator is then applied to the
+    // state exactly, giving a less skewed state for the next pass to start
+    // from. Whatever the passes leave undone is finished at full precision.
+    while (skew(state) >= 15 &&
+           gmpf::gmp_abs(state[0].D(0, 1)) < FLOAT_SKEW_MAX_ENTRY &&
+           gmpf::gmp_abs(state[1].D(0, 1)) < FLOAT_SKEW_MAX_ENTRY) {
+        state_type<double> fast{EllipseT<double>::from(state[0]),
+                                EllipseT<double>::from(state[1])};
+        SpecialGridOperator fast_G = ID;
+        while (skew(fast) >= 15) {
+            std::optional<SpecialGridOperator> step = try_reduce_skew(fast);
+            if (!step) {
+                break;
+            }
+            fast_G = fast_G * *step;
+        }
+        if (fast_G == ID) {
+            break;
+        }
+        state_t reduced = fast_G * state;
+        if (!(skew(reduced) < skew(state))) {
+            break;
+        }
+        G = G * fast_G;
+        state = reduced;
+    }
+
     while (skew(state) >= 15) {
         G = G * reduce_skew(state);
     }
@@ -0,0 +1,241 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file mapping/auto.hpp
+ * \brief Automatic selection of layout & mapping algorithms
+ */
+
+#ifndef MAPPING_AUTO_HPP_
+#define MAPPING_AUTO_HPP_
+
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "qasmtools/ast/traversal.hpp"
+
+#include "staq/mapping/device.hpp"
+#include "staq/mapping/layout/basic.hpp"
+#include "staq/mapping/layout/bestfit.hpp"
+#include "staq/mapping/layout/eager.hpp"
+#include "staq/mapping/mapping/steiner.hpp"
+#include "staq/mapping/mapping/swap.hpp"
+
+namespace staq {
+namespace mapping {
+
+namespace ast = qasmtools::ast;
+
+/** \brief Metrics for comparing mapped circuits */
+enum class MappingScore { cnots, fidelity };
+
+/**
+ * \class staq::mapping::MappingScorer
+ * \brief Scores a mapped circuit, lower being better
+ *
+ * Either counts CNOT gates, or sums the negative log fidelities of each gate
+ * on the device. Assumes the circuit has been mapped onto the device.
+ */
+class MappingScorer final : public ast::Traverse {
+  public:
+    MappingScorer(Device& device, MappingScore score)
+        : Traverse(), device_(device), score_(score) {}
+
+    double run(ast::Program& prog) {
+        cost_ = 0;
+        prog.accept(*this);
+        return cost_;
+    }
+
+    // Ignore declarations if they were left in during inlining
+    void visit(ast::GateDecl&) override {}
+    void visit(ast::OracleDecl&) override {}
+
+    void visit(ast::UGate& gate) override { add_sq(gate.arg()); }
+    void visit(ast::CNOTGate& gate) override {
+        add_tq(gate.ctrl(), gate.tgt());
+    }
+    void visit(ast::DeclaredGate& gate) override {
+        if (gate.num_qargs() == 1) {
+            add_sq(gate.qarg(0));
+        } else if (gate.num_qargs() == 2) {
+            add_tq(gate.qarg(0), gate.qarg(1));
+        }
+    }
+
+  private:
+    Device& device_;
+    MappingScore score_;
+    double cost_ = 0;
+
+    void add_sq(const ast::VarAccess& q) {
+        if (score_ == MappingScore::fidelity && q.offset()) {
+            cost_ -= std::log(device_.sq_fidelity(*q.offset()));
+        }
+    }
+
+    void add_tq(const ast::VarAccess& ctrl, const ast::VarAccess& tgt) {
+        if (score_ == MappingScore::cnots) {
+            cost_ += 1;
+        } else if (ctrl.offset() && tgt.offset()) {
+            int i = *ctrl.offset();
+            int j = *tgt.offset();
+            if (device_.coupled(i, j)) {
+                cost_ -= std::log(device_.tq_fidelity(i, j));
+            } else if (device_.coupled(j, i)) {
+                cost_ -= std::log(device_.tq_fidelity(j, i));
+            }
+        }
+    }
+};
+
+/** \brief A circuit mapped by one combination of algorithms */
+struct mapping_result {
+    std::string layout_alg;                   ///< Layout algorithm used
+    std::string mapper;                       ///< Mapping algorithm used
+    layout init;                              ///< The initial layout
+    std::optional<std::map<int, int>> output; ///< The output permutation
+    ast::ptr<ast::Program> prog;              ///< The mapped circuit
+    double score;                             ///< Its score, lower is better
+};
+
+/**
+ * \brief Maps a program with a single layout & mapping algorithm
+ * \param device The physical device
+ * \param prog The program, already inlined; modified in place
+ * \param layout_alg One of "linear", "eager" or "bestfit"
+ * \param mapper One of "swap" or "steiner"
+ * \param layout_optimization Whether to optimize the layout for the
+ * steiner mapper
+ * \param deadline An optional deadline for the layout optimization
+ * \return The result, with an empty program
+ */
+inline mapping_result map_with(
+    Device& device, ast::Program& prog, const std::string& layout_alg,
+    const std::string& mapper, bool layout_optimization = true,
+    std::optional<std::chrono::steady_clock::time_point> deadline =
+        std::nullopt) {
+    mapping_result ret{layout_alg, mapper, {}, std::nullopt, nullptr, 0};
+
+    if (layout_alg == "linear") {
+        ret.init = compute_basic_layout(device, prog);
+    } else if (layout_alg == "eager") {
+        ret.init = compute_eager_layout(device, prog);
+    } else if (layout_alg == "bestfit") {
+        ret.init = compute_bestfit_layout(device, prog);
+    } else {
+        throw std::invalid_argument("Unknown layout algorithm " + layout_alg);
+    }
+
+    if (mapper == "steiner" && layout_optimization) {
+        optimize_steiner_layout(device, ret.init, prog, deadline);
+    }
+
+    apply_layout(ret.init, device, prog);
+
+    if (mapper == "swap") {
+        ret.output = map_onto_device(device, prog);
+    } else if (mapper == "steiner") {
+        steiner_mapping(device, prog);
+    } else {
+        throw std::invalid_argument("Unknown mapping algorithm " + mapper);
+    }
+
+    return ret;
+}
+
+/**
+ * \brief Maps a program with every combination of the given algorithms
+ *
+ * Each combination runs concurrently on its own copy of the device and the
+ * program, and the best scoring result is kept. Ties go to the earliest
+ * combination, with layouts varying slowest.
+ *
+ * \param device The physical device
+ * \param prog The program, already inlined
+ * \param layouts The layout algorithms to try
+ * \param mappers The mapping algorithms to try
+ * \param score The metric to rank results by
+ * \param layout_optimization Whether to optimize layouts for the steiner
+ * mapper
+ * \param budget An optional wall-clock budget for layout optimization
+ * \return The best result
+ */
+inline mapping_result
+map_best(Device& device, ast::Program& prog,
+         const std::vector<std::string>& layouts,
+         const std::vector<std::string>& mappers,
+         MappingScore score = MappingScore::cnots,
+         bool layout_optimization = true,
+         std::optional<std::chrono::milliseconds> budget = std::nullopt) {
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (budget) {
+        deadline = std::chrono::steady_clock::now() + *budget;
+    }
+
+    std::vector<std::future<mapping_result>> candidates;
+    for (auto& layout_alg : layouts) {
+        for (auto& mapper : mappers) {
+            // Cloned here, since traversals are not thread-safe
+            auto copy = ast::object::clone(prog);
+            candidates.push_back(std::async(
+                std::launch::async,
+                [device, layout_alg, mapper, score, layout_optimization,
+                 deadline, copy = std::move(copy)]() mutable {
+                    auto ret = map_with(device, *copy, layout_alg, mapper,
+                                        layout_optimization, deadline);
+                    ret.score = MappingScorer(device, score).run(*copy);
+                    ret.prog = std::move(copy);
+                    return ret;
+                }));
+        }
+    }
+
+    std::optional<mapping_result> best;
+    for (auto& candidate : candidates) {
+        auto result = candidate.get();
+        if (!best || result.score < best->score) {
+            best = std::move(result);
+        }
+    }
+
+    if (!best) {
+        throw std::invalid_argument("No mapping algorithms to try");
+    }
+
+    return std::move(*best);
+}
+
+} /* namespace mapping */
+} /* namespace staq */
+
+#endif /* MAPPING_AUTO_HPP_ */
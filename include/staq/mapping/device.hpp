@@ -32,14 +32,19 @@
 #ifndef MAPPING_DEVICE_HPP_
 #define MAPPING_DEVICE_HPP_
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <map>
 #include <optional>
+#include <queue>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -62,6 +67,23 @@ using spanning_tree = std::list<std::pair<int, int>>;
 
 static double FIDELITY_1 = 1 - std::numeric_limits<double>::epsilon();
 
+/**
+ * \brief Largest device for which all-pairs distances are stored
+ *
+ * Larger devices compute shortest paths to a target qubit on demand
+ */
+static constexpr int DENSE_QUBIT_LIMIT = 1024;
+
+/**
+ * \brief Algorithms for approximating minimal Steiner trees
+ *
+ * greedy grows the tree from the root by repeatedly attaching the closest
+ * terminal (Takahashi-Matsuyama), while mehlhorn takes a minimal spanning
+ * tree over the Voronoi regions of the terminals, which is faster on large
+ * devices
+ */
+enum class SteinerAlg { greedy, mehlhorn };
+
 /**
  * \class staq::mapping::Device
  * \brief Class representing physical devices with restricted topologies & gate
@@ -90,9 +112,17 @@ class Device {
      * \param dag A digraph, given as a Boolean adjacency matrix
      */
     Device(std::string name, int n, const std::vector<std::vector<bool>>& dag)
-        : name_(name), qubits_(n), couplings_(dag),
-          single_qubit_fidelities_(n, FIDELITY_1),
-          coupling_fidelities_(n, std::vector<double>(n, FIDELITY_1)) {}
+        : name_(name), qubits_(n), single_qubit_fidelities_(n, FIDELITY_1) {
+        std::vector<std::pair<coupling, double>> edges;
+        for (auto i = 0; i < n; i++) {
+            for (auto j = 0; j < n; j++) {
+                if (dag[i][j]) {
+                    edges.emplace_back(std::make_pair(i, j), FIDELITY_1);
+                }
+            }
+        }
+        build_csr(edges);
+    }
     /**
      * \brief Construct a device from a coupling graph
      * \param name A name for the device
@@ -106,8 +136,35 @@ class Device {
     Device(std::string name, int n, const std::vector<std::vector<bool>>& dag,
            const std::vector<double>& sq_fi,
            const std::vector<std::vector<double>>& tq_fi)
-        : name_(name), qubits_(n), couplings_(dag),
-          single_qubit_fidelities_(sq_fi), coupling_fidelities_(tq_fi) {}
+        : name_(name), qubits_(n), single_qubit_fidelities_(sq_fi) {
+        std::vector<std::pair<coupling, double>> edges;
+        for (auto i = 0; i < n; i++) {
+            for (auto j = 0; j < n; j++) {
+                if (dag[i][j]) {
+                    edges.emplace_back(std::make_pair(i, j), tq_fi[i][j]);
+                }
+            }
+        }
+        build_csr(edges);
+    }
+    /**
+     * \brief Construct a device from a list of couplings
+     *
+     * Avoids the quadratic adjacency & fidelity matrices of the other
+     * constructors, and should be preferred for large devices
+     *
+     * \param name A name for the device
+     * \param n The number of qubits
+     * \param edges A list of distinct (coupling, fidelity) pairs
+     * \param sq_fi A vector of average single-qubit gate fidelities for each
+     * qubit
+     */
+    Device(std::string name, int n,
+           const std::vector<std::pair<coupling, double>>& edges,
+           const std::vector<double>& sq_fi)
+        : name_(name), qubits_(n), single_qubit_fidelities_(sq_fi) {
+        build_csr(edges);
+    }
     /**@}*/
 
     std::string name_;
@@ -121,7 +178,7 @@ class Device {
      */
     bool coupled(int i, int j) {
         if (0 <= i && i < qubits_ && 0 <= j && j < qubits_) {
-            return couplings_[i][j];
+            return find_coupling(i, j) != targets_.size();
         } else {
             throw std::out_of_range("Qubit(s) not in range");
         }
@@ -147,7 +204,7 @@ class Device {
      */
     double tq_fidelity(int i, int j) {
         if (coupled(i, j)) {
-            return coupling_fidelities_[i][j];
+            return coupling_fidelities_[find_coupling(i, j)];
         } else {
             throw std::logic_error("Qubit not coupled");
         }
@@ -163,15 +220,14 @@ class Device {
      * \return A shortest (or highest fidelity) path between qubits i and j
      */
     path shortest_path(int i, int j) {
-        compute_shortest_paths();
         path ret{i};
 
-        if (shortest_paths[i][j] == qubits_) {
+        if (next_hop(i, j) == qubits_) {
             return ret;
         }
 
         while (i != j) {
-            i = shortest_paths[i][j];
+            i = next_hop(i, j);
             ret.push_back(i);
         }
 
@@ -185,15 +241,13 @@ class Device {
      * \return The length of a shortest path between qubits i and j
      */
     int distance(int i, int j) {
-        compute_shortest_paths();
-
-        if (shortest_paths[i][j] == qubits_) {
+        if (next_hop(i, j) == qubits_) {
             return -1;
         }
 
         int ret = 0;
         while (i != j) {
-            i = shortest_paths[i][j];
+            i = next_hop(i, j);
             ++ret;
         }
 
@@ -205,30 +259,66 @@ class Device {
      * \note Couplings are ordered in decreasing fidelity.
      * \return A set of (coupling, fidelity) pairs
      */
-    std::set<std::pair<coupling, double>, cmp_couplings> couplings() {
-        // Sort in order of decreasing coupling fidelity
-        cmp_couplings cmp = [](std::pair<coupling, double> a,
-                               std::pair<coupling, double> b) {
-            if (a.second == b.second) {
-                return a.first < b.first;
-            } else {
-                return a.second > b.second;
-            }
-        };
-
-        std::set<std::pair<coupling, double>, cmp_couplings> ret(cmp);
-        for (auto i = 0; i < qubits_; i++) {
-            for (auto j = 0; j < qubits_; j++) {
-                if (couplings_[i][j]) {
-                    ret.insert(std::make_pair(std::make_pair(i, j),
-                                              coupling_fidelities_[i][j]));
+    const std::set<std::pair<coupling, double>, cmp_couplings>& couplings() {
+        if (!coupling_set_) {
+            // Sort in order of decreasing coupling fidelity
+            cmp_couplings cmp = [](std::pair<coupling, double> a,
+                                   std::pair<coupling, double> b) {
+                if (a.second == b.second) {
+                    return a.first < b.first;
+                } else {
+                    return a.second > b.second;
                 }
-            }
+            };
+
+            auto& list = coupling_list();
+            coupling_set_.emplace(list.begin(), list.end(), cmp);
         }
 
-        return ret;
+        return *coupling_set_;
+    }
+
+    /**
+     * \brief Get an indexed list of all edges in the coupling digraph
+     *
+     * Couplings are ordered in decreasing fidelity, with ties broken by
+     * (control, target), i.e., in the same order as couplings(). The position
+     * of a coupling in the list serves as its identifier in out_couplings()
+     * and in_couplings().
+     *
+     * \return A vector of (coupling, fidelity) pairs
+     */
+    const std::vector<std::pair<coupling, double>>& coupling_list() {
+        compute_coupling_index();
+        return coupling_list_;
+    }
+
+    /**
+     * \brief Get the couplings with a given control qubit
+     * \param i The control qubit
+     * \return Indices into coupling_list(), in decreasing fidelity
+     */
+    const std::vector<std::size_t>& out_couplings(int i) {
+        compute_coupling_index();
+        return out_couplings_[i];
+    }
+
+    /**
+     * \brief Get the couplings with a given target qubit
+     * \param j The target qubit
+     * \return Indices into coupling_list(), in decreasing fidelity
+     */
+    const std::vector<std::size_t>& in_couplings(int j) {
+        compute_coupling_index();
+        return in_couplings_[j];
     }
 
+    /**
+     * \brief Set the algorithm used by steiner()
+     * \param alg The Steiner tree algorithm
+     */
+    void set_steiner_alg(SteinerAlg alg) { steiner_alg_ = alg; }
+
     /**
      * \brief Get an approximation to a minimal Steiner tree
      *
@@ -240,46 +330,56 @@ class Device {
      * \param root A root for the Steiner tree
      * \return A spanning tree represented as a list of edges
      */
-    spanning_tree steiner(std::list<int> terminals, int root) {
-        compute_shortest_paths();
+    spanning_tree steiner(const std::list<int>& terminals, int root) {
+        if (steiner_alg_ == SteinerAlg::mehlhorn) {
+            return mehlhorn_steiner(terminals, root);
+        }
 
         spanning_tree ret;
 
-        // Internal data structures
-        std::vector<double> vertex_cost(qubits_);
-        std::vector<int> edge_in(qubits_);
-        std::set<int> in_tree{root};
-
-        auto min_node = terminals.end();
-        for (auto it = terminals.begin(); it != terminals.end(); it++) {
-            vertex_cost[*it] = dist[root][*it];
-            edge_in[*it] = root;
-            if (min_node == terminals.end() ||
-                (vertex_cost[*it] < vertex_cost[*min_node])) {
-                min_node = it;
-            }
+        // Internal data structures, indexed by position in terminals
+        std::vector<int> term(terminals.begin(), terminals.end());
+        std::vector<double> vertex_cost(term.size());
+        std::vector<int> edge_in(term.size(), root);
+        std::vector<std::size_t> remaining(term.size());
+        std::vector<bool> in_tree(qubits_, false);
+        in_tree[root] = true;
+
+        // Ties are broken by position, as in the order of terminals
+        using entry = std::pair<double, std::size_t>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>>
+            queue;
+        for (std::size_t k = 0; k < term.size(); k++) {
+            vertex_cost[k] = path_cost(root, term[k]);
+            remaining[k] = k;
+            queue.emplace(vertex_cost[k], k);
         }
 
         // Algorithm proper
-        while (min_node != terminals.end()) {
-            auto current = *min_node;
-            terminals.erase(min_node);
+        while (!queue.empty()) {
+            auto [cost, current] = queue.top();
+            queue.pop();
+            if (cost > vertex_cost[current]) {
+                continue;
+            }
+
+            remaining.erase(
+                std::find(remaining.begin(), remaining.end(), current));
             auto new_nodes = add_to_tree(
-                ret, shortest_path(edge_in[current], current), in_tree);
-            in_tree.insert(new_nodes.begin(), new_nodes.end());
+                ret, shortest_path(edge_in[current], term[current]), in_tree);
 
-            // Update costs, edges, and find new minimum edge
-            min_node = terminals.end();
-            for (auto it = terminals.begin(); it != terminals.end(); it++) {
+            // Update costs & edges of the remaining terminals
+            for (auto k : remaining) {
+                bool improved = false;
                 for (auto node : new_nodes) {
-                    if (dist[node][*it] < vertex_cost[*it]) {
-                        vertex_cost[*it] = dist[node][*it];
-                        edge_in[*it] = node;
+                    if (path_cost(node, term[k]) < vertex_cost[k]) {
+                        vertex_cost[k] = path_cost(node, term[k]);
+                        edge_in[k] = node;
+                        improved = true;
                     }
                 }
-                if (min_node == terminals.end() ||
-                    (vertex_cost[*it] < vertex_cost[*min_node])) {
-                    min_node = it;
+                if (improved) {
+                    queue.emplace(vertex_cost[k], k);
                 }
             }
         }
@@ -346,14 +446,15 @@ class Device {
                     ? json{{"id", i}}
                     : json{{"id", i},
                            {"fidelity", single_qubit_fidelities_[i]}});
-            for (int j = 0; j < qubits_; j++) {
-                if (i != j && couplings_[i][j]) {
+            for (auto e = row_offsets_[i]; e < row_offsets_[i + 1]; e++) {
+                int j = targets_[e];
+                if (i != j) {
                     js["couplings"].push_back(
-                        coupling_fidelities_[i][j] == FIDELITY_1
+                        coupling_fidelities_[e] == FIDELITY_1
                             ? json{{"control", i}, {"target", j}}
                             : json{{"control", i},
                                    {"target", j},
-                                   {"fidelity", coupling_fidelities_[i][j]}});
+                                   {"fidelity", coupling_fidelities_[e]}});
                 }
             }
         }
@@ -361,14 +462,19 @@ class Device {
     }
 
   private:
-    std::vector<std::vector<bool>>
-        couplings_; ///< The adjacency matrix of the device topology
+    /** @name Coupling graph, in compressed sparse row format */
+    /**@{*/
+    std::vector<std::size_t>
+        row_offsets_; ///< Offsets of the couplings of each control qubit
+    std::vector<int> targets_; ///< Targets of each coupling, sorted per row
     std::vector<double>
-        single_qubit_fidelities_; ///< The fidelities of single-qubit gates
-    std::vector<std::vector<double>>
         coupling_fidelities_; ///< The fidelities of two-qubit gates
+    /**@}*/
+    std::vector<double>
+        single_qubit_fidelities_; ///< The fidelities of single-qubit gates
 
-    /** @name All-pairs-shortest-paths */
+    /** @name All-pairs-shortest-paths, for devices of at most
+     * DENSE_QUBIT_LIMIT qubits */
     /**@{*/
     std::vector<std::vector<double>>
         dist; ///< Distances returned by Floyd-Warshall
@@ -376,6 +482,205 @@ class Device {
         shortest_paths; ///< Matrix return by Floyd-Warshall
     /**@}*/
 
+    /** @name Single-target shortest paths, for larger devices */
+    /**@{*/
+    std::unordered_map<int, std::vector<double>>
+        dist_to_; ///< Distances to a given target, computed on demand
+    std::unordered_map<int, std::vector<int>>
+        next_hop_to_; ///< Next hops towards a given target
+    std::vector<std::vector<int>>
+        neighbours_; ///< Undirected adjacency lists of the coupling graph
+    /**@}*/
+
+    SteinerAlg steiner_alg_ =
+        SteinerAlg::greedy; ///< The algorithm used by steiner()
+
+    /** @name Coupling index */
+    /**@{*/
+    std::vector<std::pair<coupling, double>>
+        coupling_list_; ///< Couplings in decreasing fidelity
+    std::vector<std::vector<std::size_t>>
+        out_couplings_; ///< Outgoing couplings of each qubit
+    std::vector<std::vector<std::size_t>>
+        in_couplings_; ///< Incoming couplings of each qubit
+    std::optional<std::set<std::pair<coupling, double>, cmp_couplings>>
+        coupling_set_; ///< Cached result of couplings()
+    /**@}*/
+
+    /**
+     * \brief Builds the sorted coupling list and per-qubit adjacency lists
+     * \note Assigns result to coupling_list_, out_couplings_ and in_couplings_
+     */
+    void compute_coupling_index() {
+        if (!out_couplings_.empty() || qubits_ == 0) {
+            return;
+        }
+
+        for (auto i = 0; i < qubits_; i++) {
+            for (auto e = row_offsets_[i]; e < row_offsets_[i + 1]; e++) {
+                coupling_list_.emplace_back(std::make_pair(i, targets_[e]),
+                                            coupling_fidelities_[e]);
+            }
+        }
+        std::stable_sort(coupling_list_.begin(), coupling_list_.end(),
+                         [](const auto& a, const auto& b) {
+                             return a.second > b.second;
+                         });
+
+        out_couplings_.resize(qubits_);
+        in_couplings_.resize(qubits_);
+        for (std::size_t id = 0; id < coupling_list_.size(); id++) {
+            auto [i, j] = coupling_list_[id].first;
+            out_couplings_[i].push_back(id);
+            in_couplings_[j].push_back(id);
+        }
+    }
+
+    /**
+     * \brief Builds the compressed sparse row coupling graph
+     * \param edges A list of distinct (coupling, fidelity) pairs
+     */
+    void build_csr(std::vector<std::pair<coupling, double>> edges) {
+        std::sort(edges.begin(), edges.end());
+
+        row_offsets_.assign(qubits_ + 1, 0);
+        targets_.reserve(edges.size());
+        coupling_fidelities_.reserve(edges.size());
+        for (auto& [c, f] : edges) {
+            row_offsets_[c.first + 1]++;
+            targets_.push_back(c.second);
+            coupling_fidelities_.push_back(f);
+        }
+        for (auto i = 0; i < qubits_; i++) {
+            row_offsets_[i + 1] += row_offsets_[i];
+        }
+    }
+
+    /**
+     * \brief Finds the coupling between two qubits
+     * \param i The control qubit
+     * \param j The target qubit
+     * \return The index of the coupling, or targets_.size() if none exists
+     */
+    std::size_t find_coupling(int i, int j) const {
+        auto first = targets_.begin() + row_offsets_[i];
+        auto last = targets_.begin() + row_offsets_[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        if (it != last && *it == j) {
+            return it - targets_.begin();
+        }
+
+        return targets_.size();
+    }
+
+    /**
+     * \brief The cost of a SWAP/CNOT across an undirected edge
+     * \note Favours the fidelity of i -> j if both directions are coupled
+     */
+    double edge_cost(int i, int j) const {
+        if (auto e = find_coupling(i, j); e != targets_.size()) {
+            return -std::log(coupling_fidelities_[e]);
+        }
+        return -std::log(coupling_fidelities_[find_coupling(j, i)]);
+    }
+
+    /**
+     * \brief The cost of a shortest path between two qubits
+     * \param i The source qubit
+     * \param j The target qubit
+     */
+    double path_cost(int i, int j) {
+        if (qubits_ <= DENSE_QUBIT_LIMIT) {
+            compute_shortest_paths();
+            return dist[i][j];
+        }
+
+        compute_paths_to(j);
+        return dist_to_[j][i];
+    }
+
+    /**
+     * \brief The next qubit on a shortest path between two qubits
+     * \param i The source qubit
+     * \param j The target qubit
+     * \return The next qubit, or qubits_ if j is unreachable from i
+     */
+    int next_hop(int i, int j) {
+        if (qubits_ <= DENSE_QUBIT_LIMIT) {
+            compute_shortest_paths();
+            return shortest_paths[i][j];
+        }
+
+        compute_paths_to(j);
+        return next_hop_to_[j][i];
+    }
+
+    /**
+     * \brief Builds the undirected adjacency lists of the coupling graph
+     * \note Assigns result to neighbours_
+     */
+    void compute_neighbours() {
+        if (!neighbours_.empty()) {
+            return;
+        }
+
+        neighbours_.resize(qubits_);
+        for (auto i = 0; i < qubits_; i++) {
+            for (auto e = row_offsets_[i]; e < row_offsets_[i + 1]; e++) {
+                neighbours_[i].push_back(targets_[e]);
+                neighbours_[targets_[e]].push_back(i);
+            }
+        }
+    }
+
+    /**
+     * \brief Dijkstra's single-target-shortest-paths algorithm
+     *
+     * Used in place of Floyd-Warshall for devices too large to store all
+     * pairs of distances. At most DENSE_QUBIT_LIMIT targets are cached at any
+     * time.
+     *
+     * \note Assigns result to dist_to_[j] and next_hop_to_[j]
+     */
+    void compute_paths_to(int j) {
+        if (dist_to_.find(j) != dist_to_.end()) {
+            return;
+        }
+        if (dist_to_.size() >= DENSE_QUBIT_LIMIT) {
+            dist_to_.clear();
+            next_hop_to_.clear();
+        }
+
+        compute_neighbours();
+
+        auto& d = dist_to_[j];
+        auto& next = next_hop_to_[j];
+        d.assign(qubits_, -std::log(0.0000000001)); // Effectively infinite
+        next.assign(qubits_, qubits_);
+        d[j] = 0;
+        next[j] = j;
+
+        using entry = std::pair<double, int>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>>
+            queue;
+        queue.emplace(0, j);
+        while (!queue.empty()) {
+            auto [cost, v] = queue.top();
+            queue.pop();
+            if (cost > d[v]) {
+                continue;
+            }
+
+            for (auto u : neighbours_[v]) {
+                if (cost + edge_cost(u, v) < d[u]) {
+                    d[u] = cost + edge_cost(u, v);
+                    next[u] = v;
+                    queue.emplace(d[u], u);
+                }
+            }
+        }
+    }
+
     /**
      * \brief Floyd-Warshall all-pairs-shortest-paths algorithm
      * \note Assigns result to dist and shortest_paths
@@ -394,13 +699,6 @@ class Device {
                     if (i == j) {
                         dist[i][j] = 0;
                         shortest_paths[i][j] = j;
-                    } else if (couplings_[i][j]) {
-                        dist[i][j] = -std::log(coupling_fidelities_[i][j]);
-                        shortest_paths[i][j] = j;
-                    } else if (couplings_[j][i]) { // Since swaps are the same
-                                                   // cost either direction
-                        dist[i][j] = -std::log(coupling_fidelities_[j][i]);
-                        shortest_paths[i][j] = j;
                     } else {
                         dist[i][j] =
                             -std::log(0.0000000001); // Effectively infinite
@@ -408,6 +706,18 @@ class Device {
                     }
                 }
             }
+            for (auto i = 0; i < qubits_; i++) {
+                for (auto e = row_offsets_[i]; e < row_offsets_[i + 1]; e++) {
+                    auto j = targets_[e];
+                    if (i != j) {
+                        // Since swaps are the same cost either direction
+                        dist[i][j] = edge_cost(i, j);
+                        dist[j][i] = edge_cost(j, i);
+                        shortest_paths[i][j] = j;
+                        shortest_paths[j][i] = i;
+                    }
+                }
+            }
 
             for (auto k = 0; k < qubits_; k++) {
                 for (auto i = 0; i < qubits_; i++) {
@@ -431,12 +741,12 @@ class Device {
      *
      * \param s_tree The input spanning tree
      * \param p Const reference to the path to be inserted
-     * \param in_tree The set of nodes already in the tree
-     * \return The set of nodes in the resulting spanning tree
+     * \param in_tree Membership of each node in the tree, updated in place
+     * \return The nodes of the path now in the tree, in increasing order
      */
-    std::set<int> add_to_tree(spanning_tree& s_tree, const path& p,
-                              const std::set<int>& in_tree) {
-        std::set<int> ret;
+    std::vector<int> add_to_tree(spanning_tree& s_tree, const path& p,
+                                 std::vector<bool>& in_tree) {
+        std::vector<int> ret;
 
         int next = -1;
         auto insert_iter = s_tree.end();
@@ -447,12 +757,163 @@ class Device {
                 --insert_iter;
             }
             next = *it;
-            ret.insert(*it);
+            ret.push_back(*it);
 
             // If the current node is already in the tree, we're done
-            if (in_tree.find(*it) != in_tree.end()) {
+            if (in_tree[*it]) {
                 break;
             }
+            in_tree[*it] = true;
+        }
+
+        std::sort(ret.begin(), ret.end());
+        return ret;
+    }
+
+    /**
+     * \brief Mehlhorn's 2-approximation to a minimal Steiner tree
+     *
+     * Partitions the device into the Voronoi regions of the root & terminals,
+     * takes a minimal spanning tree of the terminals over the edges crossing
+     * regions, and expands each of its edges into shortest paths. See
+     * K. Mehlhorn, "A faster approximation algorithm for the Steiner problem
+     * in graphs", Inf. Process. Lett. 27 (1988).
+     *
+     * \param terminals A list of terminal qubits to be connected
+     * \param root A root for the Steiner tree
+     * \return A spanning tree represented as a list of edges
+     */
+    spanning_tree mehlhorn_steiner(const std::list<int>& terminals, int root) {
+        compute_neighbours();
+
+        // Voronoi partition, by multi-source Dijkstra
+        std::vector<double> d(qubits_, std::numeric_limits<double>::infinity());
+        std::vector<int> owner(qubits_, -1);
+        std::vector<int> pred(qubits_, -1);
+        std::vector<bool> is_terminal(qubits_, false);
+
+        using entry = std::pair<double, int>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>>
+            queue;
+        is_terminal[root] = true;
+        for (auto t : terminals) {
+            is_terminal[t] = true;
+        }
+        for (auto v = 0; v < qubits_; v++) {
+            if (is_terminal[v]) {
+                d[v] = 0;
+                owner[v] = v;
+                queue.emplace(0, v);
+            }
+        }
+        while (!queue.empty()) {
+            auto [cost, v] = queue.top();
+            queue.pop();
+            if (cost > d[v]) {
+                continue;
+            }
+
+            for (auto u : neighbours_[v]) {
+                if (cost + edge_cost(u, v) < d[u]) {
+                    d[u] = cost + edge_cost(u, v);
+                    owner[u] = owner[v];
+                    pred[u] = v;
+                    queue.emplace(d[u], u);
+                }
+            }
+        }
+
+        // Shortest edge between each pair of adjacent regions
+        std::map<coupling, std::tuple<double, int, int>> bridges;
+        for (auto u = 0; u < qubits_; u++) {
+            for (auto v : neighbours_[u]) {
+                if (owner[u] == -1 || owner[v] == -1 || owner[u] >= owner[v]) {
+                    continue;
+                }
+
+                auto w = d[u] + edge_cost(u, v) + d[v];
+                auto [it, inserted] = bridges.try_emplace(
+                    std::make_pair(owner[u], owner[v]), w, u, v);
+                if (!inserted && w < std::get<0>(it->second)) {
+                    it->second = std::make_tuple(w, u, v);
+                }
+            }
+        }
+
+        // Kruskal's algorithm on the region graph
+        std::vector<std::tuple<double, int, int>> candidates;
+        candidates.reserve(bridges.size());
+        for (auto& [regions, bridge] : bridges) {
+            candidates.push_back(bridge);
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        std::vector<int> parent(qubits_);
+        for (auto v = 0; v < qubits_; v++) {
+            parent[v] = v;
+        }
+        auto find = [&parent](int v) {
+            while (parent[v] != v) {
+                v = parent[v] = parent[parent[v]];
+            }
+            return v;
+        };
+
+        // Expand the spanning tree into a subgraph of the device
+        std::vector<std::vector<int>> subgraph(qubits_);
+        auto add_edge = [&subgraph](int u, int v) {
+            subgraph[u].push_back(v);
+            subgraph[v].push_back(u);
+        };
+        for (auto& [w, u, v] : candidates) {
+            auto ru = find(owner[u]);
+            auto rv = find(owner[v]);
+            if (ru == rv) {
+                continue;
+            }
+            parent[ru] = rv;
+
+            add_edge(u, v);
+            for (auto x = u; pred[x] != -1; x = pred[x]) {
+                add_edge(x, pred[x]);
+            }
+            for (auto x = v; pred[x] != -1; x = pred[x]) {
+                add_edge(x, pred[x]);
+            }
+        }
+
+        // Orient from the root in topological order, then prune non-terminal
+        // leaves
+        std::vector<int> order;
+        std::vector<int> tree_parent(qubits_, -1);
+        std::vector<bool> visited(qubits_, false);
+        std::vector<int> stack{root};
+        visited[root] = true;
+        while (!stack.empty()) {
+            auto v = stack.back();
+            stack.pop_back();
+            order.push_back(v);
+            for (auto u : subgraph[v]) {
+                if (!visited[u]) {
+                    visited[u] = true;
+                    tree_parent[u] = v;
+                    stack.push_back(u);
+                }
+            }
+        }
+
+        std::vector<bool> needed(is_terminal);
+        for (auto it = order.rbegin(); it != order.rend(); it++) {
+            if (needed[*it] && tree_parent[*it] != -1) {
+                needed[tree_parent[*it]] = true;
+            }
+        }
+
+        spanning_tree ret;
+        for (auto v : order) {
+            if (v != root && needed[v]) {
+                ret.emplace_back(tree_parent[v], v);
+            }
         }
 
         return ret;
@@ -473,9 +934,9 @@ inline Device parse_json(std::string fname) {
 
     std::string name = j["name"];
     int n = j["qubits"].size();
-    std::vector<std::vector<bool>> dag(n, std::vector<bool>(n));
     std::vector<double> sq_fi(n);
-    std::vector<std::vector<double>> tq_fi(n, std::vector<double>(n));
+    std::set<coupling> seen;
+    std::vector<std::pair<coupling, double>> edges;
 
     for (json& qubit : j["qubits"]) {
         int id = qubit["id"];
@@ -501,28 +962,33 @@ inline Device parse_json(std::string fname) {
         if (x == y) {
             throw std::logic_error("Qubit can't be coupled with itself");
         }
-        if (dag[x][y]) {
+        if (!seen.insert({x, y}).second) {
             throw std::logic_error("Duplicate coupling");
         }
-        dag[x][y] = true;
         auto it = coupling.find("fidelity");
         if (it != coupling.end()) {
-            tq_fi[x][y] = *it;
+            edges.emplace_back(std::make_pair(x, y), *it);
         } else {
-            tq_fi[x][y] = FIDELITY_1;
+            edges.emplace_back(std::make_pair(x, y), FIDELITY_1);
         }
     }
-    return Device(name, n, dag, sq_fi, tq_fi);
+    return Device(name, n, edges, sq_fi);
 }
 
 /** \brief Generates a fully connected device with a given number of qubits */
 inline Device fully_connected(uint32_t n) {
-    auto tmp = std::vector<std::vector<bool>>(n, std::vector<bool>(n, true));
-    for (uint32_t i = 0; i < n; i++) {
-        tmp[i][i] = false;
+    std::vector<std::pair<coupling, double>> edges;
+    edges.reserve(static_cast<std::size_t>(n) * (n > 0 ? n - 1 : 0));
+    for (int i = 0; i < static_cast<int>(n); i++) {
+        for (int j = 0; j < static_cast<int>(n); j++) {
+            if (i != j) {
+                edges.emplace_back(std::make_pair(i, j), FIDELITY_1);
+            }
+        }
     }
 
-    return Device("Fully connected device", n, tmp);
+    return Device("Fully connected device", n, edges,
+                  std::vector<double>(n, FIDELITY_1));
 }
 
 } /* namespace mapping */
@@ -0,0 +1,161 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file mapping/layout/allocator.hpp
+ * \brief Physical qubit & coupling allocation for layout generation
+ */
+
+#ifndef MAPPING_LAYOUT_ALLOCATOR_HPP_
+#define MAPPING_LAYOUT_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "staq/mapping/device.hpp"
+
+namespace staq {
+namespace mapping {
+
+/**
+ * \class staq::mapping::CouplingAllocator
+ * \brief Tracks allocated physical qubits & couplings of a device
+ *
+ * Hands out the highest fidelity coupling compatible with a partial
+ * assignment of a CNOT's control and target. Uses the per-qubit coupling
+ * lists of the device, so that each request costs O(degree) rather than a
+ * scan over every coupling in the device.
+ */
+class CouplingAllocator {
+  public:
+    CouplingAllocator(Device& device) : device_(device) { reset(); }
+
+    /** \brief Frees all qubits & couplings */
+    void reset() {
+        allocated_ = std::vector<bool>(device_.qubits_, false);
+        used_ = std::vector<bool>(device_.coupling_list().size(), false);
+        next_coupling_ = 0;
+        next_free_ = 0;
+    }
+
+    /** \brief Whether a physical qubit has been allocated */
+    bool allocated(int i) const { return allocated_[i]; }
+
+    /**
+     * \brief Allocates the best available coupling
+     *
+     * Finds the highest fidelity unused coupling whose control is either
+     * ctrl or, if no control is given, any unallocated qubit, and likewise
+     * for the target. The coupling and both of its qubits are marked as
+     * allocated.
+     *
+     * \param ctrl The physical control qubit, if already assigned
+     * \param tgt The physical target qubit, if already assigned
+     * \return The allocated coupling, if one exists
+     */
+    std::optional<coupling> allocate(std::optional<int> ctrl,
+                                     std::optional<int> tgt) {
+        auto& list = device_.coupling_list();
+        std::optional<std::size_t> found;
+
+        // A used coupling has both of its qubits allocated, so only the
+        // fully assigned case needs to check for reuse
+        if (ctrl && tgt) {
+            for (auto id : device_.out_couplings(*ctrl)) {
+                if (list[id].first.second == *tgt) {
+                    if (!used_[id]) {
+                        found = id;
+                    }
+                    break;
+                }
+            }
+        } else if (ctrl) {
+            for (auto id : device_.out_couplings(*ctrl)) {
+                if (!allocated_[list[id].first.second]) {
+                    found = id;
+                    break;
+                }
+            }
+        } else if (tgt) {
+            for (auto id : device_.in_couplings(*tgt)) {
+                if (!allocated_[list[id].first.first]) {
+                    found = id;
+                    break;
+                }
+            }
+        } else {
+            // Allocation is monotone, so skipped couplings never free up
+            while (next_coupling_ < list.size() &&
+                   (allocated_[list[next_coupling_].first.first] ||
+                    allocated_[list[next_coupling_].first.second])) {
+                next_coupling_++;
+            }
+            if (next_coupling_ < list.size()) {
+                found = next_coupling_;
+            }
+        }
+
+        if (!found) {
+            return std::nullopt;
+        }
+
+        auto [i, j] = list[*found].first;
+        used_[*found] = true;
+        allocated_[i] = true;
+        allocated_[j] = true;
+        return list[*found].first;
+    }
+
+    /**
+     * \brief Allocates the lowest-indexed free physical qubit
+     * \return The allocated qubit
+     */
+    int allocate_free() {
+        while (next_free_ < device_.qubits_ && allocated_[next_free_]) {
+            next_free_++;
+        }
+        if (next_free_ >= device_.qubits_) {
+            throw std::logic_error("Not enough physical qubits");
+        }
+
+        allocated_[next_free_] = true;
+        return next_free_;
+    }
+
+  private:
+    Device& device_;
+    std::vector<bool> allocated_;    ///< Allocated physical qubits
+    std::vector<bool> used_;         ///< Allocated couplings
+    std::size_t next_coupling_ = 0; ///< First possibly free coupling
+    int next_free_ = 0;              ///< First possibly free qubit
+};
+
+} /* namespace mapping */
+} /* namespace staq */
+
+#endif /* MAPPING_LAYOUT_ALLOCATOR_HPP_ */
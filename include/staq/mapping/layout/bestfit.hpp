@@ -37,6 +37,7 @@
 #include "qasmtools/ast/traversal.hpp"
 
 #include "staq/mapping/device.hpp"
+#include "staq/mapping/layout/allocator.hpp"
 
 namespace staq {
 namespace mapping {
@@ -53,12 +54,13 @@ namespace ast = qasmtools::ast;
  */
 class BestFit final : public ast::Traverse {
   public:
-    BestFit(Device& device) : Traverse(), device_(device) {}
+    BestFit(Device& device)
+        : Traverse(), device_(device), allocator_(device_) {}
     ~BestFit() = default;
 
     /** \brief Main generation method */
     layout generate(ast::Program& prog) {
-        allocated_ = std::vector<bool>(device_.qubits_, false);
+        allocator_.reset();
         access_paths_.clear();
         histogram_.clear();
 
@@ -84,7 +86,7 @@ class BestFit final : public ast::Traverse {
 
   private:
     Device device_;
-    std::vector<bool> allocated_;
+    CouplingAllocator allocator_;
     std::set<ast::VarAccess> access_paths_;
     std::map<std::pair<ast::VarAccess, ast::VarAccess>, int> histogram_;
 
@@ -106,58 +108,26 @@ class BestFit final : public ast::Traverse {
         pairs.sort(cmp);
 
         // For each pair with CNOT gates between them, try to assign a coupling
-        auto couplings = device_.couplings();
         for (auto& [args, val] : pairs) {
-            int ctrl_bit;
-            int tgt_bit;
-            for (auto& [coupling, f] : couplings) {
-                if (auto it = ret.find(args.first); it != ret.end()) {
-                    if (it->second != coupling.first) {
-                        continue;
-                    } else {
-                        ctrl_bit = it->second;
-                    }
-                } else if (!allocated_[coupling.first]) {
-                    ctrl_bit = coupling.first;
-                } else {
-                    continue;
-                }
-
-                if (auto it = ret.find(args.second); it != ret.end()) {
-                    if (it->second != coupling.second) {
-                        continue;
-                    } else {
-                        tgt_bit = it->second;
-                    }
-                } else if (!allocated_[coupling.second]) {
-                    tgt_bit = coupling.second;
-                } else {
-                    continue;
-                }
-
-                ret[args.first] = ctrl_bit;
-                ret[args.second] = tgt_bit;
-                allocated_[ctrl_bit] = true;
-                allocated_[tgt_bit] = true;
-                couplings.erase(std::make_pair(coupling, f));
-                break;
+            std::optional<int> ctrl_bit;
+            std::optional<int> tgt_bit;
+            if (auto it = ret.find(args.first); it != ret.end()) {
+                ctrl_bit = it->second;
+            }
+            if (auto it = ret.find(args.second); it != ret.end()) {
+                tgt_bit = it->second;
+            }
+
+            if (auto coupling = allocator_.allocate(ctrl_bit, tgt_bit)) {
+                ret[args.first] = coupling->first;
+                ret[args.second] = coupling->second;
             }
         }
 
         // For any remaining access paths, map them
         for (auto ap : access_paths_) {
-            auto i = 0;
-            bool cont = ret.find(ap) == ret.end();
-            while (cont) {
-                if (i >= device_.qubits_) {
-                    throw std::logic_error("Not enough physical qubits");
-                } else if (!allocated_[i]) {
-                    ret[ap] = i;
-                    allocated_[i] = true;
-                    cont = false;
-                }
-
-                i++;
+            if (ret.find(ap) == ret.end()) {
+                ret[ap] = allocator_.allocate_free();
             }
         }
 
@@ -166,7 +136,7 @@ class BestFit final : public ast::Traverse {
 };
 
 /** \brief Generates a best-fit layout for a program on a physical device */
-layout compute_bestfit_layout(Device& device, ast::Program& prog) {
+inline layout compute_bestfit_layout(Device& device, ast::Program& prog) {
     BestFit gen(device);
     return gen.generate(prog);
 }
@@ -32,14 +32,12 @@
 #ifndef MAPPING_LAYOUT_EAGER_HPP_
 #define MAPPING_LAYOUT_EAGER_HPP_
 
-#include <cstddef>
-#include <map>
 #include <set>
-#include <vector>
 
 #include "qasmtools/ast/traversal.hpp"
 
 #include "staq/mapping/device.hpp"
+#include "staq/mapping/layout/allocator.hpp"
 
 namespace staq {
 namespace mapping {
@@ -56,31 +54,20 @@ namespace ast = qasmtools::ast;
  */
 class EagerLayout final : public ast::Traverse {
   public:
-    EagerLayout(Device& device) : Traverse(), device_(device) {
-        couplings_ = device_.couplings();
-    }
+    EagerLayout(Device& device)
+        : Traverse(), device_(device), allocator_(device_) {}
 
     /** \brief Main generation method */
     layout generate(ast::Program& prog) {
         layout_ = layout();
-        allocated_ = std::vector<bool>(device_.qubits_, false);
+        allocator_.reset();
         access_paths_.clear();
 
         prog.accept(*this);
 
         for (auto ap : access_paths_) {
-            auto i = 0;
-            bool cont = layout_.find(ap) == layout_.end();
-            while (cont) {
-                if (i >= device_.qubits_) {
-                    throw std::logic_error("Not enough physical qubits");
-                } else if (!allocated_[i]) {
-                    layout_[ap] = i;
-                    allocated_[i] = true;
-                    cont = false;
-                }
-
-                i++;
+            if (layout_.find(ap) == layout_.end()) {
+                layout_[ap] = allocator_.allocate_free();
             }
         }
 
@@ -103,52 +90,30 @@ class EagerLayout final : public ast::Traverse {
         auto ctrl = gate.ctrl();
         auto tgt = gate.tgt();
 
-        std::size_t ctrl_bit;
-        std::size_t tgt_bit;
-        for (auto& [coupling, f] : couplings_) {
-            if (auto it = layout_.find(ctrl); it != layout_.end()) {
-                if (it->second != coupling.first) {
-                    continue;
-                } else {
-                    ctrl_bit = it->second;
-                }
-            } else if (!allocated_[coupling.first]) {
-                ctrl_bit = coupling.first;
-            } else {
-                continue;
-            }
-
-            if (auto it = layout_.find(tgt); it != layout_.end()) {
-                if (it->second != coupling.second) {
-                    continue;
-                } else {
-                    tgt_bit = it->second;
-                }
-            } else if (!allocated_[coupling.second]) {
-                tgt_bit = coupling.second;
-            } else {
-                continue;
-            }
+        std::optional<int> ctrl_bit;
+        std::optional<int> tgt_bit;
+        if (auto it = layout_.find(ctrl); it != layout_.end()) {
+            ctrl_bit = it->second;
+        }
+        if (auto it = layout_.find(tgt); it != layout_.end()) {
+            tgt_bit = it->second;
+        }
 
-            layout_[ctrl] = static_cast<int>(ctrl_bit);
-            layout_[tgt] = static_cast<int>(tgt_bit);
-            allocated_[ctrl_bit] = true;
-            allocated_[tgt_bit] = true;
-            couplings_.erase(std::make_pair(coupling, f));
-            break;
+        if (auto coupling = allocator_.allocate(ctrl_bit, tgt_bit)) {
+            layout_[ctrl] = coupling->first;
+            layout_[tgt] = coupling->second;
         }
     }
 
   private:
     Device device_;
+    CouplingAllocator allocator_;
     layout layout_;
-    std::vector<bool> allocated_;
     std::set<ast::VarAccess> access_paths_;
-    std::set<std::pair<coupling, double>, cmp_couplings> couplings_;
 };
 
 /** \brief Generates an eager layout for a program on a physical device */
-layout compute_eager_layout(Device& device, ast::Program& prog) {
+inline layout compute_eager_layout(Device& device, ast::Program& prog) {
     EagerLayout gen(device);
     return gen.generate(prog);
 }
@@ -32,6 +32,8 @@
 #ifndef MAPPING_MAPPING_STEINER_HPP_
 #define MAPPING_MAPPING_STEINER_HPP_
 
+#include <chrono>
+#include <optional>
 #include <vector>
 
 #include "qasmtools/ast/traversal.hpp"
@@ -40,6 +42,7 @@
 #include "staq/mapping/device.hpp"
 #include "staq/synthesis/cnot_dihedral.hpp"
 #include "staq/synthesis/linear_reversible.hpp"
+#include "staq/synthesis/steiner_cost.hpp"
 
 namespace staq {
 namespace mapping {
@@ -404,22 +407,7 @@ class SteinerDry final : public ast::Traverse {
         Traverse::visit(prog);
 
         // Synthesize the last leg
-        for (auto& gate :
-             synthesis::gray_steiner(phases_, permutation_, device_)) {
-            std::visit(
-                utils::overloaded{
-                    [this, &prog](std::pair<int, int>& cx) {
-                        if (device_.coupled(cx.first, cx.second) ||
-                            device_.coupled(cx.second, cx.first)) {
-                            cnots_++;
-                        } else {
-                            throw std::logic_error(
-                                "CNOT between non-coupled vertices!");
-                        }
-                    },
-                    [this, &prog](std::pair<ast::ptr<ast::Expr>, int>& u1) {}},
-                gate);
-        }
+        cnots_ += cost_.gray_steiner(phases_, permutation_, device_);
 
         // Reset the cnot-dihedral circuit
         phases_.clear();
@@ -540,6 +528,7 @@ class SteinerDry final : public ast::Traverse {
     Device device_;
     layout layout_;
     int cnots_ = 0;
+    synthesis::SteinerCost cost_; ///< Reused between dry-runs
 
     // Accumulating data
     std::list<synthesis::phase_term> phases_;
@@ -560,22 +549,7 @@ class SteinerDry final : public ast::Traverse {
     template <typename T>
     void flush(T& node) {
         // Synthesize circuit
-        for (auto& gate :
-             synthesis::gray_steiner(phases_, permutation_, device_)) {
-            std::visit(
-                utils::overloaded{
-                    [this, &node](std::pair<int, int>& cx) {
-                        if (device_.coupled(cx.first, cx.second) ||
-                            device_.coupled(cx.second, cx.first)) {
-                            cnots_++;
-                        } else {
-                            throw std::logic_error(
-                                "CNOT between non-coupled vertices!");
-                        }
-                    },
-                    [this, &node](std::pair<ast::ptr<ast::Expr>, int>& u1) {}},
-                gate);
-        }
+        cnots_ += cost_.gray_steiner(phases_, permutation_, device_);
 
         // Reset the cnot-dihedral circuit
         phases_.clear();
@@ -598,15 +572,23 @@ class SteinerDry final : public ast::Traverse {
  * \brief Layout optimization for the Steiner mapper via hill climb
  *
  * Repeatedly performs dry-runs, modifying the qubit mapping with a
- * single swap each time.
+ * single swap each time. If a deadline is given, stops with the best layout
+ * found so far once it has passed.
  */
-void optimize_steiner_layout(Device& device, layout& init, ast::Program& prog) {
+inline void optimize_steiner_layout(
+    Device& device, layout& init, ast::Program& prog,
+    std::optional<std::chrono::steady_clock::time_point> deadline =
+        std::nullopt) {
     SteinerDry alg(device);
     int current_min = alg.get_cnot_count(prog, init);
 
 outer:
     for (auto it = init.begin(); it != init.end(); it++) {
         for (auto ti = std::next(it); ti != init.end(); ti++) {
+            if (deadline && std::chrono::steady_clock::now() > *deadline) {
+                return;
+            }
+
             std::swap(it->second, ti->second);
             auto cnot_count = alg.get_cnot_count(prog, init);
             if (cnot_count < current_min) {
@@ -619,7 +601,7 @@ outer:
 }
 
 /** \brief Applies the Steiner mapper to an AST given a physical device */
-void steiner_mapping(Device& device, ast::Program& prog) {
+inline void steiner_mapping(Device& device, ast::Program& prog) {
     SteinerMapper mapper(device);
     prog.accept(mapper);
 }
@@ -204,7 +204,7 @@ class SwapMapper final : public ast::Replacer {
 };
 
 /** \brief Applies the swap mapper to an AST given a physical device */
-std::map<int, int> map_onto_device(Device& device, ast::Program& prog) {
+inline std::map<int, int> map_onto_device(Device& device, ast::Program& prog) {
     SwapMapper mapper(device);
     return mapper.run(prog);
 }
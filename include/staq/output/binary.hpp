@@ -0,0 +1,321 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file output/binary.hpp
+ * \brief Binary circuit outputter
+ * \see qasmtools/parser/binary.hpp for the format
+ */
+
+#ifndef OUTPUT_BINARY_HPP_
+#define OUTPUT_BINARY_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "qasmtools/ast/ast.hpp"
+#include "qasmtools/parser/binary.hpp"
+
+namespace staq {
+namespace output {
+
+namespace ast = qasmtools::ast;
+namespace binary = qasmtools::parser::binary;
+
+/**
+ * \class staq::output::BinaryOutputter
+ * \brief Visitor for converting a QASM AST to a flat binary circuit
+ *
+ * Gate and oracle declarations are dropped, so every gate applied must be
+ * U, CX or a qelib1.inc gate, with constant parameters.
+ */
+class BinaryOutputter final : public ast::Visitor {
+  public:
+    BinaryOutputter(std::ostream& os) : Visitor(), os_(os) {}
+    ~BinaryOutputter() = default;
+
+    void run(ast::Program& prog) {
+        std_include_ = prog.std_include();
+        qubits_ = 0;
+        bits_ = 0;
+        registers_.clear();
+        register_index_.clear();
+        gate_index_.clear();
+        num_records_ = 0;
+        num_operands_ = 0;
+        num_params_ = 0;
+        params_.clear();
+        register_table_.clear();
+        gate_table_.clear();
+        records_.clear();
+        operands_.clear();
+        strings_.clear();
+
+        prog.accept(*this);
+        write();
+    }
+
+    // Variables
+    void visit(ast::VarAccess&) {}
+
+    // Expressions
+    void visit(ast::BExpr&) {}
+    void visit(ast::UExpr&) {}
+    void visit(ast::PiExpr&) {}
+    void visit(ast::IntExpr&) {}
+    void visit(ast::RealExpr&) {}
+    void visit(ast::VarExpr&) {}
+
+    // Statements
+    void visit(ast::MeasureStmt& stmt) {
+        add_record(binary::GateKind::measure, "", {},
+                   {&stmt.q_arg(), &stmt.c_arg()});
+    }
+
+    void visit(ast::ResetStmt& stmt) {
+        add_record(binary::GateKind::reset, "", {}, {&stmt.arg()});
+    }
+
+    void visit(ast::IfStmt& stmt) {
+        auto it = register_index_.find(stmt.var());
+        if (it == register_index_.end() || registers_[it->second].quantum) {
+            throw std::logic_error("Unknown classical register " + stmt.var());
+        }
+        condition_ = it->second;
+        condition_value_ = static_cast<std::uint32_t>(stmt.cond());
+        stmt.then().accept(*this);
+        condition_ = binary::no_condition;
+        condition_value_ = 0;
+    }
+
+    // Gates
+    void visit(ast::UGate& gate) {
+        add_record(binary::GateKind::U, "",
+                   {&gate.theta(), &gate.phi(), &gate.lambda()},
+                   {&gate.arg()});
+    }
+
+    void visit(ast::CNOTGate& gate) {
+        add_record(binary::GateKind::CX, "", {}, {&gate.ctrl(), &gate.tgt()});
+    }
+
+    void visit(ast::BarrierGate& gate) {
+        std::vector<ast::VarAccess*> args;
+        for (auto& arg : gate.args()) {
+            args.push_back(&arg);
+        }
+        add_record(binary::GateKind::barrier, "", {}, args);
+    }
+
+    void visit(ast::DeclaredGate& gate) {
+        if (!std_include_ || !ast::is_std_qelib(gate.name())) {
+            throw std::logic_error("Binary output only supports qelib1.inc "
+                                   "gates, inline " +
+                                   gate.name() + " first");
+        }
+        std::vector<ast::Expr*> params;
+        for (int i = 0; i < gate.num_cargs(); i++) {
+            params.push_back(&gate.carg(i));
+        }
+        std::vector<ast::VarAccess*> args;
+        for (auto& arg : gate.qargs()) {
+            args.push_back(&arg);
+        }
+        add_record(binary::GateKind::declared, gate.name(), params, args);
+    }
+
+    // Declarations
+    void visit(ast::GateDecl&) {}
+    void visit(ast::OracleDecl&) {}
+
+    void visit(ast::RegisterDecl& decl) {
+        std::uint32_t index = static_cast<std::uint32_t>(registers_.size());
+        auto& start = decl.is_quantum() ? qubits_ : bits_;
+        registers_.push_back({decl.is_quantum(), start});
+        register_index_[decl.id()] = index;
+        start += decl.size();
+
+        put_string(register_table_, decl.id());
+        binary::put_u32(register_table_, decl.size());
+        binary::put_u32(register_table_, decl.is_quantum() ? 1 : 0);
+    }
+
+    void visit(ast::AncillaDecl&) {
+        throw std::logic_error("Binary output has no support for local "
+                               "ancillas");
+    }
+
+    // Program
+    void visit(ast::Program& prog) {
+        prog.foreach_stmt([this](auto& stmt) { stmt.accept(*this); });
+    }
+
+  private:
+    struct reg {
+        bool quantum;
+        std::uint32_t start; ///< index of the first qubit or bit
+    };
+
+    std::ostream& os_;
+
+    bool std_include_ = false;
+    std::uint32_t qubits_ = 0;
+    std::uint32_t bits_ = 0;
+    std::vector<reg> registers_{};
+    std::unordered_map<std::string, std::uint32_t> register_index_{};
+    std::map<std::tuple<binary::GateKind, std::string, std::size_t,
+                        std::size_t>,
+             std::uint32_t>
+        gate_index_{};
+    std::uint32_t condition_ = binary::no_condition;
+    std::uint32_t condition_value_ = 0;
+
+    // Sections, already encoded
+    std::uint32_t num_records_ = 0;
+    std::uint32_t num_operands_ = 0;
+    std::uint32_t num_params_ = 0;
+    std::string params_{};
+    std::string register_table_{};
+    std::string gate_table_{};
+    std::string records_{};
+    std::string operands_{};
+    std::string strings_{};
+
+    void put_string(std::string& buf, const std::string& str) {
+        binary::put_u32(buf, static_cast<std::uint32_t>(strings_.size()));
+        binary::put_u32(buf, static_cast<std::uint32_t>(str.size()));
+        strings_ += str;
+    }
+
+    std::uint32_t operand(const ast::VarAccess& va) {
+        auto it = register_index_.find(va.var());
+        if (it == register_index_.end()) {
+            throw std::logic_error("Unknown register " + va.var());
+        }
+        if (!va.offset()) {
+            return binary::whole_register | it->second;
+        }
+        return registers_[it->second].start + *va.offset();
+    }
+
+    void add_record(binary::GateKind kind, const std::string& name,
+                    const std::vector<ast::Expr*>& params,
+                    const std::vector<ast::VarAccess*>& args) {
+        auto key = std::make_tuple(kind, name, params.size(), args.size());
+        auto it = gate_index_.find(key);
+        if (it == gate_index_.end()) {
+            auto index = static_cast<std::uint32_t>(gate_index_.size());
+            it = gate_index_.emplace(std::move(key), index).first;
+
+            binary::put_u32(gate_table_, static_cast<std::uint32_t>(kind));
+            put_string(gate_table_, name);
+            binary::put_u32(gate_table_,
+                            static_cast<std::uint32_t>(params.size()));
+            binary::put_u32(gate_table_,
+                            static_cast<std::uint32_t>(args.size()));
+        }
+
+        binary::put_u32(records_, it->second);
+        binary::put_u32(records_, num_operands_);
+        binary::put_u32(records_, num_params_);
+        binary::put_u32(records_, condition_);
+        binary::put_u32(records_, condition_value_);
+        num_records_++;
+
+        for (auto* arg : args) {
+            binary::put_u32(operands_, operand(*arg));
+        }
+        num_operands_ += static_cast<std::uint32_t>(args.size());
+
+        for (auto* param : params) {
+            auto value = param->constant_eval();
+            if (!value) {
+                throw std::logic_error(
+                    "Binary output requires constant gate parameters");
+            }
+            binary::put_f64(params_, *value);
+        }
+        num_params_ += static_cast<std::uint32_t>(params.size());
+    }
+
+    void write_section(const std::string& section) {
+        static const char padding[8] = {};
+        os_.write(section.data(), section.size());
+        os_.write(padding, binary::align(section.size()) - section.size());
+    }
+
+    void write() {
+        std::string header(binary::magic, sizeof(binary::magic));
+        binary::put_u32(header, binary::version);
+        binary::put_u32(header, std_include_ ? binary::flag_std_include : 0);
+        binary::put_u32(header, qubits_);
+        binary::put_u32(header, bits_);
+        binary::put_u32(header, static_cast<std::uint32_t>(registers_.size()));
+        binary::put_u32(header,
+                        static_cast<std::uint32_t>(gate_index_.size()));
+        binary::put_u32(header, num_records_);
+        binary::put_u32(header, num_operands_);
+        binary::put_u32(header, num_params_);
+        binary::put_u32(header, static_cast<std::uint32_t>(strings_.size()));
+
+        write_section(header);
+        write_section(params_);
+        write_section(register_table_);
+        write_section(gate_table_);
+        write_section(records_);
+        write_section(operands_);
+        os_.write(strings_.data(), strings_.size());
+    }
+};
+
+/** \brief Writes an AST as a binary circuit to stdout */
+void output_binary(ast::Program& prog) {
+    BinaryOutputter outputter(std::cout);
+    outputter.run(prog);
+}
+
+/** \brief Writes an AST as a binary circuit to a given output file */
+void write_binary(ast::Program& prog, std::string fname) {
+    std::ofstream ofs;
+    ofs.open(fname, std::ios::binary);
+
+    if (!ofs.good()) {
+        std::cerr << "Error: failed to open output file " << fname << "\n";
+    } else {
+        BinaryOutputter outputter(ofs);
+        outputter.run(prog);
+    }
+
+    ofs.close();
+}
+
+} /* namespace output */
+} /* namespace staq */
+
+#endif /* OUTPUT_BINARY_HPP_ */
@@ -35,6 +35,9 @@
 #include <typeinfo>
 
 #include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+#include "staq/output/parallel.hpp"
 
 namespace staq {
 namespace output {
@@ -63,6 +66,10 @@ class CirqOutputter final : public ast::Visitor {
     CirqOutputter(std::ostream& os) : Visitor(), os_(os) {}
     CirqOutputter(std::ostream& os, const config& params)
         : Visitor(), os_(os), config_(params) {}
+    /** \brief Copy of other writing to os, to format chunks in parallel */
+    CirqOutputter(const CirqOutputter& other, std::ostream& os)
+        : Visitor(), os_(os), config_(other.config_), prefix_(other.prefix_),
+          ambiguous_(other.ambiguous_), prefix_self_(other.prefix_self_) {}
     ~CirqOutputter() = default;
 
     void run(ast::Program& prog) {
@@ -117,7 +124,9 @@ class CirqOutputter final : public ast::Visitor {
 
     void visit(ast::IntExpr& expr) { os_ << expr.value(); }
 
-    void visit(ast::RealExpr& expr) { os_ << expr.value(); }
+    void visit(ast::RealExpr& expr) {
+        qasmtools::utils::write_double(os_, expr.value());
+    }
 
     void visit(ast::VarExpr& expr) {
         if (prefix_self_) {
@@ -357,11 +366,9 @@ class CirqOutputter final : public ast::Visitor {
         prefix_ = "    ";
 
         // Program body
-        prog.foreach_stmt([this](auto& stmt) {
-            if (typeid(stmt) != typeid(ast::GateDecl) &&
-                typeid(stmt) != typeid(ast::RegisterDecl)) {
-                stmt.accept(*this);
-            }
+        visit_body(*this, os_, prog, [](auto& stmt) {
+            return typeid(stmt) != typeid(ast::GateDecl) &&
+                   typeid(stmt) != typeid(ast::RegisterDecl);
         });
 
         os_ << "])\n";
@@ -37,6 +37,9 @@
 #include <typeinfo>
 
 #include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+#include "staq/output/parallel.hpp"
 
 namespace staq {
 namespace output {
@@ -56,11 +59,15 @@ std::unordered_map<std::string, std::string> qasmstd_to_ionq{{"sdg", "si"},
 class IonQOutputter final : public ast::Visitor {
   public:
     IonQOutputter(std::ostream& os) : Visitor(), os_(os) {}
+    /** \brief Copy of other writing to os, to format chunks in parallel */
+    IonQOutputter(const IonQOutputter& other, std::ostream& os)
+        : Visitor(), os_(os), prefix_(other.prefix_),
+          first_gate_(other.first_gate_) {}
     ~IonQOutputter() = default;
 
     void run(ast::Program& prog) {
         prefix_ = "";
-        first_gate = true;
+        first_gate_ = nullptr;
 
         prog.accept(*this);
     }
@@ -97,9 +104,7 @@ class IonQOutputter final : public ast::Visitor {
 
     void visit(ast::DeclaredGate& gate) {
         // JSON output: avoid outputting comma before first gate
-        if (first_gate) {
-            first_gate = false;
-        } else {
+        if (&gate != first_gate_) {
             os_ << ",\n";
         }
 
@@ -151,9 +156,11 @@ class IonQOutputter final : public ast::Visitor {
             // TODO: assert that there is exactly one carg
             // TODO: assert that this is a rotation gate
             // TODO: Handle multiples of pi nicely
-            os_ << prefix_ << "\"angle\": " << std::fixed
-                << gate.carg(0).constant_eval().value() / qasmtools::utils::pi
-                << ",\n";
+            os_ << prefix_ << "\"angle\": " << std::fixed;
+            qasmtools::utils::write_double(
+                os_, gate.carg(0).constant_eval().value() /
+                         qasmtools::utils::pi);
+            os_ << ",\n";
         }
 
         os_ << prefix_ << "\"gate\": \"" << name << "\"\n"; // no comma
@@ -196,15 +203,22 @@ class IonQOutputter final : public ast::Visitor {
         os_ << prefix_ << "\"circuit\": [\n";
         prefix_ += "    ";
 
-        // Program body
-        prog.foreach_stmt([this](auto& stmt) {
-            // Skip the gate declarations from qelib1.inc
-            // and the global register decl
-            if ((typeid(stmt) != typeid(ast::GateDecl)) &&
-                (typeid(stmt) != typeid(ast::RegisterDecl))) {
-                stmt.accept(*this);
+        // Skip the gate declarations from qelib1.inc
+        // and the global register decl
+        auto filter = [](auto& stmt) {
+            return typeid(stmt) != typeid(ast::GateDecl) &&
+                   typeid(stmt) != typeid(ast::RegisterDecl);
+        };
+
+        // Find the first gate, which is written without a leading comma
+        for (auto it = prog.begin(); it != prog.end() && !first_gate_; it++) {
+            if (filter(**it)) {
+                first_gate_ = dynamic_cast<ast::DeclaredGate*>(it->get());
             }
-        });
+        }
+
+        // Program body
+        visit_body(*this, os_, prog, filter);
 
         // Close circuit
         os_ << "\n";
@@ -220,7 +234,7 @@ class IonQOutputter final : public ast::Visitor {
     std::ostream& os_;
 
     std::string prefix_ = "";
-    bool first_gate = true;
+    const ast::DeclaredGate* first_gate_ = nullptr;
 };
 
 /** \brief Writes an AST in IonQ format to stdout */
@@ -32,9 +32,9 @@
 #ifndef OUTPUT_JSON_HPP_
 #define OUTPUT_JSON_HPP_
 
+#include <memory>
 #include <sstream>
 
-#include <CLI/CLI.hpp>
 #include <nlohmann/json.hpp>
 
 #include "qasmtools/ast/decl.hpp"
@@ -42,6 +42,8 @@
 #include "qasmtools/ast/stmt.hpp"
 #include "qasmtools/ast/var.hpp"
 
+#include "staq/output/json_writer.hpp"
+
 namespace staq {
 namespace output {
 
@@ -51,196 +53,280 @@ using json = nlohmann::json;
 /**
  * \class staq::output::JSONOutputter
  * \brief Visitor for converting a QASM AST to JSON
+ *
+ * The JSON is written out while the AST is visited. Each statement and
+ * variable access is written as an array holding its object, and
+ * expressions as null.
  */
 class JSONOutputter final : public Visitor {
   public:
-    JSONOutputter() = default;
+    /** \brief Collects the output, to be read back with json_val() */
+    JSONOutputter()
+        : buffer_(std::make_unique<std::stringstream>()), writer_(*buffer_) {}
+    /** \brief Writes the output to os */
+    explicit JSONOutputter(std::ostream& os) : writer_(os) {}
     ~JSONOutputter() = default;
 
     void run(Program& prog) { prog.accept(*this); }
 
     void visit(UGate& gd) override {
-        json j;
-        j["type"] = "Gate";
-        JSONOutputter arg0, arg1, arg2, arg3;
-        gd.arg().accept(arg0);
-        gd.arg().accept(arg1);
-        gd.arg().accept(arg2);
-        gd.arg().accept(arg3);
-        j["name"] = "UGate";
-        j["qargs"] = {arg0.json_val()};
-        j["cargs"] = {arg1.json_val(), arg2.json_val(), arg3.json_val()};
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("cargs");
+        writer_.begin_array();
+        for (int i = 0; i < 3; i++) {
+            gd.arg().accept(*this);
+        }
+        writer_.end_array();
+        writer_.key("name");
+        writer_.value("UGate");
+        writer_.key("qargs");
+        writer_.begin_array();
+        gd.arg().accept(*this);
+        writer_.end_array();
+        writer_.key("type");
+        writer_.value("Gate");
+        end_stmt();
     }
 
     void visit(CNOTGate& gd) override {
-        json j;
-        j["type"] = "Gate";
-        JSONOutputter arg0, arg1;
-        gd.ctrl().accept(arg0);
-        gd.tgt().accept(arg1);
-        j["name"] = "CNOTGate";
-        j["qargs"] = {arg0.json_val(), arg1.json_val()};
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("name");
+        writer_.value("CNOTGate");
+        writer_.key("qargs");
+        writer_.begin_array();
+        gd.ctrl().accept(*this);
+        gd.tgt().accept(*this);
+        writer_.end_array();
+        writer_.key("type");
+        writer_.value("Gate");
+        end_stmt();
     }
 
     void visit(BarrierGate& gd) override {
-        using namespace qasmtools::ast;
-        json j;
-        j["type"] = "Gate";
-        j["name"] = "BarrierGate";
-        j["qargs"] = {};
-        gd.foreach_arg([&j](VarAccess& va) {
-            JSONOutputter jva;
-            va.accept(jva);
-            j["qargs"].push_back(jva.json_val());
-        });
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("name");
+        writer_.value("BarrierGate");
+        writer_.key("qargs");
+        if (gd.num_args() == 0) {
+            writer_.null();
+        } else {
+            writer_.begin_array();
+            gd.foreach_arg([this](VarAccess& va) { va.accept(*this); });
+            writer_.end_array();
+        }
+        writer_.key("type");
+        writer_.value("Gate");
+        end_stmt();
     }
 
     void visit(DeclaredGate& gd) override {
-        using namespace qasmtools::ast;
-        json j;
-        j["type"] = "Gate";
-        j["name"] = gd.name();
-        j["qargs"] = {};
-        j["cargs"] = {};
-        gd.foreach_qarg([&j](VarAccess& va) {
-            JSONOutputter jva;
-            va.accept(jva);
-            j["qargs"].push_back(jva.json_val());
-        });
-        gd.foreach_carg([&j](Expr& va) {
-            JSONOutputter jva;
-            va.accept(jva);
-            j["cargs"].push_back(jva.json_val());
-        });
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("cargs");
+        if (gd.num_cargs() == 0) {
+            writer_.null();
+        } else {
+            writer_.begin_array();
+            gd.foreach_carg([this](Expr& e) { e.accept(*this); });
+            writer_.end_array();
+        }
+        writer_.key("name");
+        writer_.value(gd.name());
+        writer_.key("qargs");
+        if (gd.num_qargs() == 0) {
+            writer_.null();
+        } else {
+            writer_.begin_array();
+            gd.foreach_qarg([this](VarAccess& va) { va.accept(*this); });
+            writer_.end_array();
+        }
+        writer_.key("type");
+        writer_.value("Gate");
+        end_stmt();
     }
 
     void visit(AncillaDecl& ad) override {
-        json j;
-        j["type"] = "AncillaDecl";
-        j["name"] = ad.id();
-        j["size"] = ad.size();
-        j["is_dirty"] = (ad.is_dirty() ? 1 : 0);
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("is_dirty");
+        writer_.value(ad.is_dirty() ? 1 : 0);
+        writer_.key("name");
+        writer_.value(ad.id());
+        writer_.key("size");
+        writer_.value(ad.size());
+        writer_.key("type");
+        writer_.value("AncillaDecl");
+        end_stmt();
     }
 
     void visit(RegisterDecl& rd) override {
-        json j;
-        j["type"] = "RegisterDecl";
-        j["name"] = rd.id();
-        j["is_quantum"] = (rd.is_quantum() ? 1 : 0);
-        j["size"] = rd.size();
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("is_quantum");
+        writer_.value(rd.is_quantum() ? 1 : 0);
+        writer_.key("name");
+        writer_.value(rd.id());
+        writer_.key("size");
+        writer_.value(rd.size());
+        writer_.key("type");
+        writer_.value("RegisterDecl");
+        end_stmt();
     }
 
     void visit(OracleDecl& od) override {
         // TODO: verify that this is doing what it needs to do
-        json j;
-        j["type"] = "OracleDecl";
-        j["name"] = od.fname();
-        j["params"] = od.params();
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("name");
+        writer_.value(od.fname());
+        writer_.key("params");
+        write_strings(od.params());
+        writer_.key("type");
+        writer_.value("OracleDecl");
+        end_stmt();
     }
 
     void visit(IfStmt& ist) override {
         // TODO: Improve this later.
-        json j;
         std::stringstream in;
         ist.pretty_print(in, false);
-        j["type"] = "IfStmt";
-        j["name"] = "If";
-        j["body"] = in.str();
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("body");
+        writer_.value(in.str());
+        writer_.key("name");
+        writer_.value("If");
+        writer_.key("type");
+        writer_.value("IfStmt");
+        end_stmt();
     }
 
     void visit(ResetStmt& rst) override {
-        json j;
-        JSONOutputter arg_json_outputter;
-        rst.arg().accept(arg_json_outputter);
-        j["type"] = "ResetStmt";
-        j["name"] = "Reset";
-        j["qarg"] = arg_json_outputter.json_val();
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("name");
+        writer_.value("Reset");
+        writer_.key("qarg");
+        rst.arg().accept(*this);
+        writer_.key("type");
+        writer_.value("ResetStmt");
+        end_stmt();
     }
 
     void visit(MeasureStmt& mst) override {
-        json j;
-        JSONOutputter arg_json_1, arg_json_2;
-        mst.q_arg().accept(arg_json_1);
-        mst.c_arg().accept(arg_json_2);
-        j["type"] = "MeasureStmt";
-        j["name"] = "Measurement";
-        j["qarg"] = arg_json_1.json_val();
-        j["carg"] = arg_json_2.json_val();
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("carg");
+        mst.c_arg().accept(*this);
+        writer_.key("name");
+        writer_.value("Measurement");
+        writer_.key("qarg");
+        mst.q_arg().accept(*this);
+        writer_.key("type");
+        writer_.value("MeasureStmt");
+        end_stmt();
     }
 
     void visit(VarAccess& va) override {
-        json j;
-        j["type"] = "VarAccess";
-        j["name"] = "qubit";
-        j["symbol"] = va.var();
-        j["offset"] = {};
+        begin_stmt();
+        writer_.key("name");
+        writer_.value("qubit");
+        writer_.key("offset");
         if (va.offset().has_value()) {
-            j["offset"].push_back(va.offset().value());
+            writer_.begin_array();
+            writer_.value(va.offset().value());
+            writer_.end_array();
+        } else {
+            writer_.null();
         }
-        json_.push_back(j);
+        writer_.key("symbol");
+        writer_.value(va.var());
+        writer_.key("type");
+        writer_.value("VarAccess");
+        end_stmt();
     }
 
     // Expressions
-    void visit(BExpr& e) override {};
-    void visit(UExpr& e) override {};
-    void visit(PiExpr& e) override {};
-    void visit(IntExpr& e) override {};
-    void visit(RealExpr& e) override {};
-    void visit(VarExpr& e) override {};
+    void visit(BExpr& e) override { writer_.null(); };
+    void visit(UExpr& e) override { writer_.null(); };
+    void visit(PiExpr& e) override { writer_.null(); };
+    void visit(IntExpr& e) override { writer_.null(); };
+    void visit(RealExpr& e) override { writer_.null(); };
+    void visit(VarExpr& e) override { writer_.null(); };
 
     void visit(Expr& expr) {
-        json j;
         std::stringstream in;
         expr.pretty_print(in);
         auto ev = expr.constant_eval();
-        j["type"] = "Expr";
-        j["expr"] = in.str();
-        j["val"] = {};
+        begin_stmt();
+        writer_.key("expr");
+        writer_.value(in.str());
+        writer_.key("type");
+        writer_.value("Expr");
+        writer_.key("val");
         if (ev.has_value()) {
-            j["val"].push_back(ev.value());
+            writer_.begin_array();
+            writer_.value(ev.value());
+            writer_.end_array();
+        } else {
+            writer_.null();
         }
-        json_.push_back(j);
+        end_stmt();
     }
 
     void visit(GateDecl& gd) override {
-        using namespace qasmtools::ast;
-        json j;
-        j["type"] = "GateDecl";
-        j["name"] = gd.id();
-        j["q_params"] = gd.q_params();
-        j["c_params"] = gd.c_params();
-        j["body"] = {}; // process the body of a GateDecl;
-        gd.foreach_stmt([&j](Stmt& st) {
-            JSONOutputter jst;
-            st.accept(jst);
-            j["body"].push_back(jst.json_val());
-        });
-        json_.push_back(j);
+        begin_stmt();
+        writer_.key("body"); // process the body of a GateDecl;
+        if (gd.body().empty()) {
+            writer_.null();
+        } else {
+            writer_.begin_array();
+            gd.foreach_stmt([this](Stmt& st) { st.accept(*this); });
+            writer_.end_array();
+        }
+        writer_.key("c_params");
+        write_strings(gd.c_params());
+        writer_.key("name");
+        writer_.value(gd.id());
+        writer_.key("q_params");
+        write_strings(gd.q_params());
+        writer_.key("type");
+        writer_.value("GateDecl");
+        end_stmt();
     }
 
     void visit(Program& p) override {
-        using namespace qasmtools::ast;
-        p.foreach_stmt([&](Stmt& st) {
-            JSONOutputter jst;
-            st.accept(jst);
-            json_.push_back(jst.json_val());
-        });
+        if (p.body().empty()) {
+            writer_.null();
+            return;
+        }
+        writer_.begin_array();
+        p.foreach_stmt([this](Stmt& st) { st.accept(*this); });
+        writer_.end_array();
     }
 
-    json json_val() { return json_; }
+    /** \brief The output so far, if no output stream was given */
+    json json_val() const {
+        if (!buffer_ || buffer_->str().empty()) {
+            return {};
+        }
+        return json::parse(buffer_->str());
+    }
 
   private:
-    json json_;
+    std::unique_ptr<std::stringstream> buffer_;
+    JSONWriter writer_;
+
+    void begin_stmt() {
+        writer_.begin_array();
+        writer_.begin_object();
+    }
+
+    void end_stmt() {
+        writer_.end_object();
+        writer_.end_array();
+    }
+
+    void write_strings(const std::vector<std::string>& strs) {
+        writer_.begin_array();
+        for (auto& str : strs) {
+            writer_.value(str);
+        }
+        writer_.end_array();
+    }
 };
 
 } /* namespace output */
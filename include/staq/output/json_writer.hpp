@@ -0,0 +1,202 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file output/json_writer.hpp
+ * \brief Streaming JSON writer
+ */
+
+#ifndef OUTPUT_JSON_WRITER_HPP_
+#define OUTPUT_JSON_WRITER_HPP_
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace staq {
+namespace output {
+
+/**
+ * \class staq::output::JSONWriter
+ * \brief Writes JSON to a stream as it is produced
+ *
+ * The output is formatted exactly as nlohmann::json::dump would format the
+ * same document with the same indent, so outputters can stream documents too
+ * large to build in memory. As nlohmann::json sorts object keys, callers
+ * must give keys in sorted order for the output to match.
+ */
+class JSONWriter {
+  public:
+    /**
+     * \brief Writes to os
+     * \param indent Spaces per level of nesting, or -1 for compact output
+     */
+    explicit JSONWriter(std::ostream& os, int indent = -1)
+        : os_(os), indent_(indent) {}
+
+    void begin_object() { open('{'); }
+    void end_object() { close('}'); }
+    void begin_array() { open('['); }
+    void end_array() { close(']'); }
+
+    /** \brief Starts an object member, to be followed by its value */
+    void key(std::string_view k) {
+        next_item();
+        write_string(k);
+        if (indent_ >= 0) {
+            os_.write(": ", 2);
+        } else {
+            os_.put(':');
+        }
+        after_key_ = true;
+    }
+
+    void null() {
+        next_value();
+        os_.write("null", 4);
+    }
+
+    void value(bool b) {
+        next_value();
+        os_ << (b ? "true" : "false");
+    }
+
+    template <typename T>
+    std::enable_if_t<std::is_integral_v<T>> value(T n) {
+        next_value();
+        os_ << std::to_string(n);
+    }
+
+    void value(double d) {
+        next_value();
+        os_ << nlohmann::json(d).dump();
+    }
+
+    void value(std::string_view s) {
+        next_value();
+        write_string(s);
+    }
+    void value(const char* s) { value(std::string_view(s)); }
+
+  private:
+    std::ostream& os_;
+    int indent_;
+    std::vector<bool> empty_; // Whether each open container is still empty
+    bool after_key_ = false;
+
+    void open(char c) {
+        next_value();
+        os_.put(c);
+        empty_.push_back(true);
+    }
+
+    void close(char c) {
+        bool empty = empty_.back();
+        empty_.pop_back();
+        if (!empty) {
+            newline();
+        }
+        os_.put(c);
+    }
+
+    void next_value() {
+        if (after_key_) {
+            after_key_ = false;
+        } else {
+            next_item();
+        }
+    }
+
+    void next_item() {
+        if (empty_.empty()) {
+            return;
+        }
+        if (!empty_.back()) {
+            os_.put(',');
+        }
+        empty_.back() = false;
+        newline();
+    }
+
+    void newline() {
+        if (indent_ < 0) {
+            return;
+        }
+        os_.put('\n');
+        for (std::size_t i = 0; i < empty_.size() * indent_; i++) {
+            os_.put(' ');
+        }
+    }
+
+    void write_string(std::string_view s) {
+        os_.put('"');
+        for (char c : s) {
+            switch (c) {
+                case '"':
+                    os_.write("\\\"", 2);
+                    break;
+                case '\\':
+                    os_.write("\\\\", 2);
+                    break;
+                case '\b':
+                    os_.write("\\b", 2);
+                    break;
+                case '\f':
+                    os_.write("\\f", 2);
+                    break;
+                case '\n':
+                    os_.write("\\n", 2);
+                    break;
+                case '\r':
+                    os_.write("\\r", 2);
+                    break;
+                case '\t':
+                    os_.write("\\t", 2);
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buf[7];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x",
+                                      static_cast<unsigned char>(c));
+                        os_.write(buf, 6);
+                    } else {
+                        os_.put(c);
+                    }
+            }
+        }
+        os_.put('"');
+    }
+};
+
+} /* namespace output */
+} /* namespace staq */
+
+#endif /* OUTPUT_JSON_WRITER_HPP_ */
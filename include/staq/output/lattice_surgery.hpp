@@ -33,16 +33,23 @@
 #define OUTPUT_LATTICE_SURGERY_HPP_
 
 #include <algorithm>
-#include <complex>
-#include <map>
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <numeric>
+#include <optional>
 #include <set>
+#include <sstream>
 #include <typeinfo>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
 #include "qasmtools/ast/ast.hpp"
 #include "qasmtools/utils/angle.hpp"
 
+#include "staq/output/json_writer.hpp"
 #include "staq/transformations/desugar.hpp"
 #include "staq/transformations/inline.hpp"
 
@@ -63,23 +70,289 @@ static const std::set<std::string_view> ls_inline_overrides{
 enum class PauliOperator : char { I = 'I', X = 'X', Y = 'Y', Z = 'Z' };
 
 /**
- * \brief Anti-commute multiplication table
+ * \class staq::output::PauliString
+ * \brief Tensor product of Pauli operators, packed as X and Z bits
+ *
+ * Qubit i holds X^x Z^z up to phase, with x and z bit i of the two bit
+ * vectors, so I, X, Z and Y are 00, 10, 01 and 11. Commutation and products
+ * then work on 64 qubits at a time.
+ */
+class PauliString {
+    using word = std::uint64_t;
+    static constexpr int word_bits = 64;
+
+  public:
+    PauliString() = default;
+    explicit PauliString(int n)
+        : n_(n), x_((n + word_bits - 1) / word_bits),
+          z_((n + word_bits - 1) / word_bits) {}
+
+    int size() const { return n_; }
+
+    PauliOperator operator[](int i) const {
+        bool x = (x_[i / word_bits] >> (i % word_bits)) & 1;
+        bool z = (z_[i / word_bits] >> (i % word_bits)) & 1;
+        if (x) {
+            return z ? PauliOperator::Y : PauliOperator::X;
+        }
+        return z ? PauliOperator::Z : PauliOperator::I;
+    }
+
+    void set(int i, PauliOperator op) {
+        word bit = word{1} << (i % word_bits);
+        bool x = op == PauliOperator::X || op == PauliOperator::Y;
+        bool z = op == PauliOperator::Z || op == PauliOperator::Y;
+        word& xw = x_[i / word_bits];
+        word& zw = z_[i / word_bits];
+        xw = x ? xw | bit : xw & ~bit;
+        zw = z ? zw | bit : zw & ~bit;
+    }
+
+    /** \brief Indices of the qubits acted on non-trivially, in order */
+    std::vector<int> support() const {
+        std::vector<int> ret;
+        for (std::size_t w = 0; w < x_.size(); w++) {
+            word bits = x_[w] | z_[w];
+            for (int b = 0; bits != 0; b++, bits >>= 1) {
+                if (bits & 1) {
+                    ret.push_back(static_cast<int>(w) * word_bits + b);
+                }
+            }
+        }
+        return ret;
+    }
+
+    bool commutes_with(const PauliString& other) const {
+        if (n_ != other.n_) {
+            throw std::logic_error("Blocks must have same number of qubits");
+        }
+        word parity = 0;
+        for (std::size_t w = 0; w < x_.size(); w++) {
+            parity ^= (x_[w] & other.z_[w]) ^ (z_[w] & other.x_[w]);
+        }
+        return std::bitset<word_bits>(parity).count() % 2 == 0;
+    }
+
+    /**
+     * \brief Whether the operators commute on every qubit
+     *
+     * Applied to the or of several strings' bits, this shows that all of
+     * them commute with other, without checking each one.
+     */
+    bool commutes_qubitwise_with(const PauliString& other) const {
+        for (std::size_t w = 0; w < x_.size(); w++) {
+            if ((x_[w] & other.z_[w]) | (z_[w] & other.x_[w])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** \brief Ors in the X and Z bits of other */
+    PauliString& operator|=(const PauliString& other) {
+        for (std::size_t w = 0; w < x_.size(); w++) {
+            x_[w] |= other.x_[w];
+            z_[w] |= other.z_[w];
+        }
+        return *this;
+    }
+
+    /**
+     * \brief Replaces this by the product lhs * this
+     * \return The phase of the product, as a power of i
+     */
+    int left_multiply(const PauliString& lhs) {
+        // With P(x, z) = i^(x.z) X^x Z^z, the product P(x1, z1) P(x2, z2) is
+        // i^(x1.z1 + x2.z2 - x3.z3 + 2 z1.x2) P(x3, z3), x3 = x1 ^ x2 and
+        // z3 = z1 ^ z2
+        long power = 0;
+        for (std::size_t w = 0; w < x_.size(); w++) {
+            word x3 = lhs.x_[w] ^ x_[w];
+            word z3 = lhs.z_[w] ^ z_[w];
+            power += count(lhs.x_[w] & lhs.z_[w]) + count(x_[w] & z_[w]) -
+                     count(x3 & z3) + 2 * count(lhs.z_[w] & x_[w]);
+            x_[w] = x3;
+            z_[w] = z3;
+        }
+        return static_cast<int>(((power % 4) + 4) % 4);
+    }
+
+  private:
+    int n_ = 0;
+    std::vector<word> x_;
+    std::vector<word> z_;
+
+    static long count(word w) { return std::bitset<word_bits>(w).count(); }
+};
+
+/**
+ * \class staq::output::CliffordFrame
+ * \brief Conjugation by a Clifford, stored as the images of each X_i and Z_i
+ *
+ * Images are Hermitian Pauli strings with a sign, so conjugating a Pauli
+ * string costs one product per qubit it acts on, and composing with a pi/4
+ * or pi/2 rotation only updates the generators it anticommutes with.
+ */
+class CliffordFrame {
+  public:
+    explicit CliffordFrame(int n)
+        : x_images_(n, PauliString(n)), z_images_(n, PauliString(n)),
+          x_signs_(n, false), z_signs_(n, false) {
+        for (int i = 0; i < n; i++) {
+            x_images_[i].set(i, PauliOperator::X);
+            z_images_[i].set(i, PauliOperator::Z);
+        }
+    }
+
+    /**
+     * \brief Image of a Pauli string under the frame
+     * \return The image, and whether it picked up a minus sign
+     */
+    std::pair<PauliString, bool> conjugate(const PauliString& p) const {
+        PauliString ret(p.size());
+        long power = 0;
+        for (int i : p.support()) {
+            // Y = i X Z, so the image of Y_i is i F(X_i) F(Z_i)
+            PauliOperator op = p[i];
+            if (op == PauliOperator::Y) {
+                power += 1;
+            }
+            if (op != PauliOperator::X) {
+                power += ret.left_multiply(z_images_[i]) + 2 * z_signs_[i];
+            }
+            if (op != PauliOperator::Z) {
+                power += ret.left_multiply(x_images_[i]) + 2 * x_signs_[i];
+            }
+        }
+        return {std::move(ret), power % 4 == 2};
+    }
+
+    /**
+     * \brief Composes the frame with a rotation about c, applied first
+     *
+     * A Pauli P anticommuting with c becomes i c P under a pi/4 rotation and
+     * -P under a pi/2 rotation, and is unchanged otherwise.
+     */
+    void rotate(const PauliString& c, bool pi_over_4) {
+        auto [image, negative] = conjugate(c);
+        auto update = [&](PauliString& g, char& sign) {
+            if (!pi_over_4) {
+                sign = !sign;
+                return;
+            }
+            int power = g.left_multiply(image) + 1 + 2 * negative + 2 * sign;
+            sign = power % 4 == 2;
+        };
+        for (int i : c.support()) {
+            // X_i anticommutes with c when c has a Z or Y on qubit i, and Z_i
+            // when it has an X or Y
+            PauliOperator op = c[i];
+            if (op != PauliOperator::X) {
+                update(x_images_[i], x_signs_[i]);
+            }
+            if (op != PauliOperator::Z) {
+                update(z_images_[i], z_signs_[i]);
+            }
+        }
+    }
+
+  private:
+    std::vector<PauliString> x_images_;
+    std::vector<PauliString> z_images_;
+    std::vector<char> x_signs_; // Whether each image carries a minus sign
+    std::vector<char> z_signs_;
+};
+
+/**
+ * \class staq::output::PauliPhase
+ * \brief Angle of a Pauli rotation in units of pi, or a measurement
+ *
+ * PauliPhase(n) is a rotation by n pi/8. Rotations by other angles only keep
+ * the text they are printed with, as nothing else is done with them.
  */
-static const std::map<std::pair<PauliOperator, PauliOperator>,
-                      std::pair<std::complex<double>, PauliOperator>>
-    PauliOperator_anticommute_tbl{
-        {{PauliOperator::Z, PauliOperator::X},
-         {std::complex<double>(0, 1), PauliOperator::Y}},
-        {{PauliOperator::X, PauliOperator::Z},
-         {std::complex<double>(0, -1), PauliOperator::Y}},
-        {{PauliOperator::Y, PauliOperator::Z},
-         {std::complex<double>(0, 1), PauliOperator::X}},
-        {{PauliOperator::Z, PauliOperator::Y},
-         {std::complex<double>(0, -1), PauliOperator::X}},
-        {{PauliOperator::X, PauliOperator::Y},
-         {std::complex<double>(0, 1), PauliOperator::Z}},
-        {{PauliOperator::Y, PauliOperator::X},
-         {std::complex<double>(0, -1), PauliOperator::Z}}};
+class PauliPhase {
+  public:
+    enum class Kind : char { eighths, other, measurement };
+
+    PauliPhase() = default;
+    explicit PauliPhase(int eighths)
+        : negative_(eighths < 0), eighths_(std::abs(eighths)) {}
+
+    static PauliPhase measurement() {
+        PauliPhase ret;
+        ret.kind_ = Kind::measurement;
+        return ret;
+    }
+
+    static PauliPhase other(std::string text) {
+        PauliPhase ret;
+        ret.kind_ = Kind::other;
+        ret.text_ = std::move(text);
+        return ret;
+    }
+
+    Kind kind() const { return kind_; }
+    bool is_measurement() const { return kind_ == Kind::measurement; }
+    bool is_pi_over_8() const { return is_eighths(1); }
+    bool is_pi_over_4() const { return is_eighths(2); }
+    bool is_pi_over_2() const { return is_eighths(4); }
+    bool is_clifford() const { return is_pi_over_4() || is_pi_over_2(); }
+
+    void negate() {
+        if (kind_ != Kind::other) {
+            negative_ = !negative_;
+        } else if (!text_.empty() && text_.front() == '-') {
+            text_.erase(0, 1);
+        } else {
+            text_.insert(0, 1, '-');
+        }
+    }
+
+    /* Splits a rotation in [0, pi) into rotations by pi/2, pi/4 and pi/8 */
+    std::vector<PauliPhase> decompose() const {
+        if (kind_ != Kind::eighths || negative_) {
+            return {*this};
+        }
+        switch (eighths_) {
+            case 0:
+                return {}; // identity
+            case 3:
+                return {PauliPhase(2), PauliPhase(1)};
+            case 5:
+                return {PauliPhase(4), PauliPhase(1)};
+            case 6:
+                return {PauliPhase(4), PauliPhase(2)};
+            case 7:
+                return {PauliPhase(4), PauliPhase(2), PauliPhase(1)};
+            default:
+                return {*this}; // leave as-is
+        }
+    }
+
+    std::string str() const {
+        std::string sign = negative_ ? "-" : "";
+        if (kind_ == Kind::other) {
+            return text_;
+        } else if (kind_ == Kind::measurement) {
+            return sign + "M";
+        } else if (eighths_ == 0) {
+            return sign + "0/1";
+        }
+        int gcd = std::gcd(eighths_, 8);
+        return sign + std::to_string(eighths_ / gcd) + "/" +
+               std::to_string(8 / gcd);
+    }
+
+  private:
+    Kind kind_ = Kind::eighths;
+    bool negative_ = false;
+    int eighths_ = 0;
+    std::string text_; // Only for Kind::other
+
+    bool is_eighths(int n) const {
+        return kind_ == Kind::eighths && eighths_ == n;
+    }
+};
 
 class LayeredPauliOpCircuit;
 
@@ -91,7 +364,7 @@ class LayeredPauliOpCircuit;
  */
 class PauliOpCircuit {
   public:
-    using Op = std::pair<std::vector<PauliOperator>, std::string>;
+    using Op = std::pair<PauliString, PauliPhase>;
 
     explicit PauliOpCircuit(int no_of_qubit) : qubit_num_(no_of_qubit) {}
 
@@ -103,22 +376,29 @@ class PauliOpCircuit {
     }
 
     json to_json() const { // get circuit in json format
-        json result;
-        result["n"] = qubit_num_;
-        result["layers"];
-        for (auto& op : ops_) {
-            json layer;
-            for (int i = 0; i < qubit_num_; i++) {
-                auto op_name = static_cast<char>(op.first[i]);
-                if (op_name == 'I') {
-                    continue;
-                }
-                layer["q" + std::to_string(i)] = std::string(1, op_name);
+        std::stringstream ss;
+        JSONWriter writer(ss);
+        write_json(writer);
+        return json::parse(ss.str());
+    }
+
+    // write circuit in json format, as to_json() would
+    void write_json(JSONWriter& writer) const {
+        auto rank = qubit_key_ranks(qubit_num_);
+        writer.begin_object();
+        writer.key("layers");
+        if (ops_.empty()) {
+            writer.null();
+        } else {
+            writer.begin_array();
+            for (auto& op : ops_) {
+                write_block(writer, op, rank);
             }
-            layer["pi*"] = op.second;
-            result["layers"].push_back(std::move(layer));
+            writer.end_array();
         }
-        return result;
+        writer.key("n");
+        writer.value(qubit_num_);
+        writer.end_object();
     }
 
     // y-free equivalent circuit
@@ -131,75 +411,41 @@ class PauliOpCircuit {
         return ans;
     }
 
-    // TODO optimize this
-    // push pi/4 rotations to end of circuit
+    // push pi/4 and pi/2 rotations to end of circuit
     void litinski_transform() {
         decompose();
-        std::vector<std::list<Op>::iterator> pushed_rotations;
-        bool circuit_has_measurements = false;
-
-        for (auto it = ops_.begin(); it != ops_.end(); ++it) {
-            if (it->second == "M" || it->second == "-M") {
-                circuit_has_measurements = true;
-            } else if (it->second == "1/4" || it->second == "-1/4" ||
-                       it->second == "1/2" || it->second == "-1/2") {
-                pushed_rotations.push_back(it);
+        bool circuit_has_measurements =
+            std::any_of(ops_.begin(), ops_.end(), [](const Op& op) {
+                return op.second.is_measurement();
+            });
+
+        // Moving a rotation past the rest of the circuit conjugates every
+        // block after it, so each block ends up conjugated by all the
+        // rotations before it. The rotations themselves land at the end in
+        // reverse order, or are dropped if the circuit measures everything.
+        CliffordFrame frame(qubit_num_);
+        std::list<Op> result, pushed_rotations;
+        for (auto& op : ops_) {
+            auto [image, negative] = frame.conjugate(op.first);
+            Op block{std::move(image), op.second};
+            if (negative) {
+                block.second.negate();
             }
-        }
-
-        for (auto it = pushed_rotations.rbegin(); it != pushed_rotations.rend();
-             ++it) {
-            auto index = *it;
-            // TODO optimize this
-            while (index != ops_.end()) {
-                auto next_block = index;
-                ++next_block;
-                if (next_block == ops_.end()) {
-                    break;
+            if (op.second.is_clifford()) {
+                if (!circuit_has_measurements) {
+                    pushed_rotations.push_front(std::move(block));
                 }
-                swap_adjacent_blocks(index); // TODO optimize this
-                ++index;
-            }
-            if (circuit_has_measurements) {
-                ops_.pop_back();
+                frame.rotate(op.first, op.second.is_pi_over_4());
+            } else {
+                result.push_back(std::move(block));
             }
         }
+        result.splice(result.end(), pushed_rotations);
+        ops_.swap(result);
     }
 
     static bool are_commuting(const Op& block1, const Op& block2) {
-        if (block1.first.size() != block2.first.size()) {
-            throw std::logic_error("Blocks must have same number of qubits");
-        }
-        bool ret_val = true;
-        for (int i = 0; i < block1.first.size(); i++) {
-            if (!are_commuting(block1.first[i], block2.first[i])) {
-                ret_val = !ret_val;
-            }
-        }
-        return ret_val;
-    }
-
-    static bool are_commuting(PauliOperator a, PauliOperator b) {
-        if (PauliOperator_anticommute_tbl.find({a, b}) ==
-            PauliOperator_anticommute_tbl.end()) {
-            return true;
-        }
-        return false;
-    }
-
-    static std::pair<std::complex<double>, PauliOperator>
-    multiply_operators(PauliOperator a, PauliOperator b) {
-        auto it = PauliOperator_anticommute_tbl.find({a, b});
-        if (it != PauliOperator_anticommute_tbl.end()) {
-            return it->second;
-        }
-        if (a == b) {
-            return {1, PauliOperator::I};
-        }
-        if (a == PauliOperator::I || b == PauliOperator::I) {
-            return {1, a == PauliOperator::I ? b : a};
-        }
-        throw std::logic_error("Uncaught multiply case");
+        return block1.first.commutes_with(block2.first);
     }
 
     friend class LayeredPauliOpCircuit;
@@ -209,13 +455,44 @@ class PauliOpCircuit {
     std::list<Op> ops_;
 
   private:
+    // Position of each qubit's key "q<i>" in sorted order, as keys of JSON
+    // objects are written sorted
+    static std::vector<int> qubit_key_ranks(int n) {
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [](int a, int b) {
+            return std::to_string(a) < std::to_string(b);
+        });
+        std::vector<int> rank(n);
+        for (int i = 0; i < n; i++) {
+            rank[order[i]] = i;
+        }
+        return rank;
+    }
+
+    static void write_block(JSONWriter& writer, const Op& op,
+                            const std::vector<int>& rank) {
+        auto qubits = op.first.support();
+        std::sort(qubits.begin(), qubits.end(),
+                  [&rank](int a, int b) { return rank[a] < rank[b]; });
+        writer.begin_object();
+        writer.key("pi*");
+        writer.value(op.second.str());
+        for (int i : qubits) {
+            auto op_name = static_cast<char>(op.first[i]);
+            writer.key("q" + std::to_string(i));
+            writer.value(std::string_view(&op_name, 1));
+        }
+        writer.end_object();
+    }
+
     static std::list<Op> get_y_free_equivalent(const Op& block) {
         std::list<int> y_op_indices;
         Op y_free_block = block;
         for (int i = 0; i < block.first.size(); i++) {
             if (block.first[i] == PauliOperator::Y) {
                 y_op_indices.push_back(i);
-                y_free_block.first[i] = PauliOperator::X;
+                y_free_block.first.set(i, PauliOperator::X);
             }
         }
 
@@ -227,21 +504,19 @@ class PauliOpCircuit {
         if (y_op_indices.size() % 2 == 0) {
             int first_y_operator = y_op_indices.front();
             y_op_indices.pop_front();
-            std::vector<PauliOperator> new_rotation_ops(block.first.size(),
-                                                        PauliOperator::I);
-            new_rotation_ops[first_y_operator] = PauliOperator::Z;
-            left_rotations.emplace_back(new_rotation_ops, "1/4");
-            right_rotations.emplace_back(new_rotation_ops, "-1/4");
+            PauliString new_rotation_ops(block.first.size());
+            new_rotation_ops.set(first_y_operator, PauliOperator::Z);
+            left_rotations.emplace_back(new_rotation_ops, PauliPhase(2));
+            right_rotations.emplace_back(new_rotation_ops, PauliPhase(-2));
         }
 
-        std::vector<PauliOperator> new_rotation_ops(block.first.size(),
-                                                    PauliOperator::I);
+        PauliString new_rotation_ops(block.first.size());
         for (int i : y_op_indices) {
-            new_rotation_ops[i] = PauliOperator::Z;
+            new_rotation_ops.set(i, PauliOperator::Z);
         }
 
-        left_rotations.emplace_back(new_rotation_ops, "1/4");
-        right_rotations.emplace_back(new_rotation_ops, "-1/4");
+        left_rotations.emplace_back(new_rotation_ops, PauliPhase(2));
+        right_rotations.emplace_back(new_rotation_ops, PauliPhase(-2));
         // return left_rotations + [y_free_block] + right_rotations
         left_rotations.push_back(std::move(y_free_block));
         left_rotations.splice(left_rotations.end(), right_rotations);
@@ -269,40 +544,16 @@ class PauliOpCircuit {
         auto next_block = index;
         ++next_block;
 
-        if (index->second == "1/4" || index->second == "-1/4") {
-            std::complex<double> product_of_coefficients(1, 0);
-
-            for (int i = 0; i < qubit_num_; i++) {
-                auto [coeff, op] =
-                    multiply_operators(index->first[i], next_block->first[i]);
-                next_block->first[i] = op;
-                product_of_coefficients *= coeff;
-            }
-            product_of_coefficients *= std::complex<double>(0, 1);
-            if (next_block->second == "M" || next_block->second == "-M") {
-                if (product_of_coefficients.real() < 0) { // flip phase
-                    next_block->second = next_block->second == "M" ? "-M" : "M";
-                }
-            } else {
-                if (product_of_coefficients.real() < 0) { // flip phase
-                    if (next_block->second.front() == '-') {
-                        next_block->second = next_block->second.substr(1);
-                    } else {
-                        next_block->second = "-" + next_block->second;
-                    }
-                }
+        if (index->second.is_pi_over_4()) {
+            // Moving past a pi/4 rotation turns P2 into i P1 P2, which is
+            // -P1P2 exactly when P1 P2 carries a phase of i
+            int power = next_block->first.left_multiply(index->first) + 1;
+            if (power % 4 == 2) {
+                next_block->second.negate();
             }
             std::iter_swap(index, next_block);
-        } else if (index->second == "1/2" || index->second == "-1/2") {
-            if (next_block->second == "M" || next_block->second == "-M") {
-                next_block->second = next_block->second == "M" ? "-M" : "M";
-            } else {
-                if (next_block->second.front() == '-') {
-                    next_block->second = next_block->second.substr(1);
-                } else {
-                    next_block->second = "-" + next_block->second;
-                }
-            }
+        } else if (index->second.is_pi_over_2()) {
+            next_block->second.negate();
             std::iter_swap(index, next_block);
         } else {
             throw std::logic_error("Can only swap pi/2 or pi/4 rotations");
@@ -312,30 +563,12 @@ class PauliOpCircuit {
     void decompose() { // decompose into { pi/2, pi/4, pi/8 } wherever possible
         std::list<Op> result;
         for (const auto& op : ops_) {
-            for (const auto& p : decompose_phase(op.second)) {
+            for (const auto& p : op.second.decompose()) {
                 result.emplace_back(op.first, p);
             }
         }
         ops_.swap(result);
     }
-
-    static std::vector<std::string> decompose_phase(const std::string& phase) {
-        // since utils::Angle is in [0,2pi), Angle/2 will be in [0,pi)
-        // we care about pi times { 0/1, 1/8, 1/4, 3/8, 1/2, 5/8, 3/4, 7/8 }
-        if (phase == "0/1") {
-            return {}; // identity
-        } else if (phase == "3/8") {
-            return {"1/4", "1/8"};
-        } else if (phase == "5/8") {
-            return {"1/2", "1/8"};
-        } else if (phase == "3/4") {
-            return {"1/2", "1/4"};
-        } else if (phase == "7/8") {
-            return {"1/2", "1/4", "1/8"};
-        } else {
-            return {phase}; // leave as-is
-        }
-    }
 };
 
 /**
@@ -345,7 +578,7 @@ class PauliOpCircuit {
 class LayeredPauliOpCircuit {
     using Op = PauliOpCircuit::Op;
     int qubit_num_;
-    std::list<std::list<Op>> layers_;
+    std::vector<std::vector<Op>> layers_;
     std::list<Op> final_;
 
   public:
@@ -353,7 +586,7 @@ class LayeredPauliOpCircuit {
         : qubit_num_(c.qubit_num_) {
         bool expect_no_more_Ts = false; // pi/8 rotations come before all else
         for (auto const& op : c.ops_) {
-            if (op.second == "1/8" || op.second == "-1/8") {
+            if (op.second.is_pi_over_8()) {
                 if (expect_no_more_Ts) {
                     throw std::logic_error(
                         "pi/8 rotations must come before all "
@@ -361,101 +594,103 @@ class LayeredPauliOpCircuit {
                 } else {
                     layers_.push_back({op});
                 }
-            } else if (op.second == "1/4" || op.second == "-1/4" ||
-                       op.second == "1/2" || op.second == "-1/2" ||
-                       op.second == "M" || op.second == "-M") {
+            } else if (op.second.is_clifford() ||
+                       op.second.is_measurement()) {
                 expect_no_more_Ts = true;
                 final_.push_back(op);
             } else {
-                throw std::logic_error("Unsupported phase: " + op.second);
+                throw std::logic_error("Unsupported phase: " +
+                                       op.second.str());
             }
         }
     }
 
     // get circuit in json format, with T layers grouped
     json to_json() const {
-        json result;
-        result["n"] = qubit_num_;
+        std::stringstream ss;
+        JSONWriter writer(ss);
+        write_json(writer);
+        return json::parse(ss.str());
+    }
+
+    // write circuit in json format, as to_json() would
+    void write_json(JSONWriter& writer) const {
+        auto rank = PauliOpCircuit::qubit_key_ranks(qubit_num_);
         int t_count = 0;
         for (auto& layer : layers_) {
             t_count += layer.size();
         }
-        result["T count"] = t_count;
-        result["T depth"] = layers_.size();
-
-        result["T layers"];
-        for (auto& layer : layers_) {
-            json layer_json;
-            for (auto& op : layer) {
-                json op_json;
-                for (int i = 0; i < qubit_num_; i++) {
-                    auto op_name = static_cast<char>(op.first[i]);
-                    if (op_name == 'I') {
-                        continue;
-                    }
-                    op_json["q" + std::to_string(i)] = std::string(1, op_name);
+        writer.begin_object();
+        writer.key("T count");
+        writer.value(t_count);
+        writer.key("T depth");
+        writer.value(layers_.size());
+
+        writer.key("T layers");
+        if (layers_.empty()) {
+            writer.null();
+        } else {
+            writer.begin_array();
+            for (auto& layer : layers_) {
+                writer.begin_array();
+                for (auto& op : layer) {
+                    PauliOpCircuit::write_block(writer, op, rank);
                 }
-                op_json["pi*"] = op.second;
-                layer_json.push_back(std::move(op_json));
+                writer.end_array();
             }
-            result["T layers"].push_back(std::move(layer_json));
+            writer.end_array();
         }
 
-        result["pi/4 rotations and measurements"];
-        for (auto& op : final_) {
-            json op_json;
-            for (int i = 0; i < qubit_num_; i++) {
-                auto op_name = static_cast<char>(op.first[i]);
-                if (op_name == 'I') {
-                    continue;
-                }
-                op_json["q" + std::to_string(i)] = std::string(1, op_name);
+        writer.key("n");
+        writer.value(qubit_num_);
+
+        writer.key("pi/4 rotations and measurements");
+        if (final_.empty()) {
+            writer.null();
+        } else {
+            writer.begin_array();
+            for (auto& op : final_) {
+                PauliOpCircuit::write_block(writer, op, rank);
             }
-            op_json["pi*"] = op.second;
-            result["pi/4 rotations and measurements"].push_back(
-                std::move(op_json));
+            writer.end_array();
         }
-
-        return result;
+        writer.end_object();
     }
 
-    // TODO optimize this
     /* greedy algorithm from page 6 of https://arxiv.org/pdf/1808.02892.pdf */
     void reduce() {
-        bool changed = true;
-        while (changed) {
-            changed = false;
-            for (auto it = layers_.begin(); it != layers_.end();) {
-                auto next_it = it;
-                ++next_it;
-                if (next_it == layers_.end()) {
-                    break;
-                }
-                for (auto op = next_it->begin(); op != next_it->end();) {
-                    bool commutes = true;
-                    for (auto& op2 : *it) {
-                        if (!PauliOpCircuit::are_commuting(*op, op2)) {
-                            commutes = false;
-                            break;
-                        }
-                    }
-                    if (commutes) {
-                        auto next_op = op;
-                        ++next_op;
-                        it->splice(it->end(), *next_it, op);
-                        changed = true;
-                        op = next_op;
-                    } else {
-                        ++op;
-                    }
+        // Each rotation goes in the layer after the last one holding a
+        // rotation it does not commute with, which is where repeatedly
+        // merging it into the previous layer would leave it
+        std::vector<std::vector<Op>> layers;
+        std::vector<PauliString> masks; // X and Z bits of each layer, or-ed
+        for (auto& layer : layers_) {
+            for (auto& op : layer) {
+                std::size_t pos = layers.size();
+                while (pos > 0 && commutes_with_layer(op, layers[pos - 1],
+                                                      masks[pos - 1])) {
+                    --pos;
                 }
-                if (next_it->empty()) {
-                    layers_.erase(next_it);
-                } else {
-                    it = next_it;
+                if (pos == layers.size()) {
+                    layers.emplace_back();
+                    masks.emplace_back(qubit_num_);
                 }
+                masks[pos] |= op.first;
+                layers[pos].push_back(std::move(op));
             }
         }
+        layers_.swap(layers);
+    }
+
+  private:
+    static bool commutes_with_layer(const Op& op, const std::vector<Op>& layer,
+                                    const PauliString& mask) {
+        if (mask.commutes_qubitwise_with(op.first)) {
+            return true;
+        }
+        return std::all_of(layer.begin(), layer.end(), [&](const Op& other) {
+            return PauliOpCircuit::are_commuting(op, other);
+        });
     }
 };
 
@@ -491,7 +726,8 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
 
     // Statements
     void visit(ast::MeasureStmt& stmt) override {
-        add_layer({stmt.q_arg()}, {PauliOperator::Z}, "M");
+        add_layer({stmt.q_arg()}, {PauliOperator::Z},
+                  PauliPhase::measurement());
     }
 
     void visit(ast::ResetStmt& stmt) override {
@@ -508,9 +744,9 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
         auto phase1 = get_phase(gate.lambda());
         auto phase2 = get_phase(gate.theta());
         auto phase3 = get_phase(gate.phi());
-        add_layer(qargs, {PauliOperator::Z}, to_phase_string(phase1 / 2));
-        add_layer(qargs, {PauliOperator::Y}, to_phase_string(phase2 / 2));
-        add_layer(qargs, {PauliOperator::Z}, to_phase_string(phase3 / 2));
+        add_layer(qargs, {PauliOperator::Z}, to_phase(phase1 / 2));
+        add_layer(qargs, {PauliOperator::Y}, to_phase(phase2 / 2));
+        add_layer(qargs, {PauliOperator::Z}, to_phase(phase3 / 2));
     }
 
     void visit(ast::CNOTGate& gate) override {
@@ -518,9 +754,9 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
             return;
         }
         std::vector<ast::VarAccess> qargs{gate.ctrl(), gate.tgt()};
-        add_layer(qargs, {PauliOperator::Z, PauliOperator::X}, "1/4");
-        add_layer(qargs, {PauliOperator::Z, PauliOperator::I}, "-1/4");
-        add_layer(qargs, {PauliOperator::I, PauliOperator::X}, "-1/4");
+        add_layer(qargs, {PauliOperator::Z, PauliOperator::X}, PauliPhase(2));
+        add_layer(qargs, {PauliOperator::Z, PauliOperator::I}, PauliPhase(-2));
+        add_layer(qargs, {PauliOperator::I, PauliOperator::X}, PauliPhase(-2));
     }
 
     void visit(ast::BarrierGate&) override {}
@@ -533,93 +769,93 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
             auto phase4 = Angle(1, 2);
             auto phase5 = get_phase(gate.carg(1)) + Angle(3, 1);
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase1 / 2));
+                      to_phase(phase1 / 2));
             add_layer(gate.qargs(), {PauliOperator::X},
-                      to_phase_string(phase2 / 2));
+                      to_phase(phase2 / 2));
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase3 / 2));
+                      to_phase(phase3 / 2));
             add_layer(gate.qargs(), {PauliOperator::X},
-                      to_phase_string(phase4 / 2));
+                      to_phase(phase4 / 2));
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase5 / 2));
+                      to_phase(phase5 / 2));
         } else if (gate.name() == "u2") {
             auto phase1 = get_phase(gate.carg(1)) - Angle(1, 2);
             auto phase2 = Angle(1, 2);
             auto phase3 = get_phase(gate.carg(0)) + Angle(1, 2);
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase1 / 2));
+                      to_phase(phase1 / 2));
             add_layer(gate.qargs(), {PauliOperator::X},
-                      to_phase_string(phase2 / 2));
+                      to_phase(phase2 / 2));
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase3 / 2));
+                      to_phase(phase3 / 2));
         } else if (gate.name() == "u1" || gate.name() == "rz") {
             auto phase = get_phase(gate.carg(0));
             add_layer(gate.qargs(), {PauliOperator::Z},
-                      to_phase_string(phase / 2));
+                      to_phase(phase / 2));
         } else if (gate.name() == "cx") {
             if (!skip_clifford_) {
                 add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::X},
-                          "1/4");
+                          PauliPhase(2));
                 add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::I},
-                          "-1/4");
+                          PauliPhase(-2));
                 add_layer(gate.qargs(), {PauliOperator::I, PauliOperator::X},
-                          "-1/4");
+                          PauliPhase(-2));
             }
         } else if (gate.name() == "id" || gate.name() == "u0") {
         } else if (gate.name() == "x") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::X}, "1/2");
+                add_layer(gate.qargs(), {PauliOperator::X}, PauliPhase(4));
             }
         } else if (gate.name() == "y") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::Y}, "1/2");
+                add_layer(gate.qargs(), {PauliOperator::Y}, PauliPhase(4));
             }
         } else if (gate.name() == "z") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::Z}, "1/2");
+                add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(4));
             }
         } else if (gate.name() == "h") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::Z}, "1/4");
-                add_layer(gate.qargs(), {PauliOperator::X}, "1/4");
-                add_layer(gate.qargs(), {PauliOperator::Z}, "1/4");
+                add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(2));
+                add_layer(gate.qargs(), {PauliOperator::X}, PauliPhase(2));
+                add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(2));
             }
         } else if (gate.name() == "s") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::Z}, "1/4");
+                add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(2));
             }
         } else if (gate.name() == "sdg") {
             if (!skip_clifford_) {
-                add_layer(gate.qargs(), {PauliOperator::Z}, "-1/4");
+                add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(-2));
             }
         } else if (gate.name() == "t") {
-            add_layer(gate.qargs(), {PauliOperator::Z}, "1/8");
+            add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(1));
         } else if (gate.name() == "tdg") {
-            add_layer(gate.qargs(), {PauliOperator::Z}, "-1/8");
+            add_layer(gate.qargs(), {PauliOperator::Z}, PauliPhase(-1));
         } else if (gate.name() == "rx") {
             auto phase = get_phase(gate.carg(0));
             add_layer(gate.qargs(), {PauliOperator::X},
-                      to_phase_string(phase / 2));
+                      to_phase(phase / 2));
         } else if (gate.name() == "ry") {
             auto phase = get_phase(gate.carg(0));
             add_layer(gate.qargs(), {PauliOperator::Y},
-                      to_phase_string(phase / 2));
+                      to_phase(phase / 2));
         } else if (gate.name() == "cz") {
             if (!skip_clifford_) {
                 add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::Z},
-                          "1/4");
+                          PauliPhase(2));
                 add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::I},
-                          "-1/4");
+                          PauliPhase(-2));
                 add_layer(gate.qargs(), {PauliOperator::I, PauliOperator::Z},
-                          "-1/4");
+                          PauliPhase(-2));
             }
         } else if (gate.name() == "cy") {
             add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::Y},
-                      "1/4");
+                      PauliPhase(2));
             add_layer(gate.qargs(), {PauliOperator::Z, PauliOperator::I},
-                      "-1/4");
+                      PauliPhase(-2));
             add_layer(gate.qargs(), {PauliOperator::I, PauliOperator::Y},
-                      "-1/4");
+                      PauliPhase(-2));
         } else {
             throw std::logic_error("Unsupported gate name: " + gate.name());
         }
@@ -673,11 +909,10 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
 
     // TODO check this and remove I if possible
     void add_layer(const std::vector<ast::VarAccess>& vas,
-                   const std::vector<PauliOperator>& ops,
-                   const std::string& phase) {
-        std::vector<PauliOperator> layer(num_qubits_, PauliOperator::I);
+                   const std::vector<PauliOperator>& ops, PauliPhase phase) {
+        PauliString layer(num_qubits_);
         for (int i = 0; i < vas.size(); i++) {
-            layer[get_id(vas[i])] = ops[i];
+            layer.set(get_id(vas[i]), ops[i]);
         }
         circuit_.add_pauli_block({std::move(layer), phase});
     }
@@ -696,12 +931,16 @@ class PauliOpCircuitCompiler final : public ast::Visitor {
         throw std::logic_error("Could not evaluate expression");
     }
 
-    static std::string to_phase_string(const qasmtools::utils::Angle& ang) {
+    static PauliPhase to_phase(const qasmtools::utils::Angle& ang) {
         if (ang.is_symbolic()) {
             auto [a, b] = *ang.symbolic_value();
-            return std::to_string(a) + "/" + std::to_string(b);
+            if (8 % b == 0) {
+                return PauliPhase(a * (8 / b));
+            }
+            return PauliPhase::other(std::to_string(a) + "/" +
+                                     std::to_string(b));
         } else {
-            return std::to_string(ang.numeric_value());
+            return PauliPhase::other(std::to_string(ang.numeric_value()));
         }
     }
 };
@@ -717,35 +956,50 @@ void output_lattice_surgery(ast::Program& prog, bool skip_clifford = false,
     const std::string SECOND{"2. Circuit after the Litinski Transform"};
     const std::string THIRD{"3. T-layered circuit"};
 
-    json out;
-    out[FIRST];
+    // Everything that can fail runs before anything is written
     auto circuit = PauliOpCircuitCompiler(skip_clifford).run(prog);
-    out[FIRST] = circuit.to_json();
-
-    out[SECOND];
+    std::optional<PauliOpCircuit> transformed;
     if (!skip_clifford && !skip_litinski) {
-        circuit.litinski_transform();
-        out[SECOND] = circuit.to_json();
+        transformed = circuit;
+        transformed->litinski_transform();
     }
 
-    out[THIRD];
+    std::optional<LayeredPauliOpCircuit> layered;
     try {
         if (!skip_litinski || skip_clifford) {
-            LayeredPauliOpCircuit lcircuit(circuit);
+            layered.emplace(transformed ? *transformed : circuit);
             if (!skip_reduce) {
-                lcircuit.reduce();
+                layered->reduce();
             }
-            out[THIRD] = lcircuit.to_json();
         }
     } catch (std::logic_error& err) {
         std::string err_msg(err.what());
         if (err_msg.find("Unsupported phase: ") != std::string::npos) {
             std::cerr << "Warning: Circuit is not in Clifford + T\n";
+            layered.reset();
         } else {
             throw;
         }
     }
-    os << out.dump(2) << "\n";
+
+    JSONWriter writer(os, 2);
+    writer.begin_object();
+    writer.key(FIRST);
+    circuit.write_json(writer);
+    writer.key(SECOND);
+    if (transformed) {
+        transformed->write_json(writer);
+    } else {
+        writer.null();
+    }
+    writer.key(THIRD);
+    if (layered) {
+        layered->write_json(writer);
+    } else {
+        writer.null();
+    }
+    writer.end_object();
+    os << "\n";
 }
 
 /** \brief Compiles an AST into lattice surgery instructions to a given output
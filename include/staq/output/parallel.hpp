@@ -0,0 +1,103 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file output/parallel.hpp
+ * \brief Parallel formatting of program bodies for outputters
+ */
+
+#ifndef OUTPUT_PARALLEL_HPP_
+#define OUTPUT_PARALLEL_HPP_
+
+#include <typeinfo>
+#include <vector>
+
+#include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+namespace staq {
+namespace output {
+
+namespace ast = qasmtools::ast;
+
+/**
+ * \brief Visits the statements of a program body, in parallel where possible
+ *
+ * Declarations and if statements can change the state of an outputter, so
+ * they are visited in order by out itself. The runs of statements between
+ * them are formatted in chunks on several threads, each chunk by a copy
+ * Outputter(out, stream) of out, and written to os in order. Runs are
+ * flushed as soon as every thread has a full chunk, while the statements
+ * are still in cache.
+ *
+ * \param out Outputter writing to os
+ * \param os Output stream
+ * \param prog The program
+ * \param filter Whether to visit a statement
+ */
+template <typename Outputter, typename Filter>
+void visit_body(Outputter& out, std::ostream& os, ast::Program& prog,
+                Filter filter) {
+    namespace utils = qasmtools::utils;
+    const std::size_t batch =
+        utils::format_chunk_size * utils::format_threads();
+    std::vector<ast::Stmt*> run;
+    run.reserve(batch);
+    auto flush = [&]() {
+        auto format = [&out](std::ostream& chunk_os, auto first, auto last) {
+            Outputter chunk_out(out, chunk_os);
+            for (; first != last; ++first) {
+                (*first)->accept(chunk_out);
+            }
+        };
+        utils::write_in_chunks(os, run.begin(), run.end(), format);
+        run.clear();
+    };
+
+    prog.foreach_stmt([&](ast::Stmt& stmt) {
+        if (!filter(stmt)) {
+            return;
+        }
+        auto& type = typeid(stmt);
+        if (type == typeid(ast::GateDecl) || type == typeid(ast::OracleDecl) ||
+            type == typeid(ast::RegisterDecl) ||
+            type == typeid(ast::AncillaDecl) || type == typeid(ast::IfStmt)) {
+            flush();
+            stmt.accept(out);
+        } else {
+            run.push_back(&stmt);
+            if (run.size() == batch) {
+                flush();
+            }
+        }
+    });
+    flush();
+}
+
+} /* namespace output */
+} /* namespace staq */
+
+#endif /* OUTPUT_PARALLEL_HPP_ */
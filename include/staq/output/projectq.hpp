@@ -35,6 +35,9 @@
 #include <typeinfo>
 
 #include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+#include "staq/output/parallel.hpp"
 
 namespace staq {
 namespace output {
@@ -64,6 +67,11 @@ class ProjectQOutputter final : public ast::Visitor {
     ProjectQOutputter(std::ostream& os) : Visitor(), os_(os) {}
     ProjectQOutputter(std::ostream& os, const config& params)
         : Visitor(), os_(os), config_(params) {}
+    /** \brief Copy of other writing to os, to format chunks in parallel */
+    ProjectQOutputter(const ProjectQOutputter& other, std::ostream& os)
+        : Visitor(), os_(os), config_(other.config_), prefix_(other.prefix_),
+          eng_(other.eng_), ancillas_(other.ancillas_),
+          ambiguous_(other.ambiguous_), prefix_self_(other.prefix_self_) {}
     ~ProjectQOutputter() = default;
 
     void run(ast::Program& prog) {
@@ -119,7 +127,9 @@ class ProjectQOutputter final : public ast::Visitor {
 
     void visit(ast::IntExpr& expr) { os_ << expr.value(); }
 
-    void visit(ast::RealExpr& expr) { os_ << expr.value(); }
+    void visit(ast::RealExpr& expr) {
+        qasmtools::utils::write_double(os_, expr.value());
+    }
 
     void visit(ast::VarExpr& expr) {
         if (prefix_self_) {
@@ -412,10 +422,8 @@ class ProjectQOutputter final : public ast::Visitor {
         prefix_ = "    ";
 
         // Program body
-        prog.foreach_stmt([this](auto& stmt) {
-            if (typeid(stmt) != typeid(ast::GateDecl)) {
-                stmt.accept(*this);
-            }
+        visit_body(*this, os_, prog, [](auto& stmt) {
+            return typeid(stmt) != typeid(ast::GateDecl);
         });
 
         os_ << "\n";
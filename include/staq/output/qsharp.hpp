@@ -36,6 +36,9 @@
 #include <typeinfo>
 
 #include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+#include "staq/output/parallel.hpp"
 
 namespace staq {
 namespace output {
@@ -79,6 +82,10 @@ class QSharpOutputter final : public ast::Visitor {
     QSharpOutputter(std::ostream& os) : Visitor(), os_(os) {}
     QSharpOutputter(std::ostream& os, const config& params)
         : Visitor(), os_(os), config_(params) {}
+    /** \brief Copy of other writing to os, to format chunks in parallel */
+    QSharpOutputter(const QSharpOutputter& other, std::ostream& os)
+        : Visitor(), os_(os), config_(other.config_), prefix_(other.prefix_),
+          locals_(other.locals_), ambiguous_(other.ambiguous_) {}
     ~QSharpOutputter() = default;
 
     void run(ast::Program& prog) {
@@ -172,7 +179,7 @@ class QSharpOutputter final : public ast::Visitor {
     void visit(ast::RealExpr& expr) {
         auto tmp = expr.value();
 
-        os_ << tmp;
+        qasmtools::utils::write_double(os_, tmp);
         if (tmp - floor(tmp) == 0) {
             os_ << ".0";
         }
@@ -348,10 +355,8 @@ class QSharpOutputter final : public ast::Visitor {
         // Program body
         os_ << prefix_ << "operation " << config_.opname << "() : Unit {\n";
         prefix_ += "    ";
-        prog.foreach_stmt([this](auto& stmt) {
-            if (typeid(stmt) != typeid(ast::GateDecl)) {
-                stmt.accept(*this);
-            }
+        visit_body(*this, os_, prog, [](auto& stmt) {
+            return typeid(stmt) != typeid(ast::GateDecl);
         });
 
         // Reset all qubits
@@ -33,6 +33,9 @@
 #define OUTPUT_QUIL_HPP_
 
 #include "qasmtools/ast/ast.hpp"
+#include "qasmtools/utils/format.hpp"
+
+#include "staq/output/parallel.hpp"
 
 namespace staq {
 namespace output {
@@ -61,6 +64,12 @@ class QuilOutputter final : public ast::Visitor {
     QuilOutputter(std::ostream& os) : Visitor(), os_(os) {}
     QuilOutputter(std::ostream& os, const config& params)
         : Visitor(), os_(os), config_(params) {}
+    /** \brief Copy of other writing to os, to format chunks in parallel */
+    QuilOutputter(const QuilOutputter& other, std::ostream& os)
+        : Visitor(), os_(os), config_(other.config_),
+          circuit_local_(other.circuit_local_), ambiguous_(other.ambiguous_),
+          max_qbit_(other.max_qbit_), max_cbit_(other.max_cbit_),
+          globals_(other.globals_) {}
     ~QuilOutputter() = default;
 
     void run(ast::Program& prog) {
@@ -138,7 +147,9 @@ class QuilOutputter final : public ast::Visitor {
 
     void visit(ast::IntExpr& expr) { os_ << expr.value(); }
 
-    void visit(ast::RealExpr& expr) { os_ << expr.value(); }
+    void visit(ast::RealExpr& expr) {
+        qasmtools::utils::write_double(os_, expr.value());
+    }
 
     void visit(ast::VarExpr& expr) { os_ << "%" << expr.var(); }
 
@@ -335,7 +346,7 @@ class QuilOutputter final : public ast::Visitor {
         os_ << "    LABEL @end\n\n";
 
         // Program body
-        prog.foreach_stmt([this](auto& stmt) { stmt.accept(*this); });
+        visit_body(*this, os_, prog, [](auto&) { return true; });
     }
 
   private:
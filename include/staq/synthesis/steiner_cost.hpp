@@ -0,0 +1,416 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file synthesis/steiner_cost.hpp
+ * \brief CNOT cost of device constrained cnot-dihedral synthesis
+ */
+
+#ifndef SYNTHESIS_STEINER_COST_HPP_
+#define SYNTHESIS_STEINER_COST_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "staq/mapping/device.hpp"
+#include "staq/synthesis/cnot_dihedral.hpp"
+#include "staq/synthesis/linear_reversible.hpp"
+
+namespace staq {
+namespace synthesis {
+
+/**
+ * \class staq::synthesis::SteinerCost
+ * \brief Counts the CNOT gates produced by gray_steiner and steiner_gauss
+ *
+ * Runs the same algorithms as gray_steiner and steiner_gauss, but only
+ * counts CNOT gates rather than building them. Parities & the linear
+ * operator are stored as packed bit-vectors, partitions as ranges of an
+ * index array, and all buffers are reused between calls, so repeated
+ * evaluations (e.g. during layout optimization) allocate little beyond the
+ * Steiner trees themselves.
+ */
+class SteinerCost {
+  public:
+    /**
+     * \brief CNOT count of gray_steiner(f, A, d)
+     * \param f The phase terms
+     * \param A The overall linear transformation
+     * \param d The device
+     */
+    int gray_steiner(const std::list<phase_term>& f, const linear_op<bool>& A,
+                     mapping::Device& d) {
+        n_ = static_cast<int>(A.size());
+        words_ = (n_ + 63) / 64;
+        int ret = 0;
+
+        // Load the phase terms & linear operator
+        terms_ = static_cast<int>(f.size());
+        parities_.assign(static_cast<std::size_t>(terms_) * words_, 0);
+        alive_.assign(terms_, true);
+        order_.resize(terms_);
+        int t = 0;
+        for (auto& [vec, angle] : f) {
+            for (int i = 0; i < n_; i++) {
+                if (vec[i]) {
+                    set(parities_, t, i);
+                }
+            }
+            order_[t] = t;
+            t++;
+        }
+        load(A);
+
+        // Partitions
+        stack_.clear();
+        index_pool_.clear();
+        current_.assign(words_, 0);
+        for (int i = 0; i < n_; i++) {
+            set(current_, 0, i);
+        }
+        push(-1, 0, terms_);
+
+        while (!stack_.empty()) {
+            auto part = stack_.back();
+            std::copy(index_pool_.end() - words_, index_pool_.end(),
+                      current_.begin());
+            stack_.pop_back();
+            index_pool_.resize(index_pool_.size() - words_);
+
+            if (part.begin == part.end) {
+                continue;
+            } else if (part.end - part.begin == 1 && part.target != -1) {
+                // This case allows us to shortcut a lot of partitions
+                auto tgt = part.target;
+                auto term = order_[part.begin];
+                alive_[term] = false;
+
+                std::list<int> terminals;
+                for (int ctrl = 0; ctrl < n_; ctrl++) {
+                    if (ctrl != tgt && get(parities_, term, ctrl)) {
+                        terminals.push_back(ctrl);
+                    }
+                }
+
+                auto s_tree = d.steiner(terminals, tgt);
+
+                // Fill each steiner point with a one
+                for (auto& [parent, child] : s_tree) {
+                    if (!get(parities_, term, child)) {
+                        ret++;
+                        apply_cnot(child, parent);
+                    }
+                }
+
+                // Zero out each row except for the root
+                for (auto it = s_tree.rbegin(); it != s_tree.rend(); it++) {
+                    ret++;
+                    apply_cnot(it->second, it->first);
+                }
+            } else if (any(current_)) {
+                // Divide into the zeros and ones of some row
+                auto i = find_best_split(part);
+                auto mid = std::partition(
+                    order_.begin() + part.begin, order_.begin() + part.end,
+                    [this, i](int u) { return !get(parities_, u, i); });
+                auto split = static_cast<int>(mid - order_.begin());
+
+                // Remove i from the remaining indices
+                reset(current_, 0, i);
+
+                // Add the new partitions on the stack
+                push(part.target != -1 ? part.target : i, split, part.end);
+                push(part.target, part.begin, split);
+            } else {
+                // The previously partitioned rows have gotten mangled. Start
+                // again from scratch for this partition
+                for (int i = 0; i < n_; i++) {
+                    set(current_, 0, i);
+                }
+                push(part.target, part.begin, part.end);
+            }
+        }
+
+        return ret + count_steiner_gauss(d);
+    }
+
+    /**
+     * \brief CNOT count of steiner_gauss(A, d)
+     * \param A The linear transformation
+     * \param d The device
+     */
+    int steiner_gauss(const linear_op<bool>& A, mapping::Device& d) {
+        n_ = static_cast<int>(A.size());
+        words_ = (n_ + 63) / 64;
+        load(A);
+
+        return count_steiner_gauss(d);
+    }
+
+  private:
+    /** \brief A partition of the phase terms */
+    struct partition {
+        int target; ///< Target qubit, or -1 if none
+        int begin;  ///< Start of the partition in order_
+        int end;    ///< End of the partition in order_
+    };
+
+    int n_ = 0;     ///< Number of qubits
+    int words_ = 0; ///< Words per packed row
+    int terms_ = 0; ///< Number of phase terms
+
+    std::vector<std::uint64_t> parities_; ///< Packed parities of each term
+    std::vector<bool> alive_;             ///< Terms still on the stack
+    std::vector<int> order_;              ///< Terms, grouped by partition
+    std::vector<std::uint64_t> mat_;      ///< Packed rows of the operator
+
+    std::vector<partition> stack_;          ///< Partition stack
+    std::vector<std::uint64_t> index_pool_; ///< Remaining indices per frame
+    std::vector<std::uint64_t> current_;    ///< Indices of the current frame
+
+    std::vector<bool> above_diagonal_dep_;     ///< steiner_gauss scratch
+    std::vector<std::pair<int, int>> swap_;    ///< steiner_gauss scratch
+    std::vector<std::pair<int, int>> compute_; ///< steiner_gauss scratch
+
+    bool get(const std::vector<std::uint64_t>& bits, int row, int i) const {
+        return (bits[static_cast<std::size_t>(row) * words_ + i / 64] >>
+                (i % 64)) &
+               1;
+    }
+    void set(std::vector<std::uint64_t>& bits, int row, int i) {
+        bits[static_cast<std::size_t>(row) * words_ + i / 64] |=
+            std::uint64_t{1} << (i % 64);
+    }
+    void reset(std::vector<std::uint64_t>& bits, int row, int i) {
+        bits[static_cast<std::size_t>(row) * words_ + i / 64] &=
+            ~(std::uint64_t{1} << (i % 64));
+    }
+    void flip(std::vector<std::uint64_t>& bits, int row, int i) {
+        bits[static_cast<std::size_t>(row) * words_ + i / 64] ^=
+            std::uint64_t{1} << (i % 64);
+    }
+    bool any(const std::vector<std::uint64_t>& bits) const {
+        for (auto w : bits) {
+            if (w) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** \brief Row operation mat[tgt] ^= mat[ctrl] */
+    void xor_rows(int tgt, int ctrl) {
+        auto t = mat_.begin() + static_cast<std::size_t>(tgt) * words_;
+        auto c = mat_.begin() + static_cast<std::size_t>(ctrl) * words_;
+        for (int w = 0; w < words_; w++) {
+            t[w] ^= c[w];
+        }
+    }
+
+    void load(const linear_op<bool>& A) {
+        mat_.assign(static_cast<std::size_t>(n_) * words_, 0);
+        for (int i = 0; i < n_; i++) {
+            for (int j = 0; j < n_; j++) {
+                if (A[i][j]) {
+                    set(mat_, i, j);
+                }
+            }
+        }
+    }
+
+    void push(int target, int begin, int end) {
+        stack_.push_back({target, begin, end});
+        index_pool_.insert(index_pool_.end(), current_.begin(),
+                           current_.end());
+    }
+
+    /** \brief Adjusts the remaining terms & operator for a CNOT */
+    void apply_cnot(int ctrl, int tgt) {
+        for (int u = 0; u < terms_; u++) {
+            if (alive_[u] && get(parities_, u, tgt)) {
+                flip(parities_, u, ctrl);
+            }
+        }
+        for (int i = 0; i < n_; i++) {
+            if (get(mat_, i, tgt)) {
+                flip(mat_, i, ctrl);
+            }
+        }
+    }
+
+    /** \brief As synthesis::find_best_split, over the current indices */
+    int find_best_split(const partition& part) const {
+        int max = -1;
+        int max_i = -1;
+        for (int i = 0; i < n_; i++) {
+            if (!get(current_, 0, i)) {
+                continue;
+            }
+
+            auto num_ones = 0;
+            for (auto k = part.begin; k < part.end; k++) {
+                num_ones += get(parities_, order_[k], i);
+            }
+            auto num_zeros = part.end - part.begin - num_ones;
+
+            if (max_i == -1 || num_zeros > max || num_ones > max) {
+                max = num_zeros > num_ones ? num_zeros : num_ones;
+                max_i = i;
+            }
+        }
+
+        return max_i;
+    }
+
+    /** \brief As synthesis::steiner_gauss, on the loaded operator */
+    int count_steiner_gauss(mapping::Device& d) {
+        int ret = 0;
+        above_diagonal_dep_.assign(n_, false);
+
+        for (int i = 0; i < n_; i++) {
+            std::fill(above_diagonal_dep_.begin(), above_diagonal_dep_.end(),
+                      false);
+
+            // Phase 0: Find a pivot
+            int pivot = -1;
+            int dist;
+            for (int j = i; j < n_; j++) {
+                if (get(mat_, j, i)) {
+                    if (pivot == -1 || d.distance(j, i) < dist) {
+                        pivot = j;
+                        dist = d.distance(j, i);
+                    }
+                }
+            }
+            if (pivot == -1) {
+                return ret;
+            }
+
+            swap_.clear();
+            bool crossed_diag = false;
+            auto path = d.shortest_path(pivot, i);
+            int ctrl = pivot;
+
+            // Phase 1: Fill 1's in column i along shortest path to row i
+            for (auto tgt : path) {
+                if (tgt != ctrl && !get(mat_, tgt, i)) {
+                    xor_rows(tgt, ctrl);
+                    swap_.emplace_back(ctrl, tgt);
+                    if (ctrl < i) {
+                        crossed_diag = true;
+                    }
+                    above_diagonal_dep_[tgt] = above_diagonal_dep_[tgt] ||
+                                               above_diagonal_dep_[ctrl] ||
+                                               (ctrl < i);
+                }
+
+                ctrl = tgt;
+            }
+
+            // Phase 2: If the path crossed the diagonal, corrections needed
+            if (crossed_diag) {
+                auto tgt = i;
+                for (auto it = std::next(path.rbegin()); it != path.rend();
+                     it++) {
+                    auto ctrl = *it;
+                    if (tgt != i) {
+                        xor_rows(tgt, ctrl);
+                        swap_.emplace_back(ctrl, tgt);
+                        above_diagonal_dep_[tgt] = above_diagonal_dep_[tgt] ||
+                                                   above_diagonal_dep_[ctrl] ||
+                                                   (ctrl < i);
+                    }
+                    tgt = ctrl;
+                }
+
+                for (auto it = swap_.rbegin(); it != swap_.rend(); it++) {
+                    if (above_diagonal_dep_[it->second] &&
+                        it->first != pivot) {
+                        xor_rows(it->second, it->first);
+                        ret++;
+                    }
+                }
+            }
+            ret += static_cast<int>(swap_.size());
+
+            // Our pivot is now necessarily row i
+            pivot = i;
+            std::fill(above_diagonal_dep_.begin(), above_diagonal_dep_.end(),
+                      false);
+
+            // Phase 3: Compute steiner tree covering the 1's in column i
+            std::list<int> pivots;
+            for (int j = 0; j < n_; j++) {
+                if (j != i && get(mat_, j, i)) {
+                    pivots.push_back(j);
+                }
+            }
+            auto s_tree = d.steiner(pivots, pivot);
+
+            // Phase 4: Propagate 1's to column i for each Steiner point
+            compute_.clear();
+            for (auto& [ctrl, tgt] : s_tree) {
+                if (!get(mat_, tgt, i)) {
+                    xor_rows(tgt, ctrl);
+                    compute_.emplace_back(ctrl, tgt);
+                    above_diagonal_dep_[tgt] = above_diagonal_dep_[tgt] ||
+                                               above_diagonal_dep_[ctrl] ||
+                                               (ctrl < pivot);
+                }
+            }
+
+            // Phase 5: Empty all 1's from column i in the Steiner tree
+            for (auto it = s_tree.rbegin(); it != s_tree.rend(); it++) {
+                xor_rows(it->second, it->first);
+                compute_.emplace_back(it->first, it->second);
+                above_diagonal_dep_[it->second] =
+                    above_diagonal_dep_[it->second] ||
+                    above_diagonal_dep_[it->first] || (it->first < pivot);
+            }
+
+            // Phase 6: Undo additions with above diagonal dependencies
+            for (auto it = compute_.rbegin(); it != compute_.rend(); it++) {
+                if (above_diagonal_dep_[it->second] && it->first != pivot) {
+                    xor_rows(it->second, it->first);
+                    ret++;
+                }
+            }
+            ret += static_cast<int>(compute_.size());
+        }
+
+        return ret;
+    }
+};
+
+} /* namespace synthesis */
+} /* namespace staq */
+
+#endif /* SYNTHESIS_STEINER_COST_HPP_ */
@@ -0,0 +1,777 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file tools/profiler.hpp
+ * \brief Circuit profiling
+ */
+
+#ifndef TOOLS_PROFILER_HPP_
+#define TOOLS_PROFILER_HPP_
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "qasmtools/ast/ast.hpp"
+
+#include "staq/output/json_writer.hpp"
+
+namespace staq {
+namespace tools {
+
+namespace ast = qasmtools::ast;
+
+/** \brief Profile of a circuit */
+struct circuit_profile {
+    int qubits = 0;
+    int cbits = 0;
+    std::map<std::string, int> counts{}; ///< Gates by name
+    std::map<std::string, int> depths{}; ///< Depth of each gate class
+    std::vector<int> parallelism{};      ///< Gates in each layer
+    std::vector<std::pair<std::string, int>> idle{}; ///< Idle layers by qubit
+    std::vector<std::string> critical_path{}; ///< Statements on a longest path
+};
+
+/**
+ * \class staq::tools::Profiler
+ * \brief Computes gate counts, class depths, layer parallelism, per-qubit
+ *        idle time and a critical path in a single pass
+ *
+ * Besides the overall depth, the depth of every configured gate class is
+ * computed, e.g. the T-depth counts only the t and tdg gates on a path, as
+ * is the depth of the gates acting on two or more qubits. Layers are those of
+ * the as-soon-as-possible schedule.
+ *
+ * Depths compose in the (max, +) algebra, so each gate declaration is
+ * summarized once by the length of the longest path between each of its
+ * inputs and outputs, together with the offset of each of its gates from
+ * its inputs. Applying a declared gate combines the arrival times of its
+ * arguments with its summary, which gives the same result as profiling the
+ * inlined circuit without copying its body.
+ */
+class Profiler final : public ast::Visitor {
+  public:
+    struct config {
+        /// Gate classes by the name of their depth
+        std::map<std::string, std::set<std::string>> classes{
+            {"cnot_depth", {"CX", "cx"}}, {"t_depth", {"t", "tdg"}}};
+        bool unbox = true;
+        std::set<std::string_view> overrides = ast::qelib_defs;
+    };
+
+    Profiler() = default;
+    Profiler(const config& params) : Visitor(), config_(params) {}
+    ~Profiler() = default;
+
+    circuit_profile run(ast::Program& prog) {
+        reset();
+
+        prog.accept(*this);
+
+        circuit_profile ret;
+        ret.qubits = qubits_;
+        ret.cbits = cbits_;
+        ret.counts.insert(top_.counts.begin(), top_.counts.end());
+
+        // Depths, and the wire on which the longest path ends
+        std::size_t end = 0;
+        for (std::size_t m = 0; m < num_metrics_; m++) {
+            int depth = 0;
+            for (std::size_t w = 0; w < top_.busy.size(); w++) {
+                int length = top_.arrival[w * num_metrics_ + m];
+                if (length > depth) {
+                    depth = length;
+                    if (m == 0) {
+                        end = w;
+                    }
+                }
+            }
+            ret.depths[metric_name(m)] = depth;
+        }
+        int depth = ret.depths["depth"];
+
+        ret.parallelism = layers_;
+        for (auto& [id, first, size] : quantum_registers_) {
+            for (int i = 0; i < size; i++) {
+                ret.idle.emplace_back(id + "[" + std::to_string(i) + "]",
+                                      depth - top_.busy[first + i]);
+            }
+        }
+
+        if (!top_.busy.empty()) {
+            for (auto ref = last_[end]; ref.node >= 0;) {
+                auto& n = nodes_[ref.node];
+                std::stringstream ss;
+                n.stmt->pretty_print(ss);
+                auto text = ss.str();
+                if (!text.empty() && text.back() == '\n') {
+                    text.pop_back();
+                }
+                ret.critical_path.push_back(std::move(text));
+                ref = preds_[n.preds + (n.num_preds > 1 ? ref.pos : 0)];
+            }
+            std::reverse(ret.critical_path.begin(), ret.critical_path.end());
+        }
+
+        return ret;
+    }
+
+    /* Variables */
+    void visit(ast::VarAccess&) {}
+
+    /* Expressions */
+    void visit(ast::BExpr&) {}
+    void visit(ast::UExpr&) {}
+    void visit(ast::PiExpr&) {}
+    void visit(ast::IntExpr&) {}
+    void visit(ast::RealExpr&) {}
+    void visit(ast::VarExpr&) {}
+
+    /* Statements */
+    void visit(ast::MeasureStmt& stmt) {
+        gather(stmt.q_arg());
+        gather(stmt.c_arg());
+        auto& info = info_for("measure", 1);
+        foreach_instance([this, &info](auto& wires) {
+            apply_gate(wires, info.weights.data(), "measure");
+        });
+    }
+    void visit(ast::ResetStmt& stmt) {
+        gather(stmt.arg());
+        auto& info = info_for("reset", 1);
+        foreach_instance([this, &info](auto& wires) {
+            apply_gate(wires, info.weights.data(), "reset");
+        });
+    }
+    void visit(ast::IfStmt& stmt) {
+        resolve(stmt.var(), std::nullopt, cond_);
+        stmt.then().accept(*this);
+        cond_.clear();
+    }
+
+    /* Gates */
+    void visit(ast::UGate& gate) {
+        gather(gate.arg());
+        auto& info = info_for("U", 1);
+        foreach_instance([this, &info](auto& wires) {
+            apply_gate(wires, info.weights.data(), "U");
+        });
+    }
+    void visit(ast::CNOTGate& gate) {
+        gather(gate.ctrl());
+        gather(gate.tgt());
+        auto& info = info_for("CX", 2);
+        foreach_instance([this, &info](auto& wires) {
+            apply_gate(wires, info.weights.data(), "CX");
+        });
+    }
+    void visit(ast::BarrierGate& gate) {
+        for (auto& arg : gate.args()) {
+            gather(arg);
+        }
+        // Barriers order all their arguments, without taking any time
+        zero_weights_.assign(num_metrics_, 0);
+        apply_gate(flat_, zero_weights_.data(), {});
+        flat_.clear();
+        spans_.clear();
+    }
+    void visit(ast::DeclaredGate& gate) {
+        for (auto& arg : gate.qargs()) {
+            gather(arg);
+        }
+        auto& info = info_for(gate.name(), gate.num_qargs());
+        foreach_instance([this, &info, &gate](auto& wires) {
+            if (info.summary) {
+                apply_summary(*info.summary, wires);
+            } else {
+                apply_gate(wires, info.weights.data(), gate.name());
+            }
+        });
+    }
+
+    /* Declarations */
+    void visit(ast::GateDecl& decl) {
+        if (decl.is_opaque() || !config_.unbox ||
+            config_.overrides.find(decl.id()) != config_.overrides.end()) {
+            return;
+        }
+
+        // Profile the body with one arrival time per parameter, plus the
+        // constant time at which the gate starts
+        std::size_t arity = decl.q_params().size();
+        scope local;
+        local.dim = arity + 1;
+        for (auto& param : decl.q_params()) {
+            add_register(local, param, 1);
+        }
+        for (std::size_t p = 0; p < arity; p++) {
+            for (std::size_t m = 0; m < num_metrics_; m++) {
+                int* a = &local.arrival[(p * num_metrics_ + m) * local.dim];
+                a[p] = 0;
+                a[arity] = none;
+            }
+        }
+
+        auto* outer = cur_;
+        cur_ = &local;
+        decl.foreach_stmt([this](auto& stmt) { stmt.accept(*this); });
+        cur_ = outer;
+
+        auto& summary = summaries_[decl.id()];
+        summary.arity = arity;
+        summary.paths.resize(num_metrics_ * local.dim * arity);
+        for (std::size_t m = 0; m < num_metrics_; m++) {
+            for (std::size_t i = 0; i < local.dim; i++) {
+                for (std::size_t j = 0; j < arity; j++) {
+                    summary.paths[(m * local.dim + i) * arity + j] =
+                        local.arrival[(j * num_metrics_ + m) * local.dim + i];
+                }
+            }
+        }
+        summary.busy.assign(local.busy.begin(), local.busy.begin() + arity);
+        summary.counts.assign(local.counts.begin(), local.counts.end());
+        summary.starts = std::move(local.starts);
+        infos_.erase(decl.id());
+    }
+    void visit(ast::OracleDecl&) {}
+    void visit(ast::RegisterDecl& decl) {
+        if (decl.is_quantum()) {
+            qubits_ += decl.size();
+            quantum_registers_.emplace_back(decl.id(), cur_->busy.size(),
+                                            decl.size());
+        } else {
+            cbits_ += decl.size();
+        }
+        add_register(*cur_, decl.id(), decl.size());
+    }
+    void visit(ast::AncillaDecl& decl) {
+        if (cur_ == &top_) {
+            qubits_ += decl.size();
+            quantum_registers_.emplace_back(decl.id(), cur_->busy.size(),
+                                            decl.size());
+        }
+        add_register(*cur_, decl.id(), decl.size());
+    }
+
+    /* Program */
+    void visit(ast::Program& prog) {
+        prog.foreach_stmt([this](auto& stmt) {
+            stmt_ = &stmt;
+            stmt.accept(*this);
+        });
+    }
+
+  private:
+    /// Arrival time of a wire not reachable from a given input
+    static constexpr int none = std::numeric_limits<int>::min() / 4;
+
+    /**
+     * \brief Arrival times and usage of the wires of a circuit
+     *
+     * Each wire has, for each metric, dim arrival times: one per parameter
+     * of the enclosing gate declaration, giving the longest path from that
+     * parameter, and last the longest path from the start of the gate. At
+     * the top level there are no parameters, so dim is 1.
+     */
+    struct scope {
+        std::size_t dim = 1;
+        std::vector<int> arrival{}; ///< By wire, then metric, then input
+        std::vector<int> busy{};    ///< Gates applied to each wire
+        std::unordered_map<std::string, std::pair<std::size_t, int>>
+            registers{};
+        std::unordered_map<ast::VarAccess, std::size_t> undeclared{};
+        std::unordered_map<std::string, int> counts{};
+        /// Start times of the gates of a declaration, dim per gate
+        std::vector<int> starts{};
+    };
+
+    /** \brief Summary of a gate declaration */
+    struct gate_summary {
+        std::size_t arity = 0;
+        /// Longest paths by metric, then input (the start last), then output
+        std::vector<int> paths{};
+        std::vector<int> busy{};
+        std::vector<std::pair<std::string, int>> counts{};
+        /// Offsets of the gates from each input (the start last)
+        std::vector<int> starts{};
+    };
+
+    /** \brief Weights in each metric, or the summary, of a gate */
+    struct gate_info {
+        std::vector<int> weights{};
+        const gate_summary* summary = nullptr;
+    };
+
+    /** \brief Output pos of the gate, or barrier, setting a wire */
+    struct arrival_ref {
+        int node;
+        std::size_t pos;
+    };
+
+    /** \brief A gate at the top level, with its predecessor on each output */
+    struct node {
+        const ast::Stmt* stmt;
+        std::size_t preds;
+        std::size_t num_preds;
+    };
+
+    config config_;
+    std::size_t num_metrics_ = 2;
+    std::unordered_map<std::string, gate_summary> summaries_;
+    std::unordered_map<std::string, gate_info> infos_;
+
+    scope top_;
+    scope* cur_ = &top_;
+    int qubits_ = 0;
+    int cbits_ = 0;
+    std::vector<std::tuple<std::string, std::size_t, int>> quantum_registers_;
+    std::vector<int> layers_;
+    std::vector<node> nodes_;
+    std::vector<arrival_ref> preds_;
+    std::vector<arrival_ref> last_; ///< By wire, at the top level
+    const ast::Stmt* stmt_ = nullptr;
+
+    // Scratch space
+    std::vector<std::size_t> flat_;
+    std::vector<std::pair<std::size_t, std::size_t>> spans_;
+    std::vector<std::size_t> wires_;
+    std::vector<std::size_t> cond_;
+    std::vector<int> in_;
+    std::vector<int> out_;
+    std::vector<int> zero_weights_;
+    std::vector<arrival_ref> in_refs_;
+    std::vector<arrival_ref> out_refs_;
+
+    void reset() {
+        num_metrics_ = 2 + config_.classes.size();
+        summaries_.clear();
+        infos_.clear();
+        top_ = scope();
+        cur_ = &top_;
+        qubits_ = 0;
+        cbits_ = 0;
+        quantum_registers_.clear();
+        layers_.clear();
+        nodes_.clear();
+        preds_.clear();
+        last_.clear();
+        stmt_ = nullptr;
+    }
+
+    std::string metric_name(std::size_t m) {
+        if (m == 0) {
+            return "depth";
+        } else if (m == 1) {
+            return "two_qubit_depth";
+        }
+        return std::next(config_.classes.begin(), m - 2)->first;
+    }
+
+    const gate_info& info_for(const std::string& name, int num_qubits) {
+        auto [it, inserted] = infos_.try_emplace(name);
+        auto& info = it->second;
+        if (inserted) {
+            info.weights.reserve(num_metrics_);
+            info.weights.push_back(1);
+            info.weights.push_back(num_qubits >= 2 ? 1 : 0);
+            for (auto& [id, gates] : config_.classes) {
+                info.weights.push_back(gates.find(name) != gates.end());
+            }
+            auto summary = summaries_.find(name);
+            if (summary != summaries_.end()) {
+                info.summary = &summary->second;
+            }
+        }
+        return info;
+    }
+
+    void add_register(scope& s, const std::string& id, int size) {
+        std::size_t first = s.busy.size();
+        s.registers[id] = {first, size};
+        add_wires(s, size);
+    }
+
+    /** \brief Adds wires available from the start */
+    void add_wires(scope& s, std::size_t num) {
+        for (std::size_t k = 0; k < num * num_metrics_; k++) {
+            s.arrival.insert(s.arrival.end(), s.dim - 1, none);
+            s.arrival.push_back(0);
+        }
+        s.busy.resize(s.busy.size() + num);
+        if (&s == &top_) {
+            last_.resize(s.busy.size(), {-1, 0});
+        }
+    }
+
+    /** \brief Appends the wires of a (possibly whole register) access */
+    void resolve(const std::string& var, std::optional<int> offset,
+                 std::vector<std::size_t>& out) {
+        auto& s = *cur_;
+        auto it = s.registers.find(var);
+        if (it != s.registers.end()) {
+            auto [first, size] = it->second;
+            if (!offset) {
+                for (int i = 0; i < size; i++) {
+                    out.push_back(first + i);
+                }
+                return;
+            } else if (*offset >= 0 && *offset < size) {
+                out.push_back(first + *offset);
+                return;
+            }
+        }
+
+        ast::VarAccess va(qasmtools::parser::Position(), var, offset);
+        auto [pos, inserted] = s.undeclared.try_emplace(va, s.busy.size());
+        if (inserted) {
+            add_wires(s, 1);
+        }
+        out.push_back(pos->second);
+    }
+
+    void gather(const ast::VarAccess& va) {
+        std::size_t first = flat_.size();
+        resolve(va.var(), va.offset(), flat_);
+        spans_.emplace_back(first, flat_.size() - first);
+    }
+
+    /**
+     * \brief Calls f on the wires of each gate the gathered arguments
+     *        stand for, as gates applied to registers act on each index
+     */
+    template <typename F>
+    void foreach_instance(F&& f) {
+        std::size_t num = 1;
+        for (auto [first, size] : spans_) {
+            if (size != 1) {
+                num = size;
+            }
+        }
+        for (std::size_t i = 0; i < num; i++) {
+            wires_.clear();
+            for (auto [first, size] : spans_) {
+                wires_.push_back(flat_[first + (size == 1 ? 0 : i)]);
+            }
+            f(wires_);
+        }
+        flat_.clear();
+        spans_.clear();
+    }
+
+    /** \brief Joins the arrival times of a wire into in_ */
+    void join(std::size_t wire) {
+        auto stride = num_metrics_ * cur_->dim;
+        const int* a = &cur_->arrival[wire * stride];
+        for (std::size_t k = 0; k < stride; k++) {
+            in_[k] = std::max(in_[k], a[k]);
+        }
+    }
+
+    /** \brief The reference of a wire arriving at time t, if any */
+    arrival_ref ref_at(std::size_t wire, int t) {
+        return t > 0 && top_.arrival[wire * num_metrics_] == t
+                   ? last_[wire]
+                   : arrival_ref{-1, 0};
+    }
+
+    /**
+     * \brief Applies a gate taking weights[m] time in each metric m, after
+     *        the bits of the enclosing condition, if any
+     *
+     * An empty name marks a barrier, which is neither counted nor scheduled.
+     */
+    void apply_gate(const std::vector<std::size_t>& wires, const int* weights,
+                    std::string_view name) {
+        auto& s = *cur_;
+        auto dim = s.dim;
+        auto stride = num_metrics_ * dim;
+        bool counted = !name.empty();
+
+        in_.assign(stride, none);
+        for (auto wire : wires) {
+            join(wire);
+        }
+        for (auto wire : cond_) {
+            join(wire);
+        }
+
+        // Which gate the longest path through this one comes from
+        arrival_ref pred{-1, 0};
+        if (&s == &top_) {
+            for (auto wire : wires) {
+                if (pred.node < 0) {
+                    pred = ref_at(wire, in_[0]);
+                }
+            }
+            for (auto wire : cond_) {
+                if (pred.node < 0) {
+                    pred = ref_at(wire, in_[0]);
+                }
+            }
+        }
+
+        arrival_ref self = pred;
+        if (counted) {
+            ++s.counts[std::string(name)];
+            if (&s == &top_) {
+                auto layer = static_cast<std::size_t>(in_[0]);
+                if (layer >= layers_.size()) {
+                    layers_.resize(layer + 1);
+                }
+                ++layers_[layer];
+
+                self = {static_cast<int>(nodes_.size()), 0};
+                nodes_.push_back({stmt_, preds_.size(), 1});
+                preds_.push_back(pred);
+            } else {
+                s.starts.insert(s.starts.end(), in_.begin(),
+                                in_.begin() + dim);
+            }
+        }
+
+        for (auto wire : wires) {
+            int* a = &s.arrival[wire * stride];
+            for (std::size_t m = 0; m < num_metrics_; m++) {
+                for (std::size_t i = 0; i < dim; i++) {
+                    int t = in_[m * dim + i];
+                    a[m * dim + i] = t == none ? none : t + weights[m];
+                }
+            }
+            if (counted) {
+                ++s.busy[wire];
+            }
+            if (&s == &top_) {
+                last_[wire] = self;
+            }
+        }
+    }
+
+    /** \brief Applies a declared gate through its summary */
+    void apply_summary(const gate_summary& g,
+                       const std::vector<std::size_t>& wires) {
+        auto& s = *cur_;
+        auto dim = s.dim;
+        auto stride = num_metrics_ * dim;
+        auto arity = g.arity;
+        auto inputs = arity + 1;
+        bool top = &s == &top_;
+
+        // Arrival times of each input, the start of the gate last, all
+        // delayed by the condition if any
+        in_.assign(inputs * stride, none);
+        for (std::size_t m = 0; m < num_metrics_; m++) {
+            in_[(arity * num_metrics_ + m) * dim + dim - 1] = 0;
+        }
+        for (std::size_t i = 0; i < arity; i++) {
+            std::copy_n(&s.arrival[wires[i] * stride], stride,
+                        &in_[i * stride]);
+        }
+        for (auto wire : cond_) {
+            const int* a = &s.arrival[wire * stride];
+            for (std::size_t i = 0; i < inputs; i++) {
+                for (std::size_t k = 0; k < stride; k++) {
+                    in_[i * stride + k] = std::max(in_[i * stride + k], a[k]);
+                }
+            }
+        }
+        if (top) {
+            in_refs_.assign(inputs, {-1, 0});
+            for (std::size_t i = 0; i < inputs; i++) {
+                int t = in_[i * stride];
+                if (i < arity) {
+                    in_refs_[i] = ref_at(wires[i], t);
+                }
+                for (auto wire : cond_) {
+                    if (in_refs_[i].node < 0) {
+                        in_refs_[i] = ref_at(wire, t);
+                    }
+                }
+            }
+        }
+
+        // Outputs
+        out_.assign(arity * stride, none);
+        out_refs_.resize(arity);
+        std::size_t node = nodes_.size();
+        if (top) {
+            nodes_.push_back({stmt_, preds_.size(), arity});
+        }
+        for (std::size_t j = 0; j < arity; j++) {
+            for (std::size_t m = 0; m < num_metrics_; m++) {
+                int* o = &out_[(j * num_metrics_ + m) * dim];
+                int best = none;
+                int best_length = 0;
+                arrival_ref pred{-1, 0};
+                for (std::size_t i = 0; i < inputs; i++) {
+                    int length = g.paths[(m * inputs + i) * arity + j];
+                    if (length == none) {
+                        continue;
+                    }
+                    const int* a = &in_[(i * num_metrics_ + m) * dim];
+                    for (std::size_t k = 0; k < dim; k++) {
+                        if (a[k] != none) {
+                            o[k] = std::max(o[k], a[k] + length);
+                        }
+                    }
+                    int t = a[0] + length;
+                    if (top && m == 0 &&
+                        (t > best || (t == best && length > best_length))) {
+                        best = t;
+                        best_length = length;
+                        pred = in_refs_[i];
+                    }
+                }
+                // Outputs the gate leaves as they were keep their gate on
+                // the critical path
+                if (top && m == 0) {
+                    preds_.push_back(pred);
+                    out_refs_[j] = best_length > 0
+                                       ? arrival_ref{static_cast<int>(node), j}
+                                       : pred;
+                }
+            }
+        }
+
+        // Gates of the body, by their start times
+        for (std::size_t g_i = 0; g_i < g.starts.size() / inputs; g_i++) {
+            const int* offset = &g.starts[g_i * inputs];
+            if (top) {
+                int t = none;
+                for (std::size_t i = 0; i < inputs; i++) {
+                    if (offset[i] != none) {
+                        t = std::max(t, in_[i * stride] + offset[i]);
+                    }
+                }
+                auto layer = static_cast<std::size_t>(t);
+                if (layer >= layers_.size()) {
+                    layers_.resize(layer + 1);
+                }
+                ++layers_[layer];
+            } else {
+                std::size_t first = s.starts.size();
+                s.starts.resize(first + dim, none);
+                for (std::size_t i = 0; i < inputs; i++) {
+                    if (offset[i] == none) {
+                        continue;
+                    }
+                    const int* a = &in_[i * stride];
+                    for (std::size_t k = 0; k < dim; k++) {
+                        if (a[k] != none) {
+                            s.starts[first + k] =
+                                std::max(s.starts[first + k], a[k] + offset[i]);
+                        }
+                    }
+                }
+            }
+        }
+
+        for (std::size_t j = 0; j < arity; j++) {
+            std::copy_n(&out_[j * stride], stride,
+                        &s.arrival[wires[j] * stride]);
+            s.busy[wires[j]] += g.busy[j];
+            if (top) {
+                last_[wires[j]] = out_refs_[j];
+            }
+        }
+        for (auto& [name, num] : g.counts) {
+            s.counts[name] += num;
+        }
+    }
+};
+
+circuit_profile profile_circuit(ast::Program& prog) {
+    Profiler profiler;
+    return profiler.run(prog);
+}
+
+circuit_profile profile_circuit(ast::Program& prog,
+                                const Profiler::config& params) {
+    Profiler profiler(params);
+    return profiler.run(prog);
+}
+
+/** \brief Writes a profile as JSON */
+void write_profile_json(std::ostream& os, const circuit_profile& profile,
+                        int indent = 2) {
+    output::JSONWriter json(os, indent);
+    json.begin_object();
+    json.key("cbits");
+    json.value(profile.cbits);
+    json.key("counts");
+    json.begin_object();
+    for (auto& [name, num] : profile.counts) {
+        json.key(name);
+        json.value(num);
+    }
+    json.end_object();
+    json.key("critical_path");
+    json.begin_array();
+    for (auto& stmt : profile.critical_path) {
+        json.value(stmt);
+    }
+    json.end_array();
+    json.key("depths");
+    json.begin_object();
+    for (auto& [name, depth] : profile.depths) {
+        json.key(name);
+        json.value(depth);
+    }
+    json.end_object();
+    json.key("idle");
+    json.begin_object();
+    for (auto& [qubit, layers] : profile.idle) {
+        json.key(qubit);
+        json.value(layers);
+    }
+    json.end_object();
+    json.key("parallelism");
+    json.begin_array();
+    for (int num : profile.parallelism) {
+        json.value(num);
+    }
+    json.end_array();
+    json.key("qubits");
+    json.value(profile.qubits);
+    json.end_object();
+    os << "\n";
+}
+
+} /* namespace tools */
+} /* namespace staq */
+
+#endif /* TOOLS_PROFILER_HPP_ */
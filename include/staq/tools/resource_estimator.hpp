@@ -35,6 +35,12 @@
 // TODO: account for compound gates, i.e. qreg q[n]; reset q;
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "qasmtools/ast/ast.hpp"
 
@@ -51,6 +57,15 @@ void add_counts(resource_count& A, const resource_count& B) {
     }
 }
 
+/**
+ * \class staq::tools::ResourceEstimator
+ * \brief Counts gates and computes the depth of a circuit
+ *
+ * Gate kinds, i.e. a name with its constant arguments, are interned on first
+ * use and counted by index, while depths are kept per qubit or bit in a
+ * dense array. The string keys of the returned count are only formatted at
+ * the end.
+ */
 class ResourceEstimator final : public ast::Visitor {
   public:
     struct config {
@@ -68,20 +83,17 @@ class ResourceEstimator final : public ast::Visitor {
 
         node.accept(*this);
 
-        // Unboxing the running estimate
-        auto& [counts, depths] = running_estimate_;
-
-        // Get maximum critical path length
-        int depth = 0;
-        for (auto& [id, length] : depths) {
-            if (length > depth) {
-                depth = length;
+        resource_count ret;
+        auto& counts = running_estimate_.counts;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] != 0) {
+                ret[kind_name(i)] += counts[i];
             }
         }
 
         // Set depth and return
-        counts["depth"] = depth;
-        return counts;
+        ret["depth"] = max_depth(running_estimate_);
+        return ret;
     }
 
     /* Variables */
@@ -97,184 +109,148 @@ class ResourceEstimator final : public ast::Visitor {
 
     /* Statements */
     void visit(ast::MeasureStmt& stmt) {
-        auto& [counts, depths] = running_estimate_;
+        auto& depths = running_estimate_.depths;
 
         // Gate count
-        counts["measurement"] += 1;
+        add_count(measurement_kind, 1);
 
         // Depth
-        int in_depth = std::max(depths[stmt.c_arg()], depths[stmt.q_arg()]);
-        depths[stmt.c_arg()] = in_depth + 1;
-        depths[stmt.q_arg()] = in_depth + 1;
+        auto c = slot(stmt.c_arg());
+        auto q = slot(stmt.q_arg());
+        int in_depth = std::max(depths[c], depths[q]);
+        depths[c] = in_depth + 1;
+        depths[q] = in_depth + 1;
     }
     void visit(ast::ResetStmt& stmt) {
-        auto& [counts, depths] = running_estimate_;
-
         // Gate count
-        counts["reset"] += 1;
+        add_count(reset_kind, 1);
 
         // Depth
-        depths[stmt.arg()] += 1;
+        running_estimate_.depths[slot(stmt.arg())] += 1;
     }
     void visit(ast::IfStmt& stmt) { stmt.then().accept(*this); }
 
     /* Gates */
     void visit(ast::UGate& gate) {
-        auto& [counts, depths] = running_estimate_;
-
         // Gate count
-        std::stringstream ss;
+        key_.name = "U";
+        key_.args.clear();
         auto theta = gate.theta().constant_eval();
         auto phi = gate.phi().constant_eval();
         auto lambda = gate.lambda().constant_eval();
 
         if (theta && phi && lambda) {
-            ss << "U(" << *theta << "," << *phi << "," << *lambda << ")";
-        } else {
-            ss << "U";
+            key_.args = {*theta, *phi, *lambda};
         }
 
-        counts[ss.str()] += 1;
+        add_count(intern(key_), 1);
 
         // Depth
-        depths[gate.arg()] += 1;
+        running_estimate_.depths[slot(gate.arg())] += 1;
     }
     void visit(ast::CNOTGate& gate) {
-        auto& [counts, depths] = running_estimate_;
+        auto& depths = running_estimate_.depths;
 
         // Gate count
-        counts["CX"] += 1;
+        add_count(cx_kind, 1);
 
         // Depth
-        int in_depth = std::max(depths[gate.ctrl()], depths[gate.tgt()]);
-        depths[gate.ctrl()] = in_depth + 1;
-        depths[gate.tgt()] = in_depth + 1;
+        auto ctrl = slot(gate.ctrl());
+        auto tgt = slot(gate.tgt());
+        int in_depth = std::max(depths[ctrl], depths[tgt]);
+        depths[ctrl] = in_depth + 1;
+        depths[tgt] = in_depth + 1;
     }
     void visit(ast::BarrierGate& gate) {
-        auto& [counts, depths] = running_estimate_;
-
         // Gate count
-        counts["barrier"] += 1;
+        add_count(barrier_kind, 1);
 
         // Depth
-        int in_depth = -1;
-        gate.foreach_arg([&in_depth, this](auto& arg) {
-            in_depth = std::max(in_depth, running_estimate_.second[arg]);
-        });
-        gate.foreach_arg([in_depth, this](auto& arg) {
-            running_estimate_.second[arg] = in_depth + 1;
-        });
+        set_depths(gate.args(), 1);
     }
     void visit(ast::DeclaredGate& gate) {
-        auto& [counts, depths] = running_estimate_;
-
         // Gate prefix, appropriately stripped of daggers
-        auto tmp = gate.name();
+        key_.name = gate.name();
         if (config_.merge_dagger) {
-            strip_dagger(tmp);
+            strip_dagger(key_.name);
         }
 
-        // Gate sufix. Only included if the parameters are constants
-        std::stringstream ss;
+        // Gate arguments. Only included if they are all constants
+        key_.args.clear();
         bool all_constant = true;
-        if (gate.num_cargs() > 0) {
-            bool flag = true;
-            ss << "(";
-            gate.foreach_carg([&ss, &flag, &all_constant](auto& arg) {
-                auto val = arg.constant_eval();
-
-                // Correct commas
-                if (flag) {
-                    flag = false;
-                } else {
-                    ss << ",";
-                }
-
-                if (val) {
-                    ss << *val;
-                } else {
-                    all_constant = false;
-                }
-            });
-            ss << ")";
-        }
-
-        // Gate name
-        std::string name;
-        if (all_constant) {
-            name = tmp + ss.str();
-        } else {
-            name = tmp;
-        }
-
-        // Get the longest critical path into the gate
-        int in_depth = -1;
-        gate.foreach_qarg([&in_depth, this](auto& arg) {
-            in_depth = std::max(in_depth, running_estimate_.second[arg]);
+        gate.foreach_carg([this, &all_constant](auto& arg) {
+            auto val = arg.constant_eval();
+            if (val) {
+                key_.args.push_back(*val);
+            } else {
+                all_constant = false;
+            }
         });
+        if (!all_constant) {
+            key_.args.clear();
+        }
 
-        // Get the pre-computed resource counts
-        auto& [gate_counts, depth_counts] = resource_map_[name];
-
-        if (config_.unbox &&
-            (config_.overrides.find(name) == config_.overrides.end()) &&
-            (gate.num_cargs() == 0)) {
-            add_counts(counts, gate_counts);
+        auto kind = intern(key_);
+        if (config_.unbox && !overridden_[kind] && (gate.num_cargs() == 0)) {
+            // Get the pre-computed resource counts
+            if (kind >= gate_estimates_.size()) {
+                gate_estimates_.resize(kind + 1);
+            }
+            auto& estimate = gate_estimates_[kind];
+            for (auto& [sub_kind, num] : estimate.counts) {
+                add_count(sub_kind, num);
+            }
 
             // Note that this gives the depth as if there were a barrier on
             // all involved gates before and after the sub-circuit. Not
             // super ideal
-            int gate_depth = gate_counts["depth"];
-            gate.foreach_qarg([in_depth, this, gate_depth](auto& arg) {
-                running_estimate_.second[arg] = in_depth + gate_depth;
-            });
+            set_depths(gate.qargs(), estimate.depth);
         } else {
-            counts[name] += 1;
-
-            gate.foreach_qarg([in_depth, this](auto& arg) {
-                running_estimate_.second[arg] = in_depth + 1;
-            });
+            add_count(kind, 1);
+            set_depths(gate.qargs(), 1);
         }
     }
 
     /* Declarations */
     void visit(ast::GateDecl& decl) {
-        // Initialize a new resource count
-        auto& local_state = resource_map_[decl.id()];
+        // Initialize a new resource count, with a slot per parameter
+        resource_state local_state;
+        for (auto& param : decl.q_params()) {
+            add_register(local_state, param, 0);
+        }
         std::swap(running_estimate_, local_state);
 
         decl.foreach_stmt([this](auto& gate) { gate.accept(*this); });
 
-        // Get maximum critical path length
-        auto& [counts, depths] = running_estimate_;
-        int depth = 0;
-        for (auto& [id, length] : depths) {
-            if (length > depth) {
-                depth = length;
+        std::swap(running_estimate_, local_state);
+
+        // Record the counts of the gate for unboxing
+        key_.name = decl.id();
+        key_.args.clear();
+        auto kind = intern(key_);
+        if (kind >= gate_estimates_.size()) {
+            gate_estimates_.resize(kind + 1);
+        }
+        auto& estimate = gate_estimates_[kind];
+        estimate.counts.clear();
+        auto& counts = local_state.counts;
+        for (std::size_t i = 0; i < counts.size(); i++) {
+            if (counts[i] != 0 && i != depth_kind) {
+                estimate.counts.emplace_back(i, counts[i]);
             }
         }
-
-        // Set depth and return
-        counts["depth"] = depth;
-
-        std::swap(running_estimate_, local_state);
+        estimate.depth = max_depth(local_state);
     }
     void visit(ast::OracleDecl&) {}
     void visit(ast::RegisterDecl& decl) {
-        auto& [counts, depths] = running_estimate_;
-
-        if (decl.is_quantum()) {
-            counts["qubits"] += decl.size();
-        } else {
-            counts["cbits"] += decl.size();
-        }
+        add_count(decl.is_quantum() ? qubits_kind : cbits_kind, decl.size());
+        add_register(running_estimate_, decl.id(), decl.size());
     }
     void visit(ast::AncillaDecl& decl) {
-        auto& [counts, depths] = running_estimate_;
-
         if (!decl.is_dirty()) {
-            counts["ancillas"] += decl.size();
+            add_count(ancillas_kind, decl.size());
         }
+        add_register(running_estimate_, decl.id(), decl.size());
     }
 
     /* Program */
@@ -283,18 +259,170 @@ class ResourceEstimator final : public ast::Visitor {
     }
 
   private:
-    using depth_count = std::unordered_map<ast::VarAccess, int>;
-    using resource_state = std::pair<resource_count, depth_count>;
+    /**
+     * \brief A gate name with its constant arguments
+     *
+     * Arguments are compared bitwise, so that e.g. 0 and -0 stay apart as
+     * they did when keys were strings
+     */
+    struct kind_key {
+        std::string name;
+        std::vector<double> args;
+
+        bool operator==(const kind_key& other) const {
+            return name == other.name &&
+                   args.size() == other.args.size() &&
+                   (args.empty() ||
+                    std::memcmp(args.data(), other.args.data(),
+                                args.size() * sizeof(double)) == 0);
+        }
+    };
+
+    struct kind_hash {
+        std::size_t operator()(const kind_key& key) const {
+            std::size_t h = std::hash<std::string>{}(key.name);
+            for (double arg : key.args) {
+                std::uint64_t bits;
+                std::memcpy(&bits, &arg, sizeof(bits));
+                h = h * 31 + std::hash<std::uint64_t>{}(bits);
+            }
+            return h;
+        }
+    };
+
+    /** \brief Counts by kind, and depths by slot, of a circuit */
+    struct resource_state {
+        std::vector<int> counts{};
+        std::vector<int> depths{};
+        /// First slot and size of each register. The first slot stands for
+        /// the register as a whole
+        std::unordered_map<std::string, std::pair<std::size_t, int>>
+            registers{};
+        std::unordered_map<ast::VarAccess, std::size_t> undeclared{};
+    };
+
+    /** \brief Counts and depth of a gate declaration, for unboxing */
+    struct gate_estimate {
+        std::vector<std::pair<std::size_t, int>> counts{};
+        int depth = 0;
+    };
+
+    /** \brief Kinds interned by reset(), in order */
+    enum fixed_kind : std::size_t {
+        measurement_kind,
+        reset_kind,
+        cx_kind,
+        barrier_kind,
+        qubits_kind,
+        cbits_kind,
+        ancillas_kind,
+        depth_kind
+    };
 
     config config_;
-    std::unordered_map<std::string_view, resource_state> resource_map_;
+    std::unordered_map<kind_key, std::size_t, kind_hash> kind_index_;
+    std::vector<const kind_key*> kinds_;
+    std::vector<bool> overridden_;
+    std::vector<gate_estimate> gate_estimates_;
+    kind_key key_; ///< scratch key, to reuse its storage
 
     resource_state running_estimate_;
 
     void reset() {
-        resource_map_.clear();
-        running_estimate_.first.clear();
-        running_estimate_.second.clear();
+        kind_index_.clear();
+        kinds_.clear();
+        overridden_.clear();
+        gate_estimates_.clear();
+        running_estimate_ = resource_state();
+
+        for (auto name : {"measurement", "reset", "CX", "barrier", "qubits",
+                          "cbits", "ancillas", "depth"}) {
+            key_.name = name;
+            key_.args.clear();
+            intern(key_);
+        }
+    }
+
+    std::size_t intern(const kind_key& key) {
+        auto [it, inserted] = kind_index_.try_emplace(key, kinds_.size());
+        if (inserted) {
+            kinds_.push_back(&it->first);
+            overridden_.push_back(config_.overrides.find(key.name) !=
+                                  config_.overrides.end());
+        }
+        return it->second;
+    }
+
+    std::string kind_name(std::size_t kind) {
+        auto& key = *kinds_[kind];
+        if (key.args.empty()) {
+            return key.name;
+        }
+
+        std::stringstream ss;
+        ss << key.name << "(";
+        for (std::size_t i = 0; i < key.args.size(); i++) {
+            if (i > 0) {
+                ss << ",";
+            }
+            ss << key.args[i];
+        }
+        ss << ")";
+        return ss.str();
+    }
+
+    void add_count(std::size_t kind, int num) {
+        auto& counts = running_estimate_.counts;
+        if (kind >= counts.size()) {
+            counts.resize(kinds_.size());
+        }
+        counts[kind] += num;
+    }
+
+    static void add_register(resource_state& state, const std::string& id,
+                             int size) {
+        state.registers[id] = {state.depths.size(), size};
+        state.depths.resize(state.depths.size() + size + 1);
+    }
+
+    std::size_t slot(const ast::VarAccess& va) {
+        auto& state = running_estimate_;
+        auto it = state.registers.find(va.var());
+        if (it != state.registers.end()) {
+            auto [first, size] = it->second;
+            if (!va.offset()) {
+                return first;
+            } else if (*va.offset() >= 0 && *va.offset() < size) {
+                return first + 1 + *va.offset();
+            }
+        }
+
+        auto [pos, inserted] =
+            state.undeclared.try_emplace(va, state.depths.size());
+        if (inserted) {
+            state.depths.push_back(0);
+        }
+        return pos->second;
+    }
+
+    /** \brief Sets the depths of args to their maximum plus gate_depth */
+    void set_depths(std::vector<ast::VarAccess>& args, int gate_depth) {
+        auto& depths = running_estimate_.depths;
+        int in_depth = -1;
+        for (auto& arg : args) {
+            in_depth = std::max(in_depth, depths[slot(arg)]);
+        }
+        for (auto& arg : args) {
+            depths[slot(arg)] = in_depth + gate_depth;
+        }
+    }
+
+    static int max_depth(const resource_state& state) {
+        int depth = 0;
+        for (int length : state.depths) {
+            depth = std::max(depth, length);
+        }
+        return depth;
     }
 
     void strip_dagger(std::string& str) {
@@ -50,7 +50,7 @@ namespace ast = qasmtools::ast;
  * applied to a register or registers of qubits at once --
  * with a sequence of individual gate applications
  */
-void desugar(ast::ASTNode& node);
+inline void desugar(ast::ASTNode& node);
 
 /* Implementation */
 class DesugarImpl final : public ast::Replacer {
@@ -290,7 +290,7 @@ class DesugarImpl final : public ast::Replacer {
     }
 };
 
-void desugar(ast::ASTNode& node) {
+inline void desugar(ast::ASTNode& node) {
     DesugarImpl alg;
     alg.run(node);
 }
@@ -0,0 +1,123 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Benchmarks the Diophantine solver used by grid synthesis. For each
+ * precision, reports the time taken to approximate a fixed set of angles, and
+ * the rate at which integers of the size factorized during those searches are
+ * accepted by prime_factorize_int.
+ *
+ * Build from the repository root with
+ *
+ *   g++ -std=c++17 -O2 -Iinclude misc/benchmarks/diophantine_benchmark.cpp \
+ *       -lgmpxx -lgmp -pthread -o diophantine_benchmark
+ *
+ * and run as
+ *
+ *   ./diophantine_benchmark [--ecm-curves N] [precision...]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "staq/grid_synth/diophantine_solver.hpp"
+#include "staq/grid_synth/rz_approximation.hpp"
+
+using namespace staq;
+using namespace grid_synth;
+
+static const int NUM_ANGLES = 10;
+static const int NUM_SAMPLES = 2000;
+
+int main(int argc, char** argv) {
+    std::vector<long int> precisions;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--ecm-curves" && i + 1 < argc) {
+            ECM_CURVES = std::atoi(argv[++i]);
+        } else {
+            precisions.push_back(std::atol(argv[i]));
+        }
+    }
+    if (precisions.empty()) {
+        precisions = {10, 20, 30, 50, 100};
+    }
+
+    std::cout << std::setw(10) << "precision" << std::setw(14) << "ms/angle"
+              << std::setw(8) << "bits" << std::setw(14) << "accepted %"
+              << std::setw(14) << "us/factor" << '\n';
+
+    for (long int prec : precisions) {
+        MP_CONSTS = initialize_constants(prec);
+        real_t eps = gmpf::pow(real_t(10), -prec);
+        random_numbers.seed(prec);
+
+        // Time per angle, recording the size of the norm of each solution
+        mp_bitcnt_t bits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 1; i <= NUM_ANGLES; i++) {
+            RzApproximation approx = find_fast_rz_approximation(
+                PI * real_t(i) / real_t(NUM_ANGLES + 1), eps);
+            ZOmega u = approx.u();
+            ZSqrt2 xi = ZSqrt2(int_t(gmpf::pow(2, approx.scale_exponent())),
+                               0) -
+                        (u.conj() * u).to_zsqrt2();
+            int_t norm = abs(xi.norm());
+            bits = std::max(bits, mpz_sizeinbase(norm.get_mpz_t(), 2));
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ms_per_angle =
+            std::chrono::duration<double, std::milli>(end - start).count() /
+            NUM_ANGLES;
+
+        // Acceptance rate on random odd integers of the same size, drawn from
+        // a separate generator so every version factors the same integers
+        gmp_randclass samples(gmp_randinit_mt);
+        samples.seed(prec);
+        int accepted = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < NUM_SAMPLES; i++) {
+            int_t n = int_t(samples.get_z_bits(bits));
+            mpz_setbit(n.get_mpz_t(), bits - 1);
+            mpz_setbit(n.get_mpz_t(), 0);
+            int_vec_t factors;
+            accepted += prime_factorize_int(factors, n);
+        }
+        end = std::chrono::steady_clock::now();
+        double us_per_factor =
+            std::chrono::duration<double, std::micro>(end - start).count() /
+            NUM_SAMPLES;
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10)
+                  << prec << std::setw(14) << ms_per_angle << std::setw(8)
+                  << bits << std::setw(14)
+                  << 100.0 * accepted / NUM_SAMPLES << std::setw(14)
+                  << us_per_factor << '\n';
+    }
+}
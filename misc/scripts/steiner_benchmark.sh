@@ -0,0 +1,31 @@
+#!/bin/sh
+
+# steiner_benchmark
+#
+# Compares the CNOT count and runtime of the Steiner tree algorithms used by
+# the steiner mapper, on a rectangular device
+
+# $1 - device width (the device is width x width)
+# $@ - OpenQASM circuits
+
+if [ $# -lt 2 ]; then
+    printf "Usage: %s <device width> <circuit.qasm> [circuit.qasm ...]\n" "$0"
+    exit 1
+fi
+
+device=$(mktemp)
+trap 'rm -f "$device"' EXIT
+staq_device_generator --rectangle "$1" >"$device"
+shift
+
+printf "%-32s %-10s %10s %10s\n" "circuit" "algorithm" "CNOTs" "time (s)"
+for circuit in "$@"; do
+    for alg in greedy mehlhorn; do
+        start=$(date +%s.%N)
+        cnots=$(staq_mapper -d "$device" -m steiner --steiner-alg "$alg" \
+            <"$circuit" | grep -c "^CX")
+        end=$(date +%s.%N)
+        printf "%-32s %-10s %10d %10.3f\n" "$(basename "$circuit")" "$alg" \
+            "$cnots" "$(awk "BEGIN { print $end - $start }")"
+    done
+done
@@ -187,9 +187,10 @@ class Program {
         return oss.str();
     }
     std::string to_json() {
-        staq::output::JSONOutputter outputter;
+        std::ostringstream oss;
+        staq::output::JSONOutputter outputter(oss);
         outputter.run(*prog_);
-        return outputter.json_val().dump();
+        return oss.str();
     }
     std::string lattice_surgery() {
         return staq::output::lattice_surgery(*prog_);
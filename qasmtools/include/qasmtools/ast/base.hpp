@@ -32,6 +32,7 @@
 #ifndef QASMTOOLS_AST_BASE_HPP_
 #define QASMTOOLS_AST_BASE_HPP_
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -53,10 +54,10 @@ using symbol = std::string;
  * \brief Base class for AST nodes
  */
 class ASTNode : public object::cloneable<ASTNode> {
-    static int& max_uid_() {
-        static int v;
+    static std::atomic<int>& max_uid_() {
+        static std::atomic<int> v;
         return v;
-    } ///< the maximum uid that has been assigned
+    } ///< the maximum uid that has been assigned, shared between threads
 
   protected:
     const int uid_;              ///< the node's unique ID
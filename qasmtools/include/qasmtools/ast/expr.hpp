@@ -36,6 +36,7 @@
 #include <iomanip>
 
 #include "../utils/angle.hpp"
+#include "../utils/format.hpp"
 #include "base.hpp"
 
 #ifdef EXPR_GMP
@@ -582,7 +583,9 @@ class RealExpr final : public Expr {
         (void)ctx;
 
         std::streamsize ss = os.precision();
-        os << std::setprecision(15) << value() << std::setprecision(ss);
+        os.precision(15);
+        utils::write_double(os, value());
+        os.precision(ss);
         return os;
     }
 
@@ -32,6 +32,7 @@
 #ifndef QASMTOOLS_AST_PROGRAM_HPP_
 #define QASMTOOLS_AST_PROGRAM_HPP_
 
+#include "../utils/format.hpp"
 #include "decl.hpp"
 
 namespace qasmtools {
@@ -132,9 +133,12 @@ class Program : public ASTNode {
             os << "include \"qelib1.inc\";\n";
         }
         os << "\n";
-        for (auto it = body_.begin(); it != body_.end(); it++) {
-            (*it)->pretty_print(os, std_include_);
-        }
+        auto print = [this](std::ostream& out, auto first, auto last) {
+            for (; first != last; ++first) {
+                (*first)->pretty_print(out, std_include_);
+            }
+        };
+        utils::write_in_chunks(os, body_.begin(), body_.end(), print);
 
         return os;
     }
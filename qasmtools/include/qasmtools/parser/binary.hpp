@@ -0,0 +1,431 @@
+/*
+ * This file is part of qasmtools.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file qasmtools/parser/binary.hpp
+ * \brief Flat binary circuit format
+ *
+ * A binary circuit is a header followed by six sections. All integers are
+ * little-endian, and every section starts at a multiple of 8 bytes from the
+ * start of the file, so a memory-mapped file can be read in place.
+ *
+ * Header (48 bytes), as 32-bit unsigned fields after the magic number:
+ *
+ *     offset  field
+ *          0  magic "STAQBIN\0"
+ *          8  version, currently 1
+ *         12  flags, bit 0 set if the circuit includes qelib1.inc
+ *         16  number of qubits
+ *         20  number of classical bits
+ *         24  number of registers
+ *         28  number of gate table entries
+ *         32  number of records
+ *         36  number of operands
+ *         40  number of parameters
+ *         44  size of the string pool in bytes
+ *
+ * Sections, in order:
+ *
+ * - Parameters: 64-bit IEEE 754 doubles
+ * - Registers, 16 bytes each: name offset, name size, size, and 1 for
+ *   quantum or 0 for classical. Qubits and bits are numbered consecutively
+ *   through the quantum and the classical registers, in order
+ * - Gate table, 20 bytes each: kind (see binary::GateKind), name offset,
+ *   name size, number of parameters and number of operands
+ * - Records, 20 bytes each: index into the gate table, index of the first
+ *   operand, index of the first parameter, index of the classical register
+ *   the record is conditioned on or binary::no_condition, and the value the
+ *   register is compared to
+ * - Operands: the index of a qubit or bit, or binary::whole_register plus
+ *   the index of a register
+ * - String pool: names, not null-terminated
+ *
+ * Gate parameters are stored as evaluated doubles, so a circuit read back
+ * has real literals in place of its original expressions. Only U, CX,
+ * measurement, reset, barriers and the qelib1.inc gates can be stored, and
+ * so gates need to be inlined down to qelib1.inc before writing.
+ */
+
+#ifndef QASMTOOLS_PARSER_BINARY_HPP_
+#define QASMTOOLS_PARSER_BINARY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "parser.hpp"
+
+namespace qasmtools {
+namespace parser {
+
+namespace binary {
+
+constexpr char magic[8] = {'S', 'T', 'A', 'Q', 'B', 'I', 'N', '\0'};
+constexpr std::uint32_t version = 1;
+
+constexpr std::uint32_t flag_std_include = 1; ///< includes qelib1.inc
+constexpr std::uint32_t whole_register = 1u << 31; ///< operand is a register
+constexpr std::uint32_t no_condition = ~std::uint32_t(0); ///< unconditioned
+
+constexpr std::size_t header_size = 48;
+constexpr std::size_t register_size = 16;
+constexpr std::size_t gate_size = 20;
+constexpr std::size_t record_size = 20;
+
+/** \brief Kinds of gate table entries */
+enum class GateKind : std::uint32_t {
+    U,        ///< U(theta, phi, lambda) q
+    CX,       ///< CX c, t
+    measure,  ///< measure q -> c
+    reset,    ///< reset q
+    barrier,  ///< barrier q, ...
+    declared, ///< a qelib1.inc gate, by name
+};
+
+/** \brief Rounds a section size up to a multiple of 8 bytes */
+inline std::size_t align(std::size_t size) { return (size + 7) & ~7; }
+
+/** \brief Appends a little-endian 32-bit integer to a buffer */
+inline void put_u32(std::string& buf, std::uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        buf.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+/** \brief Appends a little-endian double to a buffer */
+inline void put_f64(std::string& buf, double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; i++) {
+        buf.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+    }
+}
+
+/** \brief Reads a little-endian 32-bit integer */
+inline std::uint32_t get_u32(const char* p) {
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | static_cast<unsigned char>(p[i]);
+    }
+    return value;
+}
+
+/** \brief Reads a little-endian double */
+inline double get_f64(const char* p) {
+    std::uint64_t bits = 0;
+    for (int i = 7; i >= 0; i--) {
+        bits = (bits << 8) | static_cast<unsigned char>(p[i]);
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} /* namespace binary */
+
+/**
+ * \brief Parse a binary circuit held in memory
+ *
+ * \param data Start of the circuit, e.g. a memory-mapped file
+ * \param size Size of the circuit in bytes
+ * \param name Name of the source, for error messages
+ * \return The program, semantically checked
+ */
+inline ast::ptr<ast::Program> parse_binary(const char* data, std::size_t size,
+                                           std::string name = "") {
+    auto fail = [&name](const std::string& msg) {
+        std::cerr << name << ": " << msg << "\n";
+        throw ParseError();
+    };
+
+    if (size < binary::header_size ||
+        std::memcmp(data, binary::magic, sizeof(binary::magic)) != 0) {
+        fail("not a binary circuit");
+    }
+    if (binary::get_u32(data + 8) != binary::version) {
+        fail("unsupported binary circuit version " +
+             std::to_string(binary::get_u32(data + 8)));
+    }
+    bool std_include = binary::get_u32(data + 12) & binary::flag_std_include;
+    std::size_t num_qubits = binary::get_u32(data + 16);
+    std::size_t num_bits = binary::get_u32(data + 20);
+    std::size_t num_registers = binary::get_u32(data + 24);
+    std::size_t num_gates = binary::get_u32(data + 28);
+    std::size_t num_records = binary::get_u32(data + 32);
+    std::size_t num_operands = binary::get_u32(data + 36);
+    std::size_t num_params = binary::get_u32(data + 40);
+    std::size_t strings_size = binary::get_u32(data + 44);
+
+    // Section offsets
+    std::size_t params = binary::header_size;
+    std::size_t registers = params + binary::align(8 * num_params);
+    std::size_t gates =
+        registers + binary::align(binary::register_size * num_registers);
+    std::size_t records = gates + binary::align(binary::gate_size * num_gates);
+    std::size_t operands =
+        records + binary::align(binary::record_size * num_records);
+    std::size_t strings = operands + binary::align(4 * num_operands);
+    if (size < strings + strings_size) {
+        fail("truncated binary circuit");
+    }
+
+    auto read_string = [&](const char* p) {
+        std::size_t offset = binary::get_u32(p);
+        std::size_t length = binary::get_u32(p + 4);
+        if (offset > strings_size || length > strings_size - offset) {
+            fail("string out of range");
+        }
+        return std::string(data + strings + offset, length);
+    };
+
+    std::list<ast::ptr<ast::Stmt>> body;
+    if (std_include) {
+        body = std::move(
+            parse_string("OPENQASM 2.0;\ninclude \"qelib1.inc\";\n")->body());
+    }
+
+    // Registers, with the first qubit or bit of each
+    struct reg {
+        std::string name;
+        bool quantum;
+        std::size_t start;
+        std::size_t size;
+    };
+    std::vector<reg> regs;
+    std::size_t qubits = 0;
+    std::size_t bits = 0;
+    for (std::size_t i = 0; i < num_registers; i++) {
+        const char* p = data + registers + binary::register_size * i;
+        reg r{read_string(p), binary::get_u32(p + 12) != 0, 0,
+              binary::get_u32(p + 8)};
+        r.start = r.quantum ? qubits : bits;
+        (r.quantum ? qubits : bits) += r.size;
+        body.emplace_back(ast::RegisterDecl::create(
+            Position(name, 0, 0), r.name, r.quantum,
+            static_cast<int>(r.size)));
+        regs.push_back(std::move(r));
+    }
+    if (qubits != num_qubits || bits != num_bits) {
+        fail("register sizes do not match the header");
+    }
+
+    // Per kind, the registers in order of their first qubit or bit
+    std::vector<std::size_t> qregs;
+    std::vector<std::size_t> cregs;
+    for (std::size_t i = 0; i < regs.size(); i++) {
+        if (regs[i].size > 0) {
+            (regs[i].quantum ? qregs : cregs).push_back(i);
+        }
+    }
+    auto access = [&](std::uint32_t operand, bool quantum,
+                      const Position& pos) {
+        if (operand & binary::whole_register) {
+            std::size_t i = operand & ~binary::whole_register;
+            if (i >= regs.size() || regs[i].quantum != quantum) {
+                fail("register operand out of range");
+            }
+            return ast::VarAccess(pos, regs[i].name);
+        }
+        auto& index = quantum ? qregs : cregs;
+        auto it = std::upper_bound(index.begin(), index.end(),
+                                   std::size_t(operand),
+                                   [&regs](std::size_t x, std::size_t i) {
+                                       return x < regs[i].start;
+                                   });
+        if (it == index.begin()) {
+            fail("operand out of range");
+        }
+        auto& r = regs[*std::prev(it)];
+        if (operand >= r.start + r.size) {
+            fail("operand out of range");
+        }
+        return ast::VarAccess(pos, r.name,
+                              static_cast<int>(operand - r.start));
+    };
+
+    // Gate table
+    struct gate {
+        binary::GateKind kind;
+        std::string name;
+        std::size_t num_params;
+        std::size_t num_args;
+    };
+    std::vector<gate> table;
+    for (std::size_t i = 0; i < num_gates; i++) {
+        const char* p = data + gates + binary::gate_size * i;
+        gate g{static_cast<binary::GateKind>(binary::get_u32(p)),
+               read_string(p + 4), binary::get_u32(p + 12),
+               binary::get_u32(p + 16)};
+        std::size_t params_expected = 0;
+        std::size_t args_expected = g.num_args;
+        switch (g.kind) {
+            case binary::GateKind::U:
+                params_expected = 3;
+                args_expected = 1;
+                break;
+            case binary::GateKind::CX:
+            case binary::GateKind::measure:
+                args_expected = 2;
+                break;
+            case binary::GateKind::reset:
+                args_expected = 1;
+                break;
+            case binary::GateKind::barrier:
+                break;
+            case binary::GateKind::declared:
+                params_expected = g.num_params;
+                break;
+            default:
+                fail("unknown gate kind " +
+                     std::to_string(static_cast<std::uint32_t>(g.kind)));
+        }
+        if (g.num_params != params_expected || g.num_args != args_expected) {
+            fail("gate table entry " + std::to_string(i) +
+                 " has the wrong number of arguments");
+        }
+        table.push_back(std::move(g));
+    }
+
+    // Records
+    for (std::size_t i = 0; i < num_records; i++) {
+        const char* p = data + records + binary::record_size * i;
+        Position pos(name, static_cast<int>(i) + 1, 1);
+
+        std::size_t g = binary::get_u32(p);
+        std::size_t operand = binary::get_u32(p + 4);
+        std::size_t param = binary::get_u32(p + 8);
+        std::uint32_t cond_reg = binary::get_u32(p + 12);
+        std::uint32_t cond_value = binary::get_u32(p + 16);
+        if (g >= table.size()) {
+            fail("gate out of range in record " + std::to_string(i));
+        }
+        auto& entry = table[g];
+        if (operand > num_operands || entry.num_args > num_operands - operand ||
+            param > num_params || entry.num_params > num_params - param) {
+            fail("arguments out of range in record " + std::to_string(i));
+        }
+
+        auto arg = [&](std::size_t j, bool quantum = true) {
+            return access(binary::get_u32(data + operands + 4 * (operand + j)),
+                          quantum, pos);
+        };
+        auto carg = [&](std::size_t j) -> ast::ptr<ast::Expr> {
+            return ast::RealExpr::create(
+                pos, binary::get_f64(data + params + 8 * (param + j)));
+        };
+
+        ast::ptr<ast::Stmt> stmt;
+        switch (entry.kind) {
+            case binary::GateKind::U:
+                stmt = ast::UGate::create(pos, carg(0), carg(1), carg(2),
+                                          arg(0));
+                break;
+            case binary::GateKind::CX:
+                stmt = ast::CNOTGate::create(pos, arg(0), arg(1));
+                break;
+            case binary::GateKind::measure:
+                stmt = ast::MeasureStmt::create(pos, arg(0), arg(1, false));
+                break;
+            case binary::GateKind::reset:
+                stmt = ast::ResetStmt::create(pos, arg(0));
+                break;
+            case binary::GateKind::barrier: {
+                std::vector<ast::VarAccess> args;
+                for (std::size_t j = 0; j < entry.num_args; j++) {
+                    args.emplace_back(arg(j));
+                }
+                stmt = ast::BarrierGate::create(pos, std::move(args));
+                break;
+            }
+            case binary::GateKind::declared: {
+                std::vector<ast::ptr<ast::Expr>> c_args;
+                std::vector<ast::VarAccess> q_args;
+                for (std::size_t j = 0; j < entry.num_params; j++) {
+                    c_args.emplace_back(carg(j));
+                }
+                for (std::size_t j = 0; j < entry.num_args; j++) {
+                    q_args.emplace_back(arg(j));
+                }
+                stmt = ast::DeclaredGate::create(pos, entry.name,
+                                                 std::move(c_args),
+                                                 std::move(q_args));
+                break;
+            }
+        }
+
+        if (cond_reg != binary::no_condition) {
+            if (cond_reg >= regs.size() || regs[cond_reg].quantum) {
+                fail("condition out of range in record " + std::to_string(i));
+            }
+            stmt = ast::IfStmt::create(pos, regs[cond_reg].name,
+                                       static_cast<int>(cond_value),
+                                       std::move(stmt));
+        }
+        body.emplace_back(std::move(stmt));
+    }
+
+    auto result =
+        ast::Program::create(Position(name, 0, 0), std_include,
+                             std::move(body), static_cast<int>(num_bits),
+                             static_cast<int>(num_qubits));
+    ast::check_source(*result);
+
+    return result;
+}
+
+/**
+ * \brief Whether a file holds a binary circuit
+ */
+inline bool is_binary_file(const std::string& fname) {
+    std::ifstream ifs(fname, std::ios::binary);
+    char buf[sizeof(binary::magic)];
+    return ifs.read(buf, sizeof(buf)) &&
+           std::memcmp(buf, binary::magic, sizeof(buf)) == 0;
+}
+
+/**
+ * \brief Parse a binary circuit from a file
+ */
+inline ast::ptr<ast::Program> parse_binary_file(std::string fname) {
+    std::ifstream ifs(fname, std::ios::binary);
+    if (!ifs.good()) {
+        std::cerr << "File \"" << fname << "\" not found!\n";
+        throw ParseError();
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+
+    return parse_binary(data.data(), data.size(), fname);
+}
+
+} /* namespace parser */
+} /* namespace qasmtools */
+
+#endif /* QASMTOOLS_PARSER_BINARY_HPP_ */
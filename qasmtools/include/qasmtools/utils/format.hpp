@@ -0,0 +1,163 @@
+/*
+ * This file is part of qasmtools.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file qasmtools/utils/format.hpp
+ * \brief Helpers for writing out large programs
+ */
+
+#ifndef QASMTOOLS_UTILS_FORMAT_HPP_
+#define QASMTOOLS_UTILS_FORMAT_HPP_
+
+#include <algorithm>
+#include <future>
+#include <locale>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+namespace qasmtools {
+namespace utils {
+
+/**
+ * \brief Writes a double exactly as os << value would
+ *
+ * Formats with std::to_chars where available, which is much faster than
+ * going through the stream's locale. Falls back to os << value for anything
+ * to_chars does not reproduce, such as padding or a locale with its own
+ * decimal point.
+ */
+inline void write_double(std::ostream& os, double value) {
+#if defined(__cpp_lib_to_chars)
+    auto flags = os.flags();
+    auto field = flags & std::ios_base::floatfield;
+    bool plain =
+        os.width() == 0 && field != std::ios_base::floatfield &&
+        !(flags & (std::ios_base::showpos | std::ios_base::showpoint |
+                   std::ios_base::uppercase));
+    if (plain) {
+        auto& punct = std::use_facet<std::numpunct<char>>(os.getloc());
+        plain = punct.decimal_point() == '.' && punct.grouping().empty();
+    }
+    if (plain) {
+        auto fmt = std::chars_format::general;
+        if (field == std::ios_base::fixed) {
+            fmt = std::chars_format::fixed;
+        } else if (field == std::ios_base::scientific) {
+            fmt = std::chars_format::scientific;
+        }
+        char buf[128];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value, fmt,
+                                       static_cast<int>(os.precision()));
+        if (ec == std::errc()) {
+            os.write(buf, end - buf);
+            return;
+        }
+    }
+#endif
+    os << value;
+}
+
+constexpr std::size_t format_chunk_size = 4096; ///< Items per chunk
+
+/** \brief Default number of threads for write_in_chunks */
+inline unsigned format_threads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * \brief Writes a range of items, formatting chunks of it on several threads
+ *
+ * format(out, first, last) writes the items in [first, last) to out, and may
+ * be called from several threads at once. Each chunk is formatted into its
+ * own buffer, with the flags, precision and locale of os, and the buffers
+ * are written to os in order.
+ *
+ * \param os Output stream
+ * \param first Start of the range
+ * \param last End of the range
+ * \param format Formatter for a chunk
+ * \param threads Number of threads, or 0 for one per hardware thread
+ */
+template <typename It, typename Format>
+void write_in_chunks(std::ostream& os, It first, It last, Format format,
+                     unsigned threads = 0) {
+    if (threads == 0) {
+        threads = format_threads();
+    }
+
+    auto flags = os.flags();
+    auto precision = os.precision();
+    auto fill = os.fill();
+    auto loc = os.getloc();
+    auto format_chunk = [&](It begin, It end) {
+        std::ostringstream out;
+        out.flags(flags);
+        out.precision(precision);
+        out.fill(fill);
+        out.imbue(loc);
+        format(static_cast<std::ostream&>(out), begin, end);
+        return out.str();
+    };
+
+    std::vector<std::pair<It, It>> chunks;
+    std::vector<std::future<std::string>> pending;
+    while (first != last) {
+        chunks.clear();
+        for (unsigned i = 0; i < threads && first != last; i++) {
+            It begin = first;
+            for (std::size_t n = 0; n < format_chunk_size && first != last;
+                 n++) {
+                ++first;
+            }
+            chunks.emplace_back(begin, first);
+        }
+
+        pending.clear();
+        for (std::size_t i = 1; i < chunks.size(); i++) {
+            pending.push_back(std::async(std::launch::async, format_chunk,
+                                         chunks[i].first, chunks[i].second));
+        }
+        std::string text = format_chunk(chunks[0].first, chunks[0].second);
+        os.write(text.data(), text.size());
+        for (auto& chunk : pending) {
+            text = chunk.get();
+            os.write(text.data(), text.size());
+        }
+    }
+}
+
+} /* namespace utils */
+} /* namespace qasmtools */
+
+#endif /* QASMTOOLS_UTILS_FORMAT_HPP_ */
@@ -28,6 +28,7 @@
 
 #include <third_party/CLI/CLI.hpp>
 
+#include "qasmtools/parser/binary.hpp"
 #include "qasmtools/parser/parser.hpp"
 
 #include "staq/transformations/barrier_merge.hpp"
@@ -40,6 +41,7 @@
 #include "staq/optimization/rotation_folding.hpp"
 #include "staq/optimization/simplify.hpp"
 
+#include "staq/mapping/auto.hpp"
 #include "staq/mapping/device.hpp"
 #include "staq/mapping/layout/basic.hpp"
 #include "staq/mapping/layout/bestfit.hpp"
@@ -47,9 +49,11 @@
 #include "staq/mapping/mapping/steiner.hpp"
 #include "staq/mapping/mapping/swap.hpp"
 
+#include "staq/tools/profiler.hpp"
 #include "staq/tools/qubit_estimator.hpp"
 #include "staq/tools/resource_estimator.hpp"
 
+#include "staq/output/binary.hpp"
 #include "staq/output/cirq.hpp"
 #include "staq/output/projectq.hpp"
 #include "staq/output/qsharp.hpp"
@@ -110,6 +114,8 @@ std::string make_passes_str(int width) {
 
 int main(int argc, char** argv) {
     using namespace staq;
+    using qasmtools::parser::is_binary_file;
+    using qasmtools::parser::parse_binary_file;
     using qasmtools::parser::parse_file;
 
     if (argc == 1) {
@@ -122,10 +128,14 @@ int main(int argc, char** argv) {
     std::string format = "qasm";
     std::string layout_alg = "bestfit";
     std::string mapper = "steiner";
+    std::string steiner_alg = "greedy";
+    std::string mapping_score = "cnots";
+    double mapping_budget = 0;
     bool disable_layout_optimization = false;
     bool no_expand_registers = false;
     bool no_rewrite_expressions = false;
     bool evaluate_all = false;
+    std::vector<std::string> depth_classes;
     std::string device_json;
     std::string input_qasm;
 
@@ -152,13 +162,28 @@ int main(int argc, char** argv) {
                    "Output filename. Otherwise prints to stdout");
     app.add_option("-f,--format", format, "Output format. Default=" + format)
         ->check(CLI::IsMember(
-            {"qasm", "quil", "projectq", "qsharp", "cirq", "resources"}));
+            {"qasm", "quil", "projectq", "qsharp", "cirq", "resources",
+             "binary", "profile"}));
     app.add_option("-l,--layout", layout_alg,
                    "Initial device layout algorithm. Default=" + layout_alg)
-        ->check(CLI::IsMember({"linear", "eager", "bestfit"}));
+        ->check(CLI::IsMember({"linear", "eager", "bestfit", "auto"}));
     app.add_option("-M,--mapping-alg", mapper,
                    "Algorithm to use for mapping CNOT gates. Default=" + mapper)
-        ->check(CLI::IsMember({"swap", "steiner"}));
+        ->check(CLI::IsMember({"swap", "steiner", "auto"}));
+    app.add_option("--mapping-score", mapping_score,
+                   "Metric used to pick the best mapping with -l/-M auto. "
+                   "Default=" +
+                       mapping_score)
+        ->check(CLI::IsMember({"cnots", "fidelity"}));
+    app.add_option("--mapping-budget", mapping_budget,
+                   "Time budget (seconds) for layout optimization with "
+                   "-l/-M auto. Default=unlimited")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--steiner-alg", steiner_alg,
+                   "Steiner tree algorithm used by the steiner mapper. "
+                   "Default=" +
+                       steiner_alg)
+        ->check(CLI::IsMember({"greedy", "mehlhorn"}));
     app.add_flag(
         "--disable-layout-optimization", disable_layout_optimization,
         "Disables an expensive layout optimization pass when using the "
@@ -170,10 +195,14 @@ int main(int argc, char** argv) {
                  "Disables evaluation of parameter expressions");
     app.add_flag("--evaluate-all", evaluate_all,
                  "Evaluate all expressions as real numbers");
+    app.add_option("--depth-class", depth_classes,
+                   "Gate class whose depth -f profile reports, given as "
+                   "NAME=GATE,GATE,... Default=t_depth=t,tdg and "
+                   "cnot_depth=cx,CX");
     CLI::Option* device_opt =
         app.add_option("-d,--device", device_json, "Device to map onto (.json)")
             ->check(CLI::ExistingFile);
-    app.add_option("FILE.qasm", input_qasm, "OpenQASM circuit")
+    app.add_option("FILE.qasm", input_qasm, "OpenQASM or binary circuit")
         ->required()
         ->check(CLI::ExistingFile);
 
@@ -246,7 +275,8 @@ int main(int argc, char** argv) {
     }
 
     /* Parsing */
-    auto prog = parse_file(input_qasm);
+    auto prog = is_binary_file(input_qasm) ? parse_binary_file(input_qasm)
+                                           : parse_file(input_qasm);
     if (!prog) {
         std::cerr << "Error: failed to parse \"" << input_qasm << "\"\n";
         return 0;
@@ -287,6 +317,38 @@ int main(int argc, char** argv) {
                     dev =
                         mapping::fully_connected(tools::estimate_qubits(*prog));
                 }
+                if (steiner_alg == "mehlhorn") {
+                    dev.set_steiner_alg(mapping::SteinerAlg::mehlhorn);
+                }
+
+                /* Try all layout & mapping algorithms */
+                if (layout_alg == "auto" || mapper == "auto") {
+                    std::vector<std::string> layouts{layout_alg};
+                    std::vector<std::string> mappers{mapper};
+                    if (layout_alg == "auto") {
+                        layouts = {"linear", "eager", "bestfit"};
+                    }
+                    if (mapper == "auto") {
+                        mappers = {"swap", "steiner"};
+                    }
+
+                    std::optional<std::chrono::milliseconds> budget;
+                    if (mapping_budget > 0) {
+                        budget = std::chrono::milliseconds(
+                            static_cast<long long>(mapping_budget * 1000));
+                    }
+
+                    auto best = mapping::map_best(
+                        dev, *prog, layouts, mappers,
+                        mapping_score == "fidelity"
+                            ? mapping::MappingScore::fidelity
+                            : mapping::MappingScore::cnots,
+                        do_lo, budget);
+                    initial_layout = std::move(best.init);
+                    output_perm = std::move(best.output);
+                    prog = std::move(best.prog);
+                    break;
+                }
 
                 /* Generate the layout */
                 if (layout_alg == "linear") {
@@ -350,6 +412,12 @@ int main(int argc, char** argv) {
         } else {
             output::write_cirq(*prog, ofile);
         }
+    } else if (format == "binary") {
+        if (ofile.empty()) {
+            output::output_binary(*prog);
+        } else {
+            output::write_binary(*prog, ofile);
+        }
     } else if (format == "resources") {
         auto count = tools::estimate_resources(*prog);
 
@@ -367,6 +435,34 @@ int main(int argc, char** argv) {
                 os << "  " << name << ": " << num << "\n";
             }
 
+            os.close();
+        }
+    } else if (format == "profile") {
+        tools::Profiler::config params;
+        if (!depth_classes.empty()) {
+            params.classes.clear();
+        }
+        for (auto& depth_class : depth_classes) {
+            auto eq = depth_class.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                std::cerr << "Error: invalid depth class \"" << depth_class
+                          << "\"\n";
+                return 0;
+            }
+            auto& gates = params.classes[depth_class.substr(0, eq)];
+            std::stringstream ss(depth_class.substr(eq + 1));
+            for (std::string gate; std::getline(ss, gate, ',');) {
+                gates.insert(gate);
+            }
+        }
+        auto profile = tools::profile_circuit(*prog, params);
+
+        if (ofile.empty()) {
+            tools::write_profile_json(std::cout, profile);
+        } else {
+            std::ofstream os;
+            os.open(ofile);
+            tools::write_profile_json(os, profile);
             os.close();
         }
     } else { // qasm format
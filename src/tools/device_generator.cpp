@@ -24,6 +24,7 @@
  * SOFTWARE.
  */
 
+#include <map>
 #include <tuple>
 
 #include <third_party/CLI/CLI.hpp>
@@ -32,27 +33,37 @@
 
 static double FIDELITY_1 = staq::mapping::FIDELITY_1;
 
-void write_to_stream(const std::vector<std::vector<bool>>& adj,
+using coupling_map = std::map<staq::mapping::coupling, double>;
+
+void write_to_stream(int n, const coupling_map& edges,
+                     const std::vector<double>& sq_fi,
                      const std::string& device_name, std::ostream& out) {
     using Device = staq::mapping::Device;
-    Device dev(device_name, static_cast<int>(adj.size()), adj);
+    Device dev(device_name, n,
+               std::vector<std::pair<staq::mapping::coupling, double>>(
+                   edges.begin(), edges.end()),
+               sq_fi);
     out << dev.to_json() << "\n";
 }
 
-void add_edge(std::vector<std::vector<bool>>& adj,
-              std::vector<std::vector<double>>& tq_fi, int control, int target,
+void write_to_stream(int n, const coupling_map& edges,
+                     const std::string& device_name, std::ostream& out) {
+    write_to_stream(n, edges, std::vector<double>(n, FIDELITY_1), device_name,
+                    out);
+}
+
+void add_edge(coupling_map& edges, int n, int control, int target,
               double fidelity = FIDELITY_1) {
-    if (control < 0 || control >= adj.size() || target < 0 ||
-        target >= adj.size()) {
+    if (control < 0 || control >= n || target < 0 || target >= n) {
         std::cerr << "Qubit(s) out of range: " << control << "," << target
                   << "\n";
     } else {
-        adj[control][target] = true;
+        auto it = edges.try_emplace({control, target}, FIDELITY_1).first;
         if (fidelity != FIDELITY_1) {
             if (fidelity < 0 || fidelity > 1) {
                 std::cerr << "Fidelity out of range: " << fidelity << "\n";
             } else {
-                tq_fi[control][target] = fidelity;
+                it->second = fidelity;
             }
         }
     }
@@ -116,11 +127,9 @@ int main(int argc, char** argv) {
     if (*graph) {
         if (qubits > 0) {
             int n = qubits;
-            // compute adjacency matrix
+            // compute couplings
             std::vector<double> sq_fi(n, FIDELITY_1);
-            std::vector<std::vector<bool>> adj(n, std::vector<bool>(n));
-            std::vector<std::vector<double>> tq_fi(
-                n, std::vector<double>(n, FIDELITY_1));
+            coupling_map edges;
 
             for (auto& x : fidels) {
                 if (x.first < 0 || x.first >= n) {
@@ -132,25 +141,24 @@ int main(int argc, char** argv) {
                 }
             }
             for (auto& x : d_edges) {
-                add_edge(adj, tq_fi, x.first, x.second);
+                add_edge(edges, n, x.first, x.second);
             }
             for (auto& x : df_edges) {
-                add_edge(adj, tq_fi, std::get<0>(x), std::get<1>(x),
+                add_edge(edges, n, std::get<0>(x), std::get<1>(x),
                          std::get<2>(x));
             }
             for (auto& x : u_edges) {
-                add_edge(adj, tq_fi, x.first, x.second);
-                add_edge(adj, tq_fi, x.second, x.first);
+                add_edge(edges, n, x.first, x.second);
+                add_edge(edges, n, x.second, x.first);
             }
             for (auto& x : uf_edges) {
-                add_edge(adj, tq_fi, std::get<0>(x), std::get<1>(x),
+                add_edge(edges, n, std::get<0>(x), std::get<1>(x),
                          std::get<2>(x));
-                add_edge(adj, tq_fi, std::get<1>(x), std::get<0>(x),
+                add_edge(edges, n, std::get<1>(x), std::get<0>(x),
                          std::get<2>(x));
             }
 
-            staq::mapping::Device dev(name, n, adj, sq_fi, tq_fi);
-            std::cout << dev.to_json() << "\n";
+            write_to_stream(n, edges, sq_fi, name, std::cout);
         }
     } else if (!rectangular.empty()) {
         int l, w;
@@ -169,45 +177,45 @@ int main(int argc, char** argv) {
              * l*(w-1)    l*(w-1)+1    ...    l*w-1
              */
             int n = l * w;
-            // compute adjacency matrix
-            std::vector<std::vector<bool>> adj(n, std::vector<bool>(n));
+            // compute couplings
+            coupling_map edges;
             for (int i = 0; i < l; i++) {
                 for (int j = 0; j < w; j++) {
                     int id = i + j * l;
                     // connect to the left
                     if (i > 0) {
-                        adj[id][id - 1] = adj[id - 1][id] = true;
+                        edges[{id, id - 1}] = edges[{id - 1, id}] = FIDELITY_1;
                     }
                     // connect up
                     if (j > 0) {
-                        adj[id][id - l] = adj[id - l][id] = true;
+                        edges[{id, id - l}] = edges[{id - l, id}] = FIDELITY_1;
                     }
                 }
             }
 
-            write_to_stream(adj,
+            write_to_stream(n, edges,
                             "Rectangular_" + std::to_string(l) + "_x_" +
                                 std::to_string(w),
                             std::cout);
         }
     } else if (circular >= 3) {
         int n = circular;
-        // compute adjacency matrix
-        std::vector<std::vector<bool>> adj(n, std::vector<bool>(n));
+        // compute couplings
+        coupling_map edges;
         for (int i = 0; i < n; i++) {
             int j = (i + 1) % n;
-            adj[i][j] = adj[j][i] = true;
+            edges[{i, j}] = edges[{j, i}] = FIDELITY_1;
         }
 
-        write_to_stream(adj, "Circular_" + std::to_string(n), std::cout);
+        write_to_stream(n, edges, "Circular_" + std::to_string(n), std::cout);
     } else if (linear >= 2) {
         int n = linear;
-        // compute adjacency matrix
-        std::vector<std::vector<bool>> adj(n, std::vector<bool>(n));
+        // compute couplings
+        coupling_map edges;
         for (int i = 1; i < n; i++) {
-            adj[i][i - 1] = adj[i - 1][i] = true;
+            edges[{i, i - 1}] = edges[{i - 1, i}] = FIDELITY_1;
         }
 
-        write_to_stream(adj, "Linear_" + std::to_string(n), std::cout);
+        write_to_stream(n, edges, "Linear_" + std::to_string(n), std::cout);
     }
 }
@@ -26,31 +26,86 @@
 
 #include <chrono>
 #include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <vector>
 
 #include "third_party/CLI/CLI.hpp"
 
+#include "staq/grid_synth/batch.hpp"
 #include "staq/grid_synth/exact_synthesis.hpp"
 #include "staq/grid_synth/grid_synth.hpp"
 #include "staq/grid_synth/regions.hpp"
 #include "staq/grid_synth/rz_approximation.hpp"
 #include "staq/grid_synth/types.hpp"
 
+namespace {
+
+// Escapes quotes, backslashes and control characters in a JSON string
+std::string json_escape(const std::string& str) {
+    std::ostringstream os;
+    for (unsigned char c : str) {
+        if (c == '"' || c == '\\') {
+            os << '\\' << c;
+        } else if (c < 0x20) {
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+               << static_cast<int>(c);
+        } else {
+            os << c;
+        }
+    }
+    return os.str();
+}
+
+// Writes a batch result as a line of JSON
+void write_json(std::ostream& os, const staq::grid_synth::BatchResult& item) {
+    os << "{\"index\":" << item.index << ",\"angle\":\""
+       << json_escape(item.angle) << "\"";
+    if (!item.message.empty()) {
+        os << ",\"failed\":\"" << json_escape(item.message) << "\"}\n";
+        return;
+    }
+    std::ostringstream error;
+    error << std::scientific << std::setprecision(6) << item.result.error;
+    os << ",\"t_count\":" << item.result.t_count
+       << ",\"error\":" << error.str() << ",\"gates\":\""
+       << item.result.op_str << "\"}\n";
+}
+
+} // namespace
+
 int main(int argc, char** argv) {
     using namespace staq;
     using namespace grid_synth;
 
     bool check = false, details = false, verbose = false, timer = false;
+    bool json = false;
     std::vector<std::string> thetas;
+    std::string input;
     long int prec;
     int factor_effort;
+    int threads;
+    int ecm_curves;
+    std::string library;
+    int skew_cache;
+    int jobs = 1;
 
     CLI::App app{"Grid Synthesis"};
 
     CLI::Option* thetas_op =
-        app.add_option("theta", thetas, "Z-rotation angle(s) in units of PI")
-            ->required();
+        app.add_option("theta", thetas, "Z-rotation angle(s) in units of PI");
+    CLI::Option* input_op = app.add_option(
+        "-i, --input", input,
+        "File of whitespace-separated angles in units of PI, or - for stdin");
+    app.add_option("-j, --jobs", jobs,
+                   "Number of angles synthesized in parallel, or 0 for all "
+                   "cores (default=1)");
+    app.add_flag("--json", json,
+                 "Output one JSON object per angle, with its T-count, error "
+                 "and gates");
 
     CLI::Option* prec_opt =
         app.add_option<long int, int>(
@@ -63,6 +118,23 @@ int main(int argc, char** argv) {
                "Sets MAX_ATTEMPTS_POLLARD_RHO, the effort "
                "taken to factorize candidate solutions (default=200)")
             ->default_val(MAX_ATTEMPTS_POLLARD_RHO);
+    app.add_option("--threads", threads,
+                   "Number of threads searching for each approximation, or 0 "
+                   "for all cores (default=1)")
+        ->default_val(RZ_SEARCH_THREADS);
+    app.add_option("--ecm-curves", ecm_curves,
+                   "Number of elliptic curves tried on composites that "
+                   "Pollard's rho fails to factor (default=0)")
+        ->default_val(ECM_CURVES);
+    app.add_option("--library", library,
+                   "Angle library of precomputed dyadic rotations, as "
+                   "written by staq_grid_synth_library")
+        ->envname("STAQ_ANGLE_LIBRARY");
+    app.add_option("--skew-cache", skew_cache,
+                   "Number of skew reductions cached for reuse by angles "
+                   "within 2^16 * 10^-p of each other, or 0 to disable "
+                   "(default=0)")
+        ->default_val(SKEW_CACHE_SIZE);
     app.add_flag("-c, --check", check,
                  "Output bool that will be 1 if the op string matches the "
                  "input operator");
@@ -77,13 +149,87 @@ int main(int argc, char** argv) {
 
     CLI11_PARSE(app, argc, argv);
 
+    if (!*thetas_op && !*input_op) {
+        std::cerr << "No angles provided, pass them as arguments or with "
+                     "--input"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
     if (verbose) {
         std::cerr << thetas.size() << " angle(s) read." << '\n';
     }
 
-    GridSynthOptions opt{prec, factor_effort, check, details, verbose, timer};
+    GridSynthOptions opt{prec,    factor_effort, check,   details,
+                         verbose, timer,         threads, ecm_curves,
+                         library, skew_cache};
     GridSynthesizer synthesizer = make_synthesizer(opt);
 
+    // Batch mode: stream angles through a pool of workers, writing results
+    // in input order
+    if (*input_op || json || jobs != 1) {
+        std::ifstream file;
+        std::istringstream args;
+        std::istream* in = &std::cin;
+        if (*input_op && input != "-") {
+            file.open(input);
+            if (!file) {
+                std::cerr << "Could not open " << input << std::endl;
+                return EXIT_FAILURE;
+            }
+            in = &file;
+        } else if (!*input_op) {
+            std::string joined;
+            for (const auto& angle : thetas) {
+                joined += angle + ' ';
+            }
+            args.str(joined);
+            in = &args;
+        }
+
+        std::size_t failed = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto last_report = start;
+        auto seconds_since = [](std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - t)
+                .count();
+        };
+
+        std::size_t count = synthesize_stream(
+            synthesizer, *in, jobs, std::random_device{}(),
+            [&](const BatchResult& item) {
+                if (json) {
+                    write_json(std::cout, item);
+                } else if (item.message.empty()) {
+                    for (char c : item.result.op_str) {
+                        std::cout << c << ' ';
+                    }
+                    std::cout << '\n';
+                }
+                if (!item.message.empty()) {
+                    ++failed;
+                    std::cerr << item.message << std::endl;
+                }
+                if (*input_op && seconds_since(last_report) >= 1) {
+                    last_report = std::chrono::steady_clock::now();
+                    double elapsed = seconds_since(start);
+                    std::cerr << std::fixed << std::setprecision(1)
+                              << item.index + 1 << " angles, " << elapsed
+                              << " s, " << (item.index + 1) / elapsed
+                              << " angles/s" << std::endl;
+                }
+            });
+
+        if (*input_op || timer) {
+            double elapsed = seconds_since(start);
+            std::cerr << std::fixed << std::setprecision(1) << count
+                      << " angles (" << failed << " failed), " << elapsed
+                      << " s, " << count / elapsed << " angles/s" << std::endl;
+        }
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
     if (*prec_opt && *thetas_op) {
         std::random_device rd;
         random_numbers.seed(rd());
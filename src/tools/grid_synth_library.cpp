@@ -0,0 +1,145 @@
+/*
+ * This file is part of staq.
+ *
+ * Copyright (c) 2019 - 2025 softwareQ Inc. All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "third_party/CLI/CLI.hpp"
+
+#include "staq/grid_synth/angle_library.hpp"
+#include "staq/grid_synth/batch.hpp"
+#include "staq/grid_synth/grid_synth.hpp"
+#include "staq/grid_synth/types.hpp"
+
+namespace {
+
+// m / 2^k as an exact decimal string
+std::string dyadic_str(std::uint64_t m, unsigned k) {
+    mpz_class digits;
+    mpz_ui_pow_ui(digits.get_mpz_t(), 5, k);
+    digits *= mpz_class(std::to_string(m));
+    std::string str = digits.get_str();
+    if (str.size() <= k) {
+        str.insert(0, k + 1 - str.size(), '0');
+    }
+    str.insert(str.size() - k, ".");
+    return str;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using namespace staq;
+    using namespace grid_synth;
+
+    std::string output;
+    std::vector<long int> precs;
+    unsigned max_k = 10;
+    int jobs = 1;
+    int factor_effort;
+    std::uint64_t seed = 0;
+
+    CLI::App app{"Generates an angle library of Rz(m pi / 2^k) "
+                 "approximations for staq_grid_synth and staq_qasm_synth"};
+
+    app.add_option("-o, --output", output, "Library file to write")
+        ->required();
+    app.add_option("-p, --precision", precs,
+                   "Precision(s) in base ten as positive integers (10^-p)")
+        ->required();
+    app.add_option("-k, --max-k", max_k,
+                   "Largest k of the angles m pi / 2^k, for every odd m up "
+                   "to 2^(k+2) (default=10)")
+        ->check(CLI::Range(3u, ANGLE_LIBRARY_MAX_K));
+    app.add_option("-j, --jobs", jobs,
+                   "Number of angles synthesized in parallel, or 0 for all "
+                   "cores (default=1)");
+    app.add_option<int, int>(
+           "--pollard-rho", factor_effort,
+           "Sets MAX_ATTEMPTS_POLLARD_RHO, the effort "
+           "taken to factorize candidate solutions (default=200)")
+        ->default_val(MAX_ATTEMPTS_POLLARD_RHO);
+    app.add_option("--seed", seed,
+                   "Seed for the random numbers, so that libraries are "
+                   "reproducible (default=0)");
+
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<std::pair<unsigned, std::uint64_t>> angles;
+    std::string joined;
+    for (unsigned k = 3; k <= max_k; k++) {
+        for (std::uint64_t m = 1; m < (std::uint64_t{1} << (k + 2)); m += 2) {
+            angles.emplace_back(k, m);
+            joined += dyadic_str(m, k) + ' ';
+        }
+    }
+
+    std::vector<AngleLibraryItem> items;
+    std::size_t failed = 0;
+    for (long int prec : precs) {
+        GridSynthOptions opt{prec, factor_effort};
+        GridSynthesizer synthesizer = make_synthesizer(opt);
+
+        auto start = std::chrono::steady_clock::now();
+        std::istringstream in(joined);
+        synthesize_stream(
+            synthesizer, in, jobs, seed, [&](const BatchResult& item) {
+                if (!item.message.empty()) {
+                    ++failed;
+                    std::cerr << "pi * " << item.angle << ": " << item.message
+                              << std::endl;
+                    return;
+                }
+                auto [k, m] = angles[item.index];
+                items.push_back(AngleLibraryItem{
+                    static_cast<std::uint32_t>(prec), k, m,
+                    item.result.op_str, item.result.t_count,
+                    item.result.error.get_d()});
+            });
+        double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        std::cerr << std::fixed << std::setprecision(1) << "p = " << prec
+                  << ": " << angles.size() << " angles, " << elapsed << " s"
+                  << std::endl;
+    }
+
+    std::ofstream out(output, std::ios::binary);
+    write_angle_library(out, std::move(items));
+    if (!out) {
+        std::cerr << "Could not write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
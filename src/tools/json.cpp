@@ -28,7 +28,6 @@
 #include <iostream>
 
 #include <CLI/CLI.hpp>
-#include <nlohmann/json.hpp>
 
 #include "qasmtools/parser/parser.hpp"
 #include "staq/output/json.hpp"
@@ -43,13 +42,15 @@ int main(int argc, char** argv) {
     CLI11_PARSE(app, argc, argv);
     auto prog = parse_stdin();
     if (prog) {
-        staq::output::JSONOutputter jo;
-        prog->accept(jo);
         if (filename.empty()) {
-            std::cout << jo.json_val().dump() << std::endl;
+            staq::output::JSONOutputter jo(std::cout);
+            prog->accept(jo);
+            std::cout << std::endl;
         } else {
             std::fstream fout(filename);
-            fout << jo.json_val().dump() << std::endl;
+            staq::output::JSONOutputter jo(fout);
+            prog->accept(jo);
+            fout << std::endl;
             fout.close();
         }
     } else {
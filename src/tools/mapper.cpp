@@ -48,6 +48,7 @@ int main(int argc, char** argv) {
     std::string device_json;
     std::string layout = "linear";
     std::string mapper = "swap";
+    std::string steiner_alg = "greedy";
     bool evaluate_all = false;
 
     CLI::App app{"QASM physical mapper"};
@@ -61,6 +62,9 @@ int main(int argc, char** argv) {
         ->check(CLI::IsMember({"linear", "eager", "bestfit"}));
     app.add_option("-m", mapper, "Mapping algorithm to use. Default=" + mapper)
         ->check(CLI::IsMember({"swap", "steiner"}));
+    app.add_option("--steiner-alg", steiner_alg,
+                   "Steiner tree algorithm to use. Default=" + steiner_alg)
+        ->check(CLI::IsMember({"greedy", "mehlhorn"}));
     app.add_flag("--evaluate-all", evaluate_all,
                  "Evaluate all expressions as real numbers");
 
@@ -79,6 +83,9 @@ int main(int argc, char** argv) {
         } else {
             dev = mapping::fully_connected(tools::estimate_qubits(*program));
         }
+        if (steiner_alg == "mehlhorn") {
+            dev.set_steiner_alg(mapping::SteinerAlg::mehlhorn);
+        }
 
         // Initial layout
         mapping::layout physical_layout;
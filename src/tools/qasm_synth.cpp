@@ -42,6 +42,10 @@ int main(int argc, char** argv) {
     bool check = false, details = false, verbose = false;
     long int prec;
     int factor_effort;
+    int threads;
+    int ecm_curves;
+    std::string library;
+    int skew_cache;
     domega_matrix_table_t s3_table;
 
     CLI::App app{"Grid Synthesis rx/ry/rz substitution in OpenQASM 2.0 files"};
@@ -57,6 +61,23 @@ int main(int argc, char** argv) {
                "Sets MAX_ATTEMPTS_POLLARD_RHO, the effort "
                "taken to factorize candidate solutions (default=200)")
             ->default_val(MAX_ATTEMPTS_POLLARD_RHO);
+    app.add_option("--threads", threads,
+                   "Number of threads searching for each approximation, or 0 "
+                   "for all cores (default=1)")
+        ->default_val(RZ_SEARCH_THREADS);
+    app.add_option("--ecm-curves", ecm_curves,
+                   "Number of elliptic curves tried on composites that "
+                   "Pollard's rho fails to factor (default=0)")
+        ->default_val(ECM_CURVES);
+    app.add_option("--library", library,
+                   "Angle library of precomputed dyadic rotations, as "
+                   "written by staq_grid_synth_library")
+        ->envname("STAQ_ANGLE_LIBRARY");
+    app.add_option("--skew-cache", skew_cache,
+                   "Number of skew reductions cached for reuse by angles "
+                   "within 2^16 * 10^-p of each other, or 0 to disable "
+                   "(default=0)")
+        ->default_val(SKEW_CACHE_SIZE);
     app.add_flag("-c, --check", check,
                  "Output bool that will be 1 if the op string matches the "
                  "input operator");
@@ -70,7 +91,9 @@ int main(int argc, char** argv) {
 
     CLI11_PARSE(app, argc, argv);
 
-    GridSynthOptions opt{prec, factor_effort, check, details, verbose};
+    GridSynthOptions opt{prec,    factor_effort, check,   details,
+                         verbose, false,         threads, ecm_curves,
+                         library, skew_cache};
 
     // Must initialize constants before parsing stdin using GMP
     MP_CONSTS = initialize_constants(opt.prec);
@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+
+#include "staq/grid_synth/matrix.hpp"
+
+using namespace staq;
+using namespace grid_synth;
+
+#ifdef GRID_SYNTH_CHECKED_INT
+
+TEST(CheckedInt, Overflow) {
+    int64_c x = int_cast<int64_c>(int_t(1) << 61);
+    EXPECT_THROW(x * 4, std::overflow_error);
+    EXPECT_THROW(x + x + x + x, std::overflow_error);
+    EXPECT_NO_THROW(-x - x - x - x);
+    EXPECT_THROW(int_cast<int64_c>(int_t("9223372036854775808")),
+                 std::overflow_error);
+    EXPECT_THROW(int_cast<int128_c>(int_t(1) << 127), std::overflow_error);
+}
+
+TEST(CheckedInt, Conversion) {
+    for (const char* str : {"0", "-1", "123456789", "-4611686018427387903",
+                            "85070591730234615865843651857942052863",
+                            "-85070591730234615865843651857942052863"}) {
+        int_t x(str);
+        EXPECT_TRUE(to_int_t(int_cast<int128_c>(x)) == x);
+        if (bit_size(x) < 63) {
+            EXPECT_TRUE(to_int_t(int_cast<int64_c>(x)) == x);
+        }
+    }
+}
+
+TEST(CheckedInt, RingArithmetic) {
+    ZOmega u(3, -7, 12, 5);
+    ZOmega t(-2, 9, 4, -11);
+    ZOmegaT<int64_c> u64 = u.cast<int64_c>();
+    ZOmegaT<int64_c> t64 = t.cast<int64_c>();
+
+    EXPECT_TRUE((u64 * t64.conj() - t64).cast<int_t>() == u * t.conj() - t);
+    EXPECT_TRUE(u64.mul_w_pow(3).cast<int_t>() == u * w_pow(3));
+
+    DOmegaMatrix D = H * T * H * T * T * H * T;
+    DOmegaMatrixT<int128_c> D128 = D.cast<int128_c>();
+    EXPECT_TRUE((D128 * D128.dagger()).cast<int_t>() == D * D.dagger());
+    EXPECT_TRUE(to_int_t(D128.sde_u_sq()) == D.sde_u_sq());
+}
+
+#endif // GRID_SYNTH_CHECKED_INT
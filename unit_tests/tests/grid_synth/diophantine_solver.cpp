@@ -25,3 +25,42 @@ TEST(PrimeFactorizeInt, SuccessOnFirstTenThousandNumbers) {
         }
     }
 }
+
+TEST(IsPrime, MatchesTrialDivision) {
+    for (int n = 0; n < 20000; n++) {
+        bool prime = n >= 2;
+        for (int d = 2; d * d <= n; d++) {
+            if (n % d == 0) {
+                prime = false;
+                break;
+            }
+        }
+        EXPECT_EQ(is_prime(n), prime);
+    }
+
+    // Carmichael numbers fool the Fermat test
+    EXPECT_FALSE(is_prime(int_t("3825123056546413051")));
+    EXPECT_TRUE(is_prime(int_t("170141183460469231731687303715884105727")));
+}
+
+TEST(PollardRho, FindsFactor) {
+    int_t p("10007");
+    int_t q("100043");
+    int_t factor;
+
+    EXPECT_TRUE(pollard_rho(factor, p * q));
+    EXPECT_TRUE(factor == p || factor == q);
+}
+
+TEST(ECM, FindsFactor) {
+    int_t p("1000000007");
+    int_t q("998244353");
+    int_t factor;
+
+    int curves = ECM_CURVES;
+    ECM_CURVES = 50;
+    random_numbers.seed(1);
+    EXPECT_TRUE(ecm(factor, p * q));
+    EXPECT_TRUE(factor == p || factor == q);
+    ECM_CURVES = curves;
+}
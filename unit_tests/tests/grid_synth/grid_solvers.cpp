@@ -126,3 +126,12 @@ TEST(TwoDScaledGridSolver, SolutionConfirmation) {
         EXPECT_TRUE(B.contains(soln.dot().decimal()));
     }
 }
+
+TEST(LambdaPowers, MatchesPow) {
+    LambdaPowers& powers = lambda_powers();
+    for (long n : {0L, 7L, 3L, -5L, 20L, -1L}) {
+        ZSqrt2 expected = n >= 0 ? pow(LAMBDA, n) : pow(LAMBDA_INV, -n);
+        EXPECT_TRUE(powers.power(n) == expected);
+        EXPECT_TRUE(powers.decimal(n) == expected.decimal());
+    }
+}
@@ -1,5 +1,9 @@
 #include "gtest/gtest.h"
 
+#include <cstdio>
+#include <fstream>
+
+#include "staq/grid_synth/batch.hpp"
 #include "staq/grid_synth/grid_synth.hpp"
 
 using namespace staq;
@@ -37,3 +41,68 @@ TEST(GridSynth, InexactSynthesis) {
     synthesizer.get_op_str(real_t("-5.3123"));
     EXPECT_TRUE(synthesizer.is_valid());
 }
+
+// Stream angles through a pool of workers
+TEST(GridSynth, StreamSynthesis) {
+    GridSynthOptions opt{10, 200, false, false, false, false};
+    GridSynthesizer synthesizer = make_synthesizer(opt);
+
+    auto run = [&](int jobs) {
+        std::istringstream in("0.3 0.25\n-1.7 abc 0.1234");
+        std::vector<BatchResult> results;
+        std::size_t count = synthesize_stream(
+            synthesizer, in, jobs, 42,
+            [&](const BatchResult& item) { results.push_back(item); });
+        EXPECT_EQ(count, 5);
+        return results;
+    };
+
+    std::vector<BatchResult> serial = run(1);
+    std::vector<BatchResult> parallel = run(3);
+    ASSERT_EQ(serial.size(), 5);
+    ASSERT_EQ(parallel.size(), 5);
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].index, i);
+        EXPECT_EQ(parallel[i].index, i);
+        EXPECT_EQ(serial[i].result.op_str, parallel[i].result.op_str);
+    }
+
+    EXPECT_EQ(serial[1].result.op_str, "Tw");
+    EXPECT_EQ(serial[1].result.t_count, 1);
+    EXPECT_FALSE(serial[3].message.empty());
+    for (std::size_t i : {0, 2, 4}) {
+        EXPECT_TRUE(serial[i].message.empty());
+        EXPECT_TRUE(serial[i].result.error < gmpf::pow(real_t(10), -10));
+        EXPECT_TRUE(domega_matrix_from_str(serial[i].result.op_str) ==
+                    domega_matrix_from_str(
+                        full_simplify_str(serial[i].result.op_str)));
+    }
+}
+
+// Look up dyadic angles in an angle library
+TEST(GridSynth, AngleLibrary) {
+    str_t path = testing::TempDir() + "staq_angle_library.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        write_angle_library(out, {{10, 3, 3, "THTH", 2, 2e-11},
+                                  {10, 3, 1, "HTHT", 2, 1e-11},
+                                  {20, 3, 1, "TTTT", 4, 0}});
+    }
+    GridSynthOptions opt{10, 200, false, false, false, false, 1, 0, path};
+    GridSynthesizer synthesizer = make_synthesizer(opt);
+    real_t pi = gmpf::gmp_pi();
+
+    EXPECT_EQ(synthesizer.get_op_str(pi / 8), "HTHT");
+    GridSynthResult result = synthesizer.synthesize_angle(pi * 3 / 8);
+    EXPECT_EQ(result.op_str, "THTH");
+    EXPECT_EQ(result.t_count, 2);
+    EXPECT_EQ(synthesizer.synthesize_angle(pi * -29 / 8).op_str, "THTH");
+
+    // Not in the library, so synthesized as usual
+    result = synthesizer.synthesize_angle(pi / 16);
+    EXPECT_TRUE(result.t_count > 4);
+    EXPECT_TRUE(result.error < gmpf::pow(real_t(10), -10));
+
+    std::remove(path.c_str());
+    EXPECT_EQ(AngleLibrary(path).size(), 0);
+}
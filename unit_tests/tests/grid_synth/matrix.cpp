@@ -38,3 +38,14 @@ TEST(Matrix, S3Table) {
     EXPECT_TRUE(str_t("H") == s3_table[H]);
     EXPECT_TRUE(str_t("SHST") == s3_table[S * H * T * T * T]);
 }
+
+TEST(Matrix, ProductSde) {
+    std::vector<DOmegaMatrix> mats = {I, H, T, H * T * H, T * H * T * T * H,
+                                      H * T * H * T * H * T * H};
+    for (auto& A : mats) {
+        for (auto& B : mats) {
+            EXPECT_TRUE(DOmegaMatrix::sde_sq(A.product_u(B), A.k() + B.k()) ==
+                        (A * B).sde_u_sq());
+        }
+    }
+}
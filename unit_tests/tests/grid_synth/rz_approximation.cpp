@@ -16,3 +16,46 @@ TEST(RzApproximation, Range) {
         EXPECT_TRUE(rz_approx.error() <= eps);
     }
 }
+
+// The approximation found must not depend on the number of threads searching
+TEST(RzApproximation, Threads) {
+    real_t eps = 1e-10;
+
+    for (int i = 1; i < 8; i++) {
+        real_t theta = PI * i / 7;
+        random_numbers.seed(i);
+        RzApproximation serial =
+            find_fast_rz_approximation(theta, eps, KMIN, KMAX, TOL, 1);
+        random_numbers.seed(i);
+        RzApproximation parallel =
+            find_fast_rz_approximation(theta, eps, KMIN, KMAX, TOL, 4);
+
+        EXPECT_TRUE(serial.solution_found());
+        EXPECT_TRUE(parallel.solution_found());
+        EXPECT_TRUE(serial.matrix() == parallel.matrix());
+        EXPECT_TRUE(parallel.error() <= eps);
+    }
+}
+
+// Cached skew reductions must not change the approximation found
+TEST(RzApproximation, SkewCache) {
+    real_t eps = 1e-10;
+    int size = SKEW_CACHE_SIZE;
+    SKEW_CACHE_SIZE = 4;
+
+    std::vector<RzApproximation> first, second;
+    for (auto* results : {&first, &second}) {
+        for (int i = 0; i < 6; i++) {
+            real_t theta = real_t("0.3") + real_t("1e-9") * i;
+            random_numbers.seed(i);
+            results->push_back(find_fast_rz_approximation(theta, eps));
+        }
+    }
+    SKEW_CACHE_SIZE = size;
+
+    for (int i = 0; i < 6; i++) {
+        EXPECT_TRUE(first[i].solution_found());
+        EXPECT_TRUE(first[i].error() <= eps);
+        EXPECT_TRUE(first[i].matrix() == second[i].matrix());
+    }
+}
@@ -23,3 +23,31 @@ TEST(ShiftState, ShiftToUnity) {
     A.rescale(1 / scaleA);
     B.rescale(1 / scaleB);
 }
+
+TEST(OptimizeSkew, ReducesSkew) {
+    Ellipse A(0, 0, 1e-12, 1e12, 0.3 * PI);
+    Ellipse B(0, 0, 1e6, 1e-6, 0.1 * PI);
+    state_t state{A, B};
+    state_t normalized = state;
+    normalized[0].normalize();
+    normalized[1].normalize();
+    EXPECT_TRUE(skew(normalized) >= 15);
+
+    SpecialGridOperator G = optimize_skew(state);
+    state_t reduced = G * state_t{A, B};
+    reduced[0].normalize();
+    reduced[1].normalize();
+    EXPECT_TRUE(skew(reduced) < 15);
+}
+
+TEST(OptimizeSkew, DoubleEllipse) {
+    Ellipse A(1, 2, 10, 5, 0.45 * PI);
+    EllipseT<double> fast = EllipseT<double>::from(A);
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            EXPECT_NEAR(fast.D(i, j), A.D(i, j).get_d(), 1e-12);
+        }
+    }
+    EXPECT_NEAR(skew(state_type<double>{fast, fast}),
+                skew(state_t{A, A}).get_d(), 1e-9);
+}
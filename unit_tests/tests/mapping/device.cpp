@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <set>
 
 #include "gtest/gtest.h"
@@ -88,3 +89,73 @@ TEST(Device, Steiner_tree) {
     EXPECT_TRUE(subset(steiner_edges({{0, 1}, {1, 4}, {4, 7}, {7, 6}, {7, 8}}),
                        steiner_edges(tmp4.begin(), tmp4.end())));
 }
+
+TEST(Device, Coupling_index) {
+    auto& list = test_device.coupling_list();
+    auto& set = test_device.couplings();
+
+    EXPECT_EQ(list.size(), set.size());
+    EXPECT_TRUE(std::equal(list.begin(), list.end(), set.begin()));
+
+    for (auto id : test_device.out_couplings(4)) {
+        EXPECT_EQ(list[id].first.first, 4);
+    }
+    for (auto id : test_device.in_couplings(4)) {
+        EXPECT_EQ(list[id].first.second, 4);
+    }
+    EXPECT_EQ(test_device.out_couplings(4).size(), 4);
+    EXPECT_EQ(list[test_device.out_couplings(4).front()].first,
+              mapping::coupling({4, 1}));
+}
+
+TEST(Device, Large_device) {
+    // 40 x 40 grid, above the limit for all-pairs distances
+    int l = 40;
+    std::vector<std::pair<mapping::coupling, double>> edges;
+    for (int i = 0; i < l; i++) {
+        for (int j = 0; j < l; j++) {
+            int id = i + j * l;
+            if (i > 0) {
+                edges.push_back({{id, id - 1}, mapping::FIDELITY_1});
+                edges.push_back({{id - 1, id}, mapping::FIDELITY_1});
+            }
+            if (j > 0) {
+                edges.push_back({{id, id - l}, mapping::FIDELITY_1});
+                edges.push_back({{id - l, id}, mapping::FIDELITY_1});
+            }
+        }
+    }
+    mapping::Device test("Grid", l * l, edges,
+                         std::vector<double>(l * l, mapping::FIDELITY_1));
+
+    EXPECT_TRUE(test.coupled(1, 0));
+    EXPECT_TRUE(test.coupled(0, l));
+    EXPECT_FALSE(test.coupled(0, l + 1));
+    EXPECT_EQ(test.distance(0, l * l - 1), 2 * (l - 1));
+    EXPECT_EQ(test.shortest_path(0, 2), mapping::path({0, 1, 2}));
+
+    auto tree = test.steiner(std::list<int>({2, 2 * l}), 0);
+    EXPECT_EQ(steiner_edges(tree.begin(), tree.end()),
+              steiner_edges({{0, 1}, {1, 2}, {0, l}, {l, 2 * l}}));
+}
+
+TEST(Device, Steiner_tree_mehlhorn) {
+    mapping::Device test = test_device;
+    test.set_steiner_alg(mapping::SteinerAlg::mehlhorn);
+
+    auto tmp1 = test.steiner(std::list<int>({2, 6}), 0);
+    auto tmp2 = test.steiner(std::list<int>({3, 8}), 1);
+
+    EXPECT_EQ(steiner_edges(tmp1.begin(), tmp1.end()),
+              steiner_edges({{0, 1}, {1, 4}, {4, 7}, {7, 6}, {1, 2}}));
+    EXPECT_EQ(tmp2.size(), 4);
+
+    // Edges are topologically ordered from the root
+    std::set<int> reached{0};
+    for (auto& [ctrl, tgt] :
+         test.steiner(std::list<int>({1, 2, 3, 4, 5, 6, 7, 8}), 0)) {
+        EXPECT_TRUE(reached.count(ctrl));
+        EXPECT_TRUE(reached.insert(tgt).second);
+    }
+    EXPECT_EQ(reached.size(), 9);
+}
@@ -3,6 +3,7 @@
 #include "qasmtools/parser/parser.hpp"
 
 // clang-format off
+#include "staq/mapping/auto.hpp"
 #include "staq/mapping/device.hpp"
 #include "staq/mapping/mapping/swap.hpp"
 #include "staq/mapping/mapping/steiner.hpp"
@@ -186,3 +187,36 @@ TEST(Steiner_Mapper, Swap_No_Z) {
 
     EXPECT_EQ(ss.str(), post);
 }
+
+// Tests for automatic algorithm selection
+
+TEST(Auto_Mapper, Best_Of_All) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "\n"
+                      "qreg q[9];\n"
+                      "CX q[0],q[6];\n"
+                      "CX q[2],q[8];\n"
+                      "CX q[6],q[2];\n";
+
+    auto program = parser::parse_string(src, "auto_best_of_all.qasm");
+    auto best = mapping::map_best(test_device, *program,
+                                  {"linear", "eager", "bestfit"},
+                                  {"swap", "steiner"});
+
+    for (auto layout_alg : {"linear", "eager", "bestfit"}) {
+        for (auto mapper : {"swap", "steiner"}) {
+            auto copy = parser::parse_string(src, "auto_best_of_all.qasm");
+            mapping::Device device = test_device;
+            mapping::map_with(device, *copy, layout_alg, mapper);
+            auto cnots = mapping::MappingScorer(device,
+                                                mapping::MappingScore::cnots)
+                             .run(*copy);
+            EXPECT_LE(best.score, cnots);
+        }
+    }
+
+    // The original program is left untouched
+    std::stringstream ss;
+    ss << *program;
+    EXPECT_EQ(ss.str(), src);
+}
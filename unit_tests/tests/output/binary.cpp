@@ -0,0 +1,85 @@
+#include "gtest/gtest.h"
+
+#include "qasmtools/parser/binary.hpp"
+#include "qasmtools/parser/parser.hpp"
+
+#include "staq/output/binary.hpp"
+
+using namespace staq;
+using namespace qasmtools;
+
+// Testing round trips through the binary circuit format
+
+TEST(Binary, Round_Trip) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[2];\n"
+                      "creg c[2];\n"
+                      "U(0.5,0.25,-1) q[0];\n"
+                      "CX q[0],q[1];\n"
+                      "qreg a[2];\n"
+                      "rz(pi/4) q[1];\n"
+                      "ccx q[1],q[0],a[1];\n"
+                      "barrier q,a[0];\n"
+                      "measure q[1] -> c[0];\n"
+                      "reset q;\n"
+                      "if (c==1) u3(0.125,0.375,2) a[1];\n";
+
+    auto program = parser::parse_string(src, "round_trip.qasm");
+    std::stringstream ss;
+    output::BinaryOutputter outputter(ss);
+    outputter.run(*program);
+
+    std::string data = ss.str();
+    auto result = parser::parse_binary(data.data(), data.size());
+
+    std::stringstream printed;
+    printed << *result;
+    EXPECT_EQ(printed.str(), "OPENQASM 2.0;\n"
+                             "include \"qelib1.inc\";\n"
+                             "\n"
+                             "qreg q[2];\n"
+                             "creg c[2];\n"
+                             "qreg a[2];\n"
+                             "U(0.5,0.25,-1) q[0];\n"
+                             "CX q[0],q[1];\n"
+                             "rz(0.785398163397448) q[1];\n"
+                             "ccx q[1],q[0],a[1];\n"
+                             "barrier q,a[0];\n"
+                             "measure q[1] -> c[0];\n"
+                             "reset q;\n"
+                             "if (c==1) u3(0.125,0.375,2) a[1];\n");
+    EXPECT_EQ(result->qubits(), 4);
+    EXPECT_EQ(result->bits(), 2);
+}
+
+TEST(Binary, Rejects_Undeclared_Gates) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "gate g a { h a; }\n"
+                      "qreg q[1];\n"
+                      "g q[0];\n";
+
+    auto program = parser::parse_string(src, "undeclared.qasm");
+    std::stringstream ss;
+    output::BinaryOutputter outputter(ss);
+    EXPECT_THROW(outputter.run(*program), std::logic_error);
+}
+
+TEST(Binary, Rejects_Corrupt_Input) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "qreg q[2];\n"
+                      "CX q[0],q[1];\n";
+
+    auto program = parser::parse_string(src, "corrupt.qasm");
+    std::stringstream ss;
+    output::BinaryOutputter outputter(ss);
+    outputter.run(*program);
+    std::string data = ss.str();
+
+    EXPECT_THROW(parser::parse_binary(data.data(), data.size() - 1),
+                 parser::ParseError);
+    data[8] = 2; // version
+    EXPECT_THROW(parser::parse_binary(data.data(), data.size()),
+                 parser::ParseError);
+}
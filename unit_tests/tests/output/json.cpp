@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "qasmtools/parser/parser.hpp"
+
+#include "staq/output/json.hpp"
+#include "staq/output/json_writer.hpp"
+#include "staq/output/lattice_surgery.hpp"
+
+using namespace staq;
+using namespace qasmtools;
+
+// Testing that streamed JSON matches nlohmann::json::dump
+
+TEST(JSONWriter, Matches_Dump) {
+    nlohmann::json doc = {
+        {"empty array", nlohmann::json::array()},
+        {"empty object", nlohmann::json::object()},
+        {"escapes", "a\"b\\c\nd\te\x01"},
+        {"nested", {{"a", {1, -2, 3.5, nullptr}}, {"b", true}}},
+        {"null", nullptr},
+        {"number", 0.1}};
+
+    for (int indent : {-1, 2}) {
+        std::stringstream ss;
+        output::JSONWriter writer(ss, indent);
+        writer.begin_object();
+        writer.key("empty array");
+        writer.begin_array();
+        writer.end_array();
+        writer.key("empty object");
+        writer.begin_object();
+        writer.end_object();
+        writer.key("escapes");
+        writer.value("a\"b\\c\nd\te\x01");
+        writer.key("nested");
+        writer.begin_object();
+        writer.key("a");
+        writer.begin_array();
+        writer.value(1);
+        writer.value(-2);
+        writer.value(3.5);
+        writer.null();
+        writer.end_array();
+        writer.key("b");
+        writer.value(true);
+        writer.end_object();
+        writer.key("null");
+        writer.null();
+        writer.key("number");
+        writer.value(0.1);
+        writer.end_object();
+
+        EXPECT_EQ(ss.str(), doc.dump(indent));
+    }
+}
+
+TEST(JSONOutputter, Streamed_Matches_Dump) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[2];\n"
+                      "creg c[2];\n"
+                      "gate e a { }\n"
+                      "U(0.1,0.2,0.3) q[0];\n"
+                      "cx q[0],q[1];\n"
+                      "rz(pi/4) q[1];\n"
+                      "barrier q;\n"
+                      "measure q -> c;\n"
+                      "if (c==1) x q[0];\n";
+
+    auto program = parser::parse_string(src, "streamed.qasm");
+    output::JSONOutputter buffered;
+    buffered.run(*program);
+    std::stringstream ss;
+    output::JSONOutputter streamed(ss);
+    streamed.run(*program);
+
+    EXPECT_EQ(ss.str(), buffered.json_val().dump());
+    EXPECT_EQ(nlohmann::json::parse(ss.str()).dump(), ss.str());
+}
+
+TEST(LatticeSurgery, Streamed_Matches_Dump) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[12];\n"
+                      "h q[0];\n"
+                      "t q[11];\n"
+                      "cx q[0],q[11];\n"
+                      "tdg q[2];\n"
+                      "cx q[2],q[10];\n"
+                      "t q[10];\n"
+                      "s q[1];\n";
+
+    auto program = parser::parse_string(src, "streamed.qasm");
+    std::string out = output::lattice_surgery(*program);
+
+    EXPECT_EQ(nlohmann::json::parse(out).dump(2) + "\n", out);
+}
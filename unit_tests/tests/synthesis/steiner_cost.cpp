@@ -0,0 +1,89 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "qasmtools/ast/expr.hpp"
+
+#include "staq/mapping/device.hpp"
+#include "staq/synthesis/cnot_dihedral.hpp"
+#include "staq/synthesis/steiner_cost.hpp"
+
+using namespace staq;
+using namespace qasmtools::ast;
+using namespace qasmtools::utils;
+
+// Testing the CNOT counts of device constrained synthesis
+
+static mapping::Device test_device("Test device", 9,
+                                   {
+                                       {0, 1, 0, 0, 0, 1, 0, 0, 0},
+                                       {1, 0, 1, 0, 1, 0, 0, 0, 0},
+                                       {0, 1, 0, 1, 0, 0, 0, 0, 0},
+                                       {0, 0, 1, 0, 1, 0, 0, 0, 1},
+                                       {0, 1, 0, 1, 0, 1, 0, 1, 0},
+                                       {1, 0, 0, 0, 1, 0, 1, 0, 0},
+                                       {0, 0, 0, 0, 0, 1, 0, 1, 0},
+                                       {0, 0, 0, 0, 1, 0, 1, 0, 1},
+                                       {0, 0, 0, 1, 0, 0, 0, 1, 0},
+                                   },
+                                   {1, 1, 1, 1, 1, 1, 1, 1, 1},
+                                   {
+                                       {0, 0.9, 0, 0, 0, 0.1, 0, 0, 0},
+                                       {0.9, 0, 0.1, 0, 0.9, 0, 0, 0, 0},
+                                       {0, 0.1, 0, 0.1, 0, 0, 0, 0, 0},
+                                       {0, 0, 0.1, 0, 0.1, 0, 0, 0, 0.1},
+                                       {0, 0.9, 0, 0.1, 0, 0.1, 0, 0.9, 0},
+                                       {0.1, 0, 0, 0, 0.1, 0, 0.1, 0, 0},
+                                       {0, 0, 0, 0, 0, 0.1, 0, 0.1, 0},
+                                       {0, 0, 0, 0, 0.9, 0, 0.9, 0, 0.1},
+                                       {0, 0, 0, 0.1, 0, 0, 0, 0.11, 0},
+                                   });
+
+static int count_cnots(const std::list<synthesis::cx_dihedral>& circuit) {
+    int ret = 0;
+    for (auto& gate : circuit) {
+        ret += std::holds_alternative<std::pair<int, int>>(gate);
+    }
+    return ret;
+}
+
+TEST(Steiner_Cost, Matches_Synthesis) {
+    std::mt19937 gen(1234);
+    std::bernoulli_distribution coin(0.5);
+    std::uniform_int_distribution<int> qubit(0, 8);
+    synthesis::SteinerCost cost;
+
+    for (int trial = 0; trial < 50; trial++) {
+        // Random invertible linear operator
+        synthesis::linear_op<bool> mat(9, std::vector<bool>(9, false));
+        for (int i = 0; i < 9; i++) {
+            mat[i][i] = true;
+        }
+        for (int k = 0; k < 20; k++) {
+            auto ctrl = qubit(gen);
+            auto tgt = qubit(gen);
+            if (ctrl != tgt) {
+                synthesis::operator^=(mat[tgt], mat[ctrl]);
+            }
+        }
+
+        // Random phase terms
+        std::list<synthesis::phase_term> f;
+        std::list<synthesis::phase_term> g;
+        for (int k = trial % 8; k > 0; k--) {
+            std::vector<bool> parity(9);
+            for (int i = 0; i < 9; i++) {
+                parity[i] = coin(gen);
+            }
+            f.emplace_back(parity, angle_to_expr(angles::pi_quarter));
+            g.emplace_back(parity, angle_to_expr(angles::pi_quarter));
+        }
+
+        auto expected =
+            count_cnots(synthesis::gray_steiner(f, mat, test_device));
+        EXPECT_EQ(cost.gray_steiner(g, mat, test_device), expected);
+        EXPECT_EQ(cost.steiner_gauss(mat, test_device),
+                  static_cast<int>(synthesis::steiner_gauss(mat, test_device)
+                                       .size()));
+    }
+}
@@ -0,0 +1,92 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "qasmtools/parser/parser.hpp"
+
+#include "staq/tools/profiler.hpp"
+
+using namespace staq;
+using namespace qasmtools;
+
+// Testing circuit profiles
+
+TEST(Profiler, Layers_And_Critical_Path) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[2];\n"
+                      "creg c[2];\n"
+                      "h q;\n"
+                      "barrier q;\n"
+                      "cx q[0],q[1];\n"
+                      "t q[1];\n"
+                      "measure q -> c;\n";
+
+    auto program = parser::parse_string(src, "layers.qasm");
+    tools::Profiler::config params;
+    params.classes = {{"h_depth", {"h"}}};
+    auto profile = tools::profile_circuit(*program, params);
+
+    std::map<std::string, int> counts{
+        {"cx", 1}, {"h", 2}, {"measure", 2}, {"t", 1}};
+    std::map<std::string, int> depths{
+        {"depth", 4}, {"h_depth", 1}, {"two_qubit_depth", 1}};
+    std::vector<std::pair<std::string, int>> idle{{"q[0]", 1}, {"q[1]", 0}};
+    std::vector<std::string> critical_path{"h q;", "cx q[0],q[1];", "t q[1];",
+                                           "measure q -> c;"};
+    EXPECT_EQ(profile.qubits, 2);
+    EXPECT_EQ(profile.cbits, 2);
+    EXPECT_EQ(profile.counts, counts);
+    EXPECT_EQ(profile.depths, depths);
+    EXPECT_EQ(profile.parallelism, std::vector<int>({2, 1, 2, 1}));
+    EXPECT_EQ(profile.idle, idle);
+    EXPECT_EQ(profile.critical_path, critical_path);
+}
+
+TEST(Profiler, Composes_Declared_Gates) {
+    // The inputs of g arrive at different times, which a summary of g that
+    // only knew its overall depth would get wrong
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "gate g a,b { t a; cx a,b; }\n"
+                      "qreg q[3];\n"
+                      "t q[1];\n"
+                      "t q[1];\n"
+                      "g q[0],q[1];\n";
+
+    auto program = parser::parse_string(src, "compose.qasm");
+    auto profile = tools::profile_circuit(*program);
+
+    std::map<std::string, int> counts{{"cx", 1}, {"t", 3}};
+    std::map<std::string, int> depths{{"cnot_depth", 1},
+                                      {"depth", 3},
+                                      {"t_depth", 2},
+                                      {"two_qubit_depth", 1}};
+    std::vector<std::pair<std::string, int>> idle{
+        {"q[0]", 1}, {"q[1]", 0}, {"q[2]", 3}};
+    std::vector<std::string> critical_path{"t q[1];", "t q[1];",
+                                           "g q[0],q[1];"};
+    EXPECT_EQ(profile.counts, counts);
+    EXPECT_EQ(profile.depths, depths);
+    EXPECT_EQ(profile.parallelism, std::vector<int>({2, 1, 1}));
+    EXPECT_EQ(profile.idle, idle);
+    EXPECT_EQ(profile.critical_path, critical_path);
+}
+
+TEST(Profiler, Json) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[1];\n"
+                      "x q[0];\n";
+
+    auto program = parser::parse_string(src, "json.qasm");
+    std::stringstream ss;
+    tools::write_profile_json(ss, tools::profile_circuit(*program), -1);
+
+    EXPECT_EQ(ss.str(), "{\"cbits\":0,\"counts\":{\"x\":1},"
+                        "\"critical_path\":[\"x q[0];\"],"
+                        "\"depths\":{\"cnot_depth\":0,\"depth\":1,"
+                        "\"t_depth\":0,\"two_qubit_depth\":0},"
+                        "\"idle\":{\"q[0]\":0},\"parallelism\":[1],"
+                        "\"qubits\":1}\n");
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+
+#include "qasmtools/parser/parser.hpp"
+
+#include "staq/tools/resource_estimator.hpp"
+
+using namespace staq;
+using namespace qasmtools;
+
+// Testing resource counts and depths
+
+TEST(Resource_estimator, Counts_And_Depth) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "qreg q[3];\n"
+                      "creg c[1];\n"
+                      "h q[0];\n"
+                      "t q[1];\n"
+                      "tdg q[1];\n"
+                      "rz(0.5) q[2];\n"
+                      "rz(1/2) q[2];\n"
+                      "U(0,0,0.25) q[0];\n"
+                      "cx q[0],q[1];\n"
+                      "measure q[1] -> c[0];\n";
+
+    auto program = parser::parse_string(src, "counts.qasm");
+    auto count = tools::estimate_resources(*program);
+
+    tools::resource_count expected{
+        {"qubits", 3}, {"cbits", 1},       {"h", 1},  {"t", 2},
+        {"rz(0.5)", 2}, {"U(0,0,0.25)", 1}, {"cx", 1}, {"measurement", 1},
+        {"depth", 4}};
+    EXPECT_EQ(count, expected);
+}
+
+TEST(Resource_estimator, Unboxes_Declared_Gates) {
+    std::string src = "OPENQASM 2.0;\n"
+                      "include \"qelib1.inc\";\n"
+                      "gate g a,b { h a; cx a,b; cx a,b; }\n"
+                      "qreg q[2];\n"
+                      "g q[0],q[1];\n"
+                      "g q[1],q[0];\n";
+
+    auto program = parser::parse_string(src, "unbox.qasm");
+
+    auto unboxed = tools::estimate_resources(*program);
+    tools::resource_count expected_unboxed{
+        {"qubits", 2}, {"h", 2}, {"cx", 4}, {"depth", 6}};
+    EXPECT_EQ(unboxed, expected_unboxed);
+
+    auto boxed = tools::estimate_resources(
+        *program, {false, true, ast::qelib_defs});
+    tools::resource_count expected_boxed{
+        {"qubits", 2}, {"g", 2}, {"depth", 2}};
+    EXPECT_EQ(boxed, expected_boxed);
+}